@@ -0,0 +1,153 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+  File:    alert.cpp
+  Project: Repertory/Bridge
+  Author:  raymond@burkholder.net
+  Created: October 19, 2026 15:52:08
+*/
+
+#include <cassert>
+#include <algorithm>
+
+#include <Bot.hpp>
+#include <mqtt.hpp>
+#include <thread.hpp>
+
+#include "alert.hpp"
+
+namespace ou {
+namespace bridge {
+
+Alert::Alert( Mqtt& mqtt, telegram::Bot& bot, const Config& config )
+: Alert( mqtt, [&bot]( const std::string& sHtml ){ bot.SendMessage( sHtml ); }, config )
+{}
+
+Alert::Alert( Mqtt& mqtt, fSend_t&& fSend, const Config& config )
+: m_mqtt( mqtt ), m_fSend( std::move( fSend ) )
+, m_pState( std::make_shared<State>( config ) )
+{
+  assert( m_fSend );
+  assert( !config.vFilter.empty() );
+
+  m_threadSend = std::move( std::thread( [this](){ ou::thread::Enter( "bridge.alert" ); Sender(); } ) );
+
+  pState_t pState( m_pState );
+  for ( const std::string& sFilter: config.vFilter ) {
+    m_mqtt.Subscribe(
+      sFilter,
+      [pState]( const std::string_view& svTopic, const std::string_view& svMessage ){
+        pState->Received( svTopic, svMessage );
+      } );
+  }
+}
+
+Alert::~Alert() {
+  for ( const std::string& sFilter: m_pState->config.vFilter ) {
+    m_mqtt.UnSubscribe( sFilter );
+  }
+  {
+    std::lock_guard<std::mutex> lock( m_pState->mutex );
+    m_pState->bRunning = false;
+  }
+  m_pState->cv.notify_one();
+  if ( m_threadSend.joinable() ) m_threadSend.join();
+}
+
+ESeverity Alert::SeverityFromTopic( const std::string_view& svTopic, const std::string_view& ) {
+  std::string_view::size_type ixBegin {};
+  while ( ixBegin <= svTopic.size() ) {
+    std::string_view::size_type ixEnd = svTopic.find( '/', ixBegin );
+    if ( std::string_view::npos == ixEnd ) ixEnd = svTopic.size();
+    const std::string_view svLevel( svTopic.substr( ixBegin, ixEnd - ixBegin ) );
+    if ( ( "critical" == svLevel ) || ( "crit" == svLevel ) ) return ESeverity::critical;
+    if ( ( "error" == svLevel ) || ( "err" == svLevel ) ) return ESeverity::error;
+    if ( ( "warning" == svLevel ) || ( "warn" == svLevel ) ) return ESeverity::warning;
+    ixBegin = ixEnd + 1;
+  }
+  return ESeverity::info;
+}
+
+void Alert::State::Received( const std::string_view& svTopic, const std::string_view& svMessage ) {
+
+  nReceived.fetch_add( 1, std::memory_order_relaxed );
+
+  const ESeverity eSeverity(
+    config.fSeverity
+    ? config.fSeverity( svTopic, svMessage )
+    : SeverityFromTopic( svTopic, svMessage )
+    );
+
+  bool bNotify( false );
+  {
+    std::lock_guard<std::mutex> lock( mutex );
+    if ( !bRunning ) return;
+    if ( digest.Empty() ) {
+      tpFirst = clock_t_::now();
+      bNotify = true;
+    }
+    digest.Add( eSeverity, svTopic, svMessage );
+    if ( !bSendNow ) {
+      if ( ( config.eImmediate <= eSeverity ) || ( config.nMaxChars <= digest.Estimate() ) ) {
+        bSendNow = true;
+        bNotify = true;
+      }
+    }
+  }
+  if ( bNotify ) cv.notify_one();
+}
+
+void Alert::Sender() {
+
+  State& state( *m_pState );
+  std::unique_lock<std::mutex> lock( state.mutex );
+
+  while ( state.bRunning ) {
+
+    if ( state.digest.Empty() ) {
+      state.cv.wait( lock, [&state]{ return !state.bRunning || !state.digest.Empty(); } );
+      continue;
+    }
+
+    const clock_t_::time_point tpDue(
+      std::max( state.bSendNow ? state.tpFirst : state.tpFirst + state.config.window, state.tpSent + state.config.spacing ) );
+
+    if ( clock_t_::now() < tpDue ) {
+      const bool bSendNow( state.bSendNow );
+      // woken early by an immediate alarm or a full digest, or to stop
+      state.cv.wait_until( lock, tpDue, [&state,bSendNow]{ return !state.bRunning || ( bSendNow != state.bSendNow ); } );
+      continue;
+    }
+
+    std::string sHtml( state.digest.Take() );
+    state.bSendNow = false;
+    state.tpSent = clock_t_::now();
+    lock.unlock();
+    m_fSend( sHtml );
+    state.nSent.fetch_add( 1, std::memory_order_relaxed );
+    lock.lock();
+  }
+
+  // final digest on the way out, spacing is not honoured
+  if ( !state.digest.Empty() ) {
+    std::string sHtml( state.digest.Take() );
+    lock.unlock();
+    m_fSend( sHtml );
+    state.nSent.fetch_add( 1, std::memory_order_relaxed );
+  }
+}
+
+} // namespace bridge
+} // namespace ou
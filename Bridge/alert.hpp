@@ -0,0 +1,130 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+ * File:    alert.hpp
+ * Project: Repertory/Bridge
+ * Author:  raymond@burkholder.net
+ * Created: October 19, 2026 15:52:08
+ */
+
+// forwards mqtt alarms to telegram as digests rather than one request per alarm
+//
+//   a digest is sent when its window closes, when it is about to exceed one message,
+//   or at once for a message at or above the immediate severity,
+//   in every case no sooner than 'spacing' after the previous send (telegram answers 429 otherwise)
+
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <string_view>
+#include <condition_variable>
+
+#include "digest.hpp"
+
+namespace ou {
+
+class Mqtt;
+
+namespace telegram {
+  class Bot;
+}
+
+namespace bridge {
+
+class Alert {
+public:
+
+  using fSeverity_t = std::function<ESeverity( const std::string_view& svTopic, const std::string_view& svMessage )>;
+
+  struct Config {
+    std::vector<std::string> vFilter; // mqtt topic filters carrying alarms
+    std::chrono::milliseconds window;  // from the first alarm of a digest to its send
+    std::chrono::milliseconds spacing; // minimum between sends
+    ESeverity eImmediate;              // at or above, send without waiting for the window
+    size_t nMaxChars;
+    fSeverity_t fSeverity;             // empty: SeverityFromTopic
+    Config()
+    : window( 10000 ), spacing( 1000 ), eImmediate( ESeverity::critical ), nMaxChars( 4096 )
+    {}
+  };
+
+  using fSend_t = std::function<void( const std::string& sHtml )>;
+
+  Alert( Mqtt&, telegram::Bot&, const Config& ); // sends with Bot::SendMessage
+  Alert( Mqtt&, fSend_t&&, const Config& );
+  ~Alert(); // a pending digest is sent
+
+  // first topic level named critical|crit, error|err, warning|warn, otherwise info, eg "alarm/site1/crit/pump"
+  static ESeverity SeverityFromTopic( const std::string_view& svTopic, const std::string_view& svMessage );
+
+  struct Stats {
+    uint64_t nReceived;
+    uint64_t nSent; // digests
+  };
+  Stats GetStats() const { return Stats{ m_pState->nReceived.load( std::memory_order_relaxed ), m_pState->nSent.load( std::memory_order_relaxed ) }; }
+
+protected:
+private:
+
+  using clock_t_ = std::chrono::steady_clock;
+
+  Mqtt& m_mqtt;
+  fSend_t m_fSend;
+
+  // handlers registered with Mqtt may still run briefly after UnSubscribe, they hold this, not the Alert
+  struct State {
+
+    const Config config;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool bRunning;
+    bool bSendNow; // immediate severity, or digest full
+
+    Digest digest;
+    clock_t_::time_point tpFirst; // first alarm in the pending digest
+    clock_t_::time_point tpSent;
+
+    std::atomic<uint64_t> nReceived;
+    std::atomic<uint64_t> nSent;
+
+    State( const Config& config_ )
+    : config( config_ ), bRunning( true ), bSendNow( false )
+    , digest( config_.nMaxChars )
+    , tpSent( clock_t_::now() - config_.spacing )
+    , nReceived {}, nSent {}
+    {}
+
+    void Received( const std::string_view& svTopic, const std::string_view& svMessage );
+  };
+
+  using pState_t = std::shared_ptr<State>;
+  pState_t m_pState;
+
+  std::thread m_threadSend;
+
+  void Sender();
+
+};
+
+} // namespace bridge
+} // namespace ou
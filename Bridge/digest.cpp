@@ -0,0 +1,194 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+  File:    digest.cpp
+  Project: Repertory/Bridge
+  Author:  raymond@burkholder.net
+  Created: October 19, 2026 15:52:08
+*/
+
+#include <cassert>
+#include <numeric>
+#include <algorithm>
+
+#include "digest.hpp"
+
+namespace {
+
+  const size_t c_nLineOverhead( 40 ); // tags, severity, count
+
+  // cut at or below nMax without splitting a utf-8 sequence
+  std::string_view Cut( const std::string_view& sv, size_t nMax ) {
+    if ( sv.size() <= nMax ) return sv;
+    size_t ix( nMax );
+    while ( ( 0 < ix ) && ( 0x80 == ( static_cast<unsigned char>( sv[ ix ] ) & 0xc0 ) ) ) --ix;
+    return sv.substr( 0, ix );
+  }
+
+} // namespace anonymous
+
+namespace ou {
+namespace bridge {
+
+const char* Name( ESeverity eSeverity ) {
+  switch ( eSeverity ) {
+    case ESeverity::info:     return "info";
+    case ESeverity::warning:  return "warn";
+    case ESeverity::error:    return "error";
+    case ESeverity::critical: return "CRIT";
+  }
+  return "?";
+}
+
+Digest::Digest( size_t nMaxChars, size_t nMaxTopic, size_t nMaxLine )
+: m_nMaxChars( nMaxChars ), m_nMaxTopic( nMaxTopic ), m_nMaxLine( nMaxLine )
+, m_nMessage {}, m_nOverflow {}, m_nEstimate {}
+, m_eHighest( ESeverity::info )
+{
+  assert( 256 <= nMaxChars );
+  m_vEntry.reserve( m_nMaxTopic );
+  m_umapTopic.reserve( m_nMaxTopic );
+}
+
+void Digest::Escape( const std::string_view& sv, std::string& sOut ) {
+  for ( const char ch: sv ) {
+    switch ( ch ) {
+      case '&': sOut += "&amp;"; break;
+      case '<': sOut += "&lt;"; break;
+      case '>': sOut += "&gt;"; break;
+      case '\n':
+      case '\r':
+      case '\t':
+        sOut += ' ';
+        break;
+      default:
+        if ( 0x20 > static_cast<unsigned char>( ch ) ) sOut += ' ';
+        else sOut += ch;
+        break;
+    }
+  }
+}
+
+size_t Digest::Cost( const Entry& entry ) {
+  return c_nLineOverhead + entry.sTopic.size() + entry.sMessage.size();
+}
+
+void Digest::Add( ESeverity eSeverity, const std::string_view& svTopic, const std::string_view& svMessage ) {
+
+  ++m_nMessage;
+  if ( m_eHighest < eSeverity ) m_eHighest = eSeverity;
+
+  const std::string sTopic( svTopic );
+  umapTopic_t::iterator iter = m_umapTopic.find( sTopic );
+  if ( m_umapTopic.end() == iter ) {
+    if ( m_nMaxTopic <= m_vEntry.size() ) {
+      ++m_nOverflow;
+      return;
+    }
+    m_umapTopic.emplace( sTopic, m_vEntry.size() );
+    m_vEntry.emplace_back( Entry{ eSeverity, 1, sTopic, std::string( Cut( svMessage, m_nMaxLine ) ) } );
+    m_nEstimate += Cost( m_vEntry.back() );
+  }
+  else {
+    Entry& entry( m_vEntry[ iter->second ] );
+    m_nEstimate -= Cost( entry );
+    if ( entry.eHighest < eSeverity ) entry.eHighest = eSeverity;
+    ++entry.nCount;
+    entry.sMessage.assign( Cut( svMessage, m_nMaxLine ) );
+    m_nEstimate += Cost( entry );
+  }
+}
+
+void Digest::Line( const Entry& entry, std::string& sOut ) const {
+  sOut += "<b>";
+  sOut += Name( entry.eHighest );
+  sOut += "</b> <code>";
+  Escape( entry.sTopic, sOut );
+  sOut += "</code>";
+  if ( 1 < entry.nCount ) {
+    sOut += " x";
+    sOut += std::to_string( entry.nCount );
+  }
+  sOut += ": ";
+  Escape( entry.sMessage, sOut );
+  sOut += '\n';
+}
+
+std::string Digest::Take() {
+
+  std::string sDigest;
+  if ( Empty() ) return sDigest;
+
+  sDigest.reserve( m_nMaxChars );
+
+  sDigest += "<b>";
+  sDigest += std::to_string( m_nMessage );
+  sDigest += 1 == m_nMessage ? " alarm" : " alarms";
+  if ( 1 < m_vEntry.size() ) {
+    sDigest += ", ";
+    sDigest += std::to_string( m_vEntry.size() + ( 0 < m_nOverflow ? 1 : 0 ) );
+    sDigest += 0 < m_nOverflow ? "+ topics" : " topics";
+  }
+  sDigest += "</b>\n";
+
+  std::vector<size_t> vOrder( m_vEntry.size() );
+  std::iota( vOrder.begin(), vOrder.end(), 0 );
+  std::stable_sort(
+    vOrder.begin(), vOrder.end(),
+    [this]( size_t lhs, size_t rhs ){ return m_vEntry[ lhs ].eHighest > m_vEntry[ rhs ].eHighest; } );
+
+  static const size_t c_nTrailer( 64 ); // room for the "more" line
+  const size_t nBudget( m_nMaxChars - c_nTrailer );
+
+  std::string sLine;
+  size_t nOmitted {};
+  size_t nOmittedTopic {};
+  for ( const size_t ix: vOrder ) {
+    const Entry& entry( m_vEntry[ ix ] );
+    sLine.clear();
+    Line( entry, sLine );
+    if ( nBudget < ( sDigest.size() + sLine.size() ) ) {
+      nOmitted += entry.nCount;
+      ++nOmittedTopic;
+    }
+    else sDigest += sLine;
+  }
+
+  nOmitted += m_nOverflow;
+  if ( 0 < nOmitted ) {
+    sDigest += "<i>... ";
+    sDigest += std::to_string( nOmitted );
+    sDigest += " more";
+    if ( 0 < nOmittedTopic ) {
+      sDigest += " on ";
+      sDigest += std::to_string( nOmittedTopic );
+      sDigest += 0 < m_nOverflow ? "+ topics" : ( 1 == nOmittedTopic ? " topic" : " topics" );
+    }
+    sDigest += "</i>";
+  }
+  assert( sDigest.size() <= m_nMaxChars );
+
+  m_umapTopic.clear();
+  m_vEntry.clear();
+  m_nMessage = 0;
+  m_nOverflow = 0;
+  m_nEstimate = 0;
+  m_eHighest = ESeverity::info;
+
+  return sDigest;
+}
+
+} // namespace bridge
+} // namespace ou
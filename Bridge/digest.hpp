@@ -0,0 +1,88 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+ * File:    digest.hpp
+ * Project: Repertory/Bridge
+ * Author:  raymond@burkholder.net
+ * Created: October 19, 2026 15:52:08
+ */
+
+// alarms collected into one telegram message (parse_mode HTML)
+//   repeats on a topic are folded into one line with a count and the latest message,
+//   lines are ordered by severity then arrival, the rendered text never exceeds the budget
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <string_view>
+#include <unordered_map>
+
+namespace ou {
+namespace bridge {
+
+enum class ESeverity { info = 0, warning, error, critical };
+
+const char* Name( ESeverity );
+
+class Digest {
+public:
+
+  // nMaxChars: telegram accepts at most 4096 characters per message, bytes are counted, which is conservative
+  //   nMaxTopic: distinct topics held, further topics are counted but not listed
+  //   nMaxLine: message text per line, longer is cut on a utf-8 boundary
+  Digest( size_t nMaxChars = 4096, size_t nMaxTopic = 512, size_t nMaxLine = 256 );
+
+  void Add( ESeverity, const std::string_view& svTopic, const std::string_view& svMessage );
+
+  bool Empty() const { return 0 == m_nMessage; }
+  ESeverity Highest() const { return m_eHighest; }
+  size_t Estimate() const { return m_nEstimate; } // approximate rendered size, for deciding to send early
+
+  std::string Take(); // rendered, then cleared
+
+  static void Escape( const std::string_view&, std::string& sOut ); // html text: &, <, >
+
+protected:
+private:
+
+  struct Entry {
+    ESeverity eHighest;
+    size_t nCount;
+    std::string sTopic;
+    std::string sMessage; // latest, already cut to m_nMaxLine
+  };
+  using vEntry_t = std::vector<Entry>; // arrival order
+
+  using umapTopic_t = std::unordered_map<std::string, size_t>; // index into m_vEntry
+  umapTopic_t m_umapTopic;
+  vEntry_t m_vEntry;
+
+  const size_t m_nMaxChars;
+  const size_t m_nMaxTopic;
+  const size_t m_nMaxLine;
+
+  size_t m_nMessage;
+  size_t m_nOverflow; // messages on topics beyond m_nMaxTopic
+  size_t m_nEstimate;
+  ESeverity m_eHighest;
+
+  void Line( const Entry&, std::string& sOut ) const;
+  static size_t Cost( const Entry& );
+
+};
+
+} // namespace bridge
+} // namespace ou
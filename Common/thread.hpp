@@ -0,0 +1,227 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+ * File:    thread.hpp
+ * Project: Repertory/Common
+ * Author:  raymond@burkholder.net
+ * Created: October 19, 2026 23:52:14
+ */
+
+// placement of the threads started by the libraries: name, allowed cpus, scheduling policy and priority
+//   each thread announces its role with Enter as its first statement, and takes whatever was configured
+//   for that role at that moment, so configure before constructing the objects starting the threads
+//   threads started by others, paho's callback thread, call EnterOnce on each entry to our code
+//
+//   roles:
+//     mqtt.connect    connect and reconnect attempts, one per Mqtt
+//     mqtt.callback   paho's receive thread, running subscription handlers and publish completions
+//     mqtt.asio       TransportAsio's own io_context, when not given an executor, as mqtt.callback for paho
+//     mqtt.health     Mqtt::StartHealth
+//     mqtt.loopback   Loopback delivery
+//     mqtt.rpc        Rpc timeouts
+//     mqtt.lanes      Lanes sender
+//     mqtt.batcher    Batcher flush
+//     mqtt.downsample Downsample windows
+//     mqtt.blob       blob::Sender
+//     mqtt.blob.stall blob::Receiver stall checks
+//     telegram.io     Bot, asio io_context::run, https requests and their completions
+//     bridge.alert    Alert digests
+//
+//   the thread name is the role, truncated to the 15 characters linux keeps, and shows in top -H, ps -L and gdb
+//   linux only, elsewhere Enter calls the hook and does nothing more
+
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <functional>
+#include <unordered_map>
+
+#if defined( __linux__ )
+#include <sched.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
+
+namespace ou {
+namespace thread {
+
+enum class ESched { inherit, other, batch, idle, fifo, rr };
+
+struct Placement {
+  std::vector<int> vCpu; // allowed cpus, empty inherits the process mask
+  ESched eSched;
+  int nPriority; // 1 .. 99 with fifo and rr, the nice value ( -20 .. 19 ) with other and batch, unused otherwise
+  Placement(): eSched( ESched::inherit ), nPriority {} {}
+  Placement( const std::vector<int>& vCpu_, ESched eSched_ = ESched::inherit, int nPriority_ = 0 )
+  : vCpu( vCpu_ ), eSched( eSched_ ), nPriority( nPriority_ ) {}
+};
+
+// "0-3,8,10-11" to { 0, 1, 2, 3, 8, 10, 11 }, empty on a malformed list
+inline std::vector<int> Cpus( const std::string& sList ) {
+  std::vector<int> vCpu;
+  size_t ix {};
+  while ( ix < sList.size() ) {
+    size_t ixEnd( sList.find( ',', ix ) );
+    if ( std::string::npos == ixEnd ) ixEnd = sList.size();
+    const std::string sRange( sList.substr( ix, ixEnd - ix ) );
+    const size_t ixDash( sRange.find( '-' ) );
+    try {
+      size_t nUsed {};
+      const int first( std::stoi( sRange, &nUsed ) );
+      int last( first );
+      if ( std::string::npos != ixDash ) last = std::stoi( sRange.substr( ixDash + 1 ) );
+      else if ( nUsed != sRange.size() ) return std::vector<int>();
+      if ( ( 0 > first ) || ( last < first ) ) return std::vector<int>();
+      for ( int cpu = first; cpu <= last; ++cpu ) vCpu.push_back( cpu );
+    }
+    catch ( const std::exception& ) {
+      return std::vector<int>();
+    }
+    ix = ixEnd + 1;
+  }
+  return vCpu;
+}
+
+// called on each library thread after its placement is applied, eg to register with a profiler or watchdog
+using fEnter_t = std::function<void( const std::string& sRole )>;
+
+namespace detail {
+
+  struct Registry {
+    std::mutex mutex;
+    std::unordered_map<std::string, Placement> umapPlacement;
+    fEnter_t fEnter;
+  };
+
+  inline Registry& Get() {
+    static Registry registry;
+    return registry;
+  }
+
+} // namespace detail
+
+// for threads entering later, those already running keep what they had
+inline void Configure( const std::string& sRole, const Placement& placement ) {
+  detail::Registry& registry( detail::Get() );
+  std::lock_guard<std::mutex> lock( registry.mutex );
+  registry.umapPlacement[ sRole ] = placement;
+}
+
+inline void SetHook( fEnter_t&& fEnter ) {
+  detail::Registry& registry( detail::Get() );
+  std::lock_guard<std::mutex> lock( registry.mutex );
+  registry.fEnter = std::move( fEnter );
+}
+
+// applies to the calling thread, 0 or the errno of the first failure, which is logged,
+//   the thread carries on where the scheduler put it
+inline int Apply( const Placement& placement ) {
+
+  int result {};
+
+#if defined( __linux__ )
+
+  if ( !placement.vCpu.empty() ) {
+    cpu_set_t set;
+    CPU_ZERO( &set );
+    for ( const int cpu: placement.vCpu ) {
+      if ( ( 0 <= cpu ) && ( CPU_SETSIZE > cpu ) ) CPU_SET( cpu, &set );
+    }
+    const int error( pthread_setaffinity_np( pthread_self(), sizeof( set ), &set ) );
+    if ( 0 != error ) {
+      std::cerr << "thread affinity failed: " << std::strerror( error ) << std::endl;
+      if ( 0 == result ) result = error;
+    }
+  }
+
+  if ( ESched::inherit != placement.eSched ) {
+    int policy {};
+    sched_param param {};
+    switch ( placement.eSched ) {
+      case ESched::other: policy = SCHED_OTHER; break;
+      case ESched::batch: policy = SCHED_BATCH; break;
+      case ESched::idle:  policy = SCHED_IDLE;  break;
+      case ESched::fifo:  policy = SCHED_FIFO;  param.sched_priority = placement.nPriority; break;
+      case ESched::rr:    policy = SCHED_RR;    param.sched_priority = placement.nPriority; break;
+      case ESched::inherit: break;
+    }
+    int error( pthread_setschedparam( pthread_self(), policy, &param ) );
+    if ( ( 0 == error ) && ( ( ESched::other == placement.eSched ) || ( ESched::batch == placement.eSched ) ) ) {
+      // nice is per thread on linux, addressed by thread id
+      if ( 0 != setpriority( PRIO_PROCESS, static_cast<id_t>( syscall( SYS_gettid ) ), placement.nPriority ) ) error = errno;
+    }
+    if ( 0 != error ) {
+      std::cerr << "thread scheduling failed: " << std::strerror( error ) << std::endl; // EPERM without CAP_SYS_NICE or an rtprio limit
+      if ( 0 == result ) result = error;
+    }
+  }
+
+#else
+  (void)placement;
+#endif
+
+  return result;
+}
+
+// first statement of each library thread
+inline int Enter( const std::string& sRole ) {
+
+  bool bPlacement {};
+  Placement placement;
+  fEnter_t fEnter;
+  {
+    detail::Registry& registry( detail::Get() );
+    std::lock_guard<std::mutex> lock( registry.mutex );
+    auto iter = registry.umapPlacement.find( sRole );
+    if ( registry.umapPlacement.end() != iter ) {
+      bPlacement = true;
+      placement = iter->second;
+    }
+    fEnter = registry.fEnter;
+  }
+
+#if defined( __linux__ )
+  const std::string sName( sRole.substr( 0, 15 ) );
+  pthread_setname_np( pthread_self(), sName.c_str() );
+#endif
+
+  int result {};
+  if ( bPlacement ) {
+    result = Apply( placement );
+    if ( 0 != result ) std::cerr << "thread " << sRole << " placement incomplete" << std::endl;
+  }
+
+  if ( fEnter ) fEnter( sRole );
+  return result;
+}
+
+// for threads we do not start, applied on the first entry of each, a thread_local test after that
+inline void EnterOnce( const char* szRole ) {
+  thread_local bool bEntered( false );
+  if ( !bEntered ) {
+    bEntered = true;
+    Enter( szRole );
+  }
+}
+
+} // namespace thread
+} // namespace ou
@@ -0,0 +1,235 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+  File:    batcher.cpp
+  Project: Repertory/MQTT
+  Author:  raymond@burkholder.net
+  Created: October 19, 2026 21:10:05
+*/
+
+#include <cassert>
+#include <algorithm>
+
+#include <thread.hpp>
+
+#include "batcher.hpp"
+
+namespace ou {
+namespace mqtt {
+
+Batcher::State::State( const Config& config_, const std::string& sBase_ )
+: config( config_ )
+, sBase( sBase_ )
+, sTopicBatch( envelope::Topic( sBase_ ) )
+, bRunning( true ), bSending( false )
+, nInFlight {}, nBatch( config_.nBatchMin ), dblAck_us {}
+, dblGap_us( config_.maxDelay.count() )
+, nQoS {}
+, nRecord {}, nSingle {}, nEnvelope {}, nEnveloped {}
+, nDirect {}
+{}
+
+Batcher::State::EDue Batcher::State::Due( clock_t_::time_point now ) const {
+  if ( 0 == writer.Records() ) return EDue::no;
+  if ( nInFlight < config.nInFlight ) {
+    // qos 0 completes inline and never holds a slot, the arrival rate is its depth
+    const bool bBurst( ( 0 == nQoS ) && ( dblGap_us < config.burst.count() ) );
+    if ( !bBurst ) return EDue::slot;
+  }
+  if ( nBatch <= writer.Records() ) return EDue::count;
+  if ( config.nMaxBytes <= writer.Size() ) return EDue::bytes;
+  if ( ( tpFirst + config.maxDelay ) <= now ) return EDue::delay;
+  return EDue::no;
+}
+
+Batcher::Batcher( Mqtt& mqtt, const std::string& sBase, const Config& config )
+: m_pState( std::make_shared<State>( config, sBase ) )
+, m_mqtt( mqtt )
+{
+  assert( 0 < config.nInFlight );
+  assert( ( 0 < config.nBatchMin ) && ( config.nBatchMin <= config.nBatchMax ) );
+  m_threadFlush = std::thread( [this](){ ou::thread::Enter( "mqtt.batcher" ); Flush(); } );
+}
+
+Batcher::~Batcher() {
+  {
+    std::lock_guard<std::mutex> lock( m_pState->mutex );
+    m_pState->bRunning = false;
+  }
+  m_pState->cv.notify_one();
+  if ( m_threadFlush.joinable() ) m_threadFlush.join();
+
+  std::unique_lock<std::mutex> lock( m_pState->mutex );
+  if ( !m_pState->bSending ) {
+    m_pState->bSending = true;
+    Send( lock, true );
+  }
+}
+
+void Batcher::Publish( const std::string_view& svTopic, const std::string_view& svMessage, int nQoS, Mqtt::fPublishComplete_t&& fPublishComplete ) {
+
+  State& state( *m_pState );
+
+  const size_t nBase( state.sBase.size() );
+  const bool bRecord(
+       ( state.config.nSmall >= svMessage.size() )
+    && ( ( nBase + 1 ) < svTopic.size() )
+    && ( '/' == svTopic[ nBase ] )
+    && ( state.sBase == svTopic.substr( 0, nBase ) )
+  );
+  if ( !bRecord ) {
+    state.nDirect.fetch_add( 1, std::memory_order_relaxed );
+    m_mqtt.Publish( svTopic, svMessage, nQoS, std::move( fPublishComplete ) );
+    return;
+  }
+
+  const clock_t_::time_point now( clock_t_::now() );
+  std::unique_lock<std::mutex> lock( state.mutex );
+
+  const double dblGap( std::min<double>(
+    std::chrono::duration<double, std::micro>( now - state.tpLast ).count(), state.config.maxDelay.count() ) );
+  state.dblGap_us += ( dblGap - state.dblGap_us ) / 8.0;
+  state.tpLast = now;
+
+  const bool bFirst( 0 == state.writer.Records() );
+  if ( bFirst ) state.tpFirst = now;
+  state.writer.Append( svTopic.substr( nBase + 1 ), svMessage );
+  state.vRecord.emplace_back( Record{ std::move( fPublishComplete ), now } );
+  state.nQoS = std::max( state.nQoS, nQoS );
+  ++state.nRecord;
+
+  if ( !state.bSending && ( State::EDue::no != state.Due( now ) ) ) {
+    state.bSending = true;
+    Send( lock, false );
+  }
+  else {
+    if ( bFirst ) {
+      lock.unlock();
+      state.cv.notify_one(); // arm maxDelay
+    }
+  }
+}
+
+void Batcher::Send( std::unique_lock<std::mutex>& lock, bool bForce ) {
+
+  State& state( *m_pState );
+  const Config& config( state.config );
+
+  while ( true ) {
+
+    const State::EDue eDue( state.Due( clock_t_::now() ) );
+    if ( ( State::EDue::no == eDue ) && !( bForce && ( 0 < state.writer.Records() ) ) ) break;
+
+    const size_t nRecord( state.writer.Records() );
+    switch ( eDue ) {
+      case State::EDue::count: // depth outruns the acks
+        state.nBatch = std::min( 2 * state.nBatch, config.nBatchMax );
+        break;
+      case State::EDue::delay:
+        if ( nRecord < ( state.nBatch / 2 ) ) {
+          state.nBatch = std::max( state.nBatch - std::max<size_t>( state.nBatch / 4, 1 ), config.nBatchMin );
+        }
+        break;
+      default:
+        break;
+    }
+
+    std::swap( state.writer, state.spare );
+    state.writer.Clear();
+    vRecord_t vRecord;
+    vRecord.swap( state.vRecord );
+    const int nQoS( state.nQoS );
+    state.nQoS = 0;
+    ++state.nInFlight;
+    if ( 1 == nRecord ) ++state.nSingle;
+    else {
+      ++state.nEnvelope;
+      state.nEnveloped += nRecord;
+    }
+
+    lock.unlock(); // a completion may run inline, spare is ours while bSending is set
+
+    pState_t pState( m_pState );
+    Mqtt::fPublishComplete_t fPublishComplete(
+      [pState,vRecord=std::move( vRecord ),tpSent=clock_t_::now()]( bool bOk, int rc ){
+        const clock_t_::time_point now( clock_t_::now() );
+        {
+          State& state( *pState );
+          std::lock_guard<std::mutex> lock( state.mutex );
+          --state.nInFlight;
+          const double dblSample( std::chrono::duration<double, std::micro>( now - tpSent ).count() );
+          state.dblAck_us += ( dblSample - state.dblAck_us ) / 8.0;
+          if ( state.config.target.count() < state.dblAck_us ) {
+            state.nBatch = std::min( state.nBatch + state.nBatch / 4 + 1, state.config.nBatchMax );
+          }
+        }
+        pState->cv.notify_one(); // a slot is free
+        for ( const Record& record: vRecord ) {
+          pState->histogram.Add( std::chrono::duration_cast<std::chrono::microseconds>( now - record.tpQueued ) );
+          record.fPublishComplete( bOk, rc );
+        }
+      } );
+
+    if ( 1 == nRecord ) { // on its own topic, as though not batched
+      envelope::Reader reader( state.spare );
+      std::string_view svSuffix, svPayload;
+      reader.Next( svSuffix, svPayload );
+      std::string sTopic;
+      sTopic.reserve( state.sBase.size() + 1 + svSuffix.size() );
+      sTopic += state.sBase;
+      sTopic += '/';
+      sTopic += svSuffix;
+      m_mqtt.Publish( sTopic, svPayload, nQoS, std::move( fPublishComplete ) );
+    }
+    else {
+      m_mqtt.Publish( state.sTopicBatch, state.spare, nQoS, std::move( fPublishComplete ) );
+    }
+
+    lock.lock();
+  }
+
+  state.bSending = false;
+  if ( 0 < state.writer.Records() ) state.cv.notify_one(); // left for the flush thread
+}
+
+void Batcher::Flush() {
+
+  State& state( *m_pState );
+  std::unique_lock<std::mutex> lock( state.mutex );
+
+  while ( state.bRunning ) {
+    if ( state.bSending || ( 0 == state.writer.Records() ) ) {
+      state.cv.wait( lock );
+      continue;
+    }
+    if ( State::EDue::no == state.Due( clock_t_::now() ) ) {
+      state.cv.wait_until( lock, state.tpFirst + state.config.maxDelay );
+      continue;
+    }
+    state.bSending = true;
+    Send( lock, false );
+  }
+}
+
+Batcher::Stats Batcher::GetStats() const {
+  const State& state( *m_pState );
+  std::lock_guard<std::mutex> lock( state.mutex );
+  return Stats{
+    state.nRecord, state.nDirect.load( std::memory_order_relaxed ), state.nSingle, state.nEnvelope, state.nEnveloped,
+    state.nBatch, state.writer.Records(), static_cast<uint64_t>( state.dblAck_us ), state.histogram.Take() };
+}
+
+} // namespace mqtt
+} // namespace ou
@@ -0,0 +1,147 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+ * File:    batcher.hpp
+ * Project: Repertory/MQTT
+ * Author:  raymond@burkholder.net
+ * Created: October 19, 2026 21:10:05
+ */
+
+// adaptive coalescing in front of Mqtt::Publish, Nagle-like, driven by acks and queue depth
+//
+//   small payloads on topics under a base are records, anything else goes straight to Mqtt::Publish
+//   with fewer than nInFlight publishes awaiting completion, a record is sent at once, on its own topic,
+//     except at qos 0, which completes inside Mqtt::Publish and so never holds a slot:
+//     there records wait while they arrive, smoothed, closer together than burst
+//   otherwise records wait and go out together as one envelope (see envelope.hpp) on <base>/$batch, when
+//     a completion frees a slot, nBatch records are waiting, nMaxBytes is reached, or the first waited maxDelay
+//
+//   nBatch adapts: doubled when records reach it before a slot frees (depth outruns the acks),
+//     raised by a quarter when the smoothed ack latency is above target, lowered by a quarter when
+//     an envelope leaves on maxDelay short of half of nBatch
+//   records keep their order among themselves, not against publishes that bypass the batcher
+//   each record completes with its envelope's result, latency is kept per record, Publish to completion
+
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <string_view>
+#include <condition_variable>
+
+#include "mqtt.hpp"
+#include "envelope.hpp"
+#include "histogram.hpp"
+
+namespace ou {
+namespace mqtt {
+
+class Batcher {
+public:
+
+  struct Config {
+    size_t nSmall;     // largest payload taken as a record
+    size_t nMaxBytes;  // envelope is sent once it reaches this size
+    size_t nInFlight;  // publishes awaiting completion before records wait
+    size_t nBatchMin;
+    size_t nBatchMax;
+    std::chrono::microseconds maxDelay; // longest a record waits
+    std::chrono::microseconds target;   // ack latency above which envelopes grow
+    std::chrono::microseconds burst;    // qos 0 depth, records arriving closer than this wait
+    Config()
+    : nSmall( 256 ), nMaxBytes( 16384 ), nInFlight( 1 ), nBatchMin( 4 ), nBatchMax( 1024 )
+    , maxDelay( 5000 ), target( 10000 ), burst( 100 )
+    {}
+  };
+
+  // sBase without a trailing '/', receivers subscribe to <base>/#, or call Mqtt::AcceptEnvelopes( sBase )
+  Batcher( Mqtt&, const std::string& sBase, const Config& = Config() );
+  ~Batcher(); // waiting records are sent
+
+  // as Mqtt::Publish, topic and message are copied, an envelope goes at the highest qos of its records
+  void Publish( const std::string_view& svTopic, const std::string_view& svMessage, int nQoS, Mqtt::fPublishComplete_t&& );
+
+  struct Stats {
+    uint64_t nRecord;    // accepted as records
+    uint64_t nDirect;    // passed straight through, not records
+    uint64_t nSingle;    // records sent on their own topic
+    uint64_t nEnvelope;  // envelopes sent
+    uint64_t nEnveloped; // records sent in envelopes
+    size_t nBatch;       // current target records per envelope
+    size_t nWaiting;     // records waiting now
+    uint64_t ack_us;     // smoothed publish to completion latency
+    Histogram::Snapshot latency; // per record
+  };
+  Stats GetStats() const;
+
+protected:
+private:
+
+  using clock_t_ = std::chrono::steady_clock;
+
+  struct Record {
+    Mqtt::fPublishComplete_t fPublishComplete;
+    clock_t_::time_point tpQueued;
+  };
+  using vRecord_t = std::vector<Record>;
+
+  // shared with completions, which may arrive after destruction
+  struct State {
+    const Config config;
+    const std::string sBase;
+    const std::string sTopicBatch;
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+    bool bRunning;
+    bool bSending;        // a thread is in Send, others leave their records to it
+    size_t nInFlight;
+    size_t nBatch;
+    double dblAck_us;     // smoothed
+    double dblGap_us;     // smoothed time between records
+    clock_t_::time_point tpLast; // latest record
+    envelope::Writer writer; // waiting records
+    envelope::Writer spare;  // being sent, swapped with writer
+    vRecord_t vRecord;
+    int nQoS;             // highest of the waiting records
+    clock_t_::time_point tpFirst; // oldest waiting record
+    uint64_t nRecord;
+    uint64_t nSingle;
+    uint64_t nEnvelope;
+    uint64_t nEnveloped;
+    std::atomic<uint64_t> nDirect;
+    Histogram histogram;
+    State( const Config&, const std::string& sBase );
+    enum class EDue { no, slot, count, bytes, delay };
+    EDue Due( clock_t_::time_point now ) const; // under mutex
+  };
+  using pState_t = std::shared_ptr<State>;
+  pState_t m_pState;
+
+  Mqtt& m_mqtt;
+  std::thread m_threadFlush;
+
+  void Send( std::unique_lock<std::mutex>&, bool bForce ); // with bSending set, clears it
+  void Flush(); // thread, for maxDelay and freed slots
+
+};
+
+} // namespace mqtt
+} // namespace ou
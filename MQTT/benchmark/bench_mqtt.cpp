@@ -0,0 +1,401 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+  File:    bench_mqtt.cpp
+  Project: Repertory/MQTT
+  Author:  raymond@burkholder.net
+  Created: October 19, 2026 09:12:40
+  publish/subscribe benchmarks against a broker on the loopback interface
+  results are written to stdout as one json object per line, progress to stderr
+*/
+
+#include <new>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <condition_variable>
+
+#include <unistd.h>
+
+#include "mqtt.hpp"
+#include "loopback.hpp"
+#if defined( OU_MQTT_ASIO )
+#include "transport_asio.hpp"
+#endif
+
+// count every allocation made through operator new, per process and per thread
+//   every form allocates with Allocate and releases with Release, so new and delete pair up
+
+namespace {
+
+  std::atomic<uint64_t> g_nAllocation( 0 );
+  thread_local uint64_t t_nAllocation( 0 );
+
+  void* Allocate( std::size_t n, std::size_t alignment ) {
+    ++g_nAllocation;
+    ++t_nAllocation;
+    void* p;
+    if ( alignof( std::max_align_t ) < alignment ) {
+      p = std::aligned_alloc( alignment, ( ( n ? n : 1 ) + alignment - 1 ) & ~( alignment - 1 ) ); // size a multiple of alignment
+    }
+    else {
+      p = std::malloc( n ? n : 1 );
+    }
+    if ( nullptr == p ) throw std::bad_alloc();
+    return p;
+  }
+
+  void Release( void* p ) noexcept { std::free( p ); }
+
+} // namespace anonymous
+
+void* operator new( std::size_t n ) { return Allocate( n, 0 ); }
+void* operator new[]( std::size_t n ) { return Allocate( n, 0 ); }
+void* operator new( std::size_t n, std::align_val_t a ) { return Allocate( n, static_cast<std::size_t>( a ) ); }
+void* operator new[]( std::size_t n, std::align_val_t a ) { return Allocate( n, static_cast<std::size_t>( a ) ); }
+
+void operator delete( void* p ) noexcept { Release( p ); }
+void operator delete[]( void* p ) noexcept { Release( p ); }
+void operator delete( void* p, std::size_t ) noexcept { Release( p ); }
+void operator delete[]( void* p, std::size_t ) noexcept { Release( p ); }
+void operator delete( void* p, std::align_val_t ) noexcept { Release( p ); }
+void operator delete[]( void* p, std::align_val_t ) noexcept { Release( p ); }
+void operator delete( void* p, std::size_t, std::align_val_t ) noexcept { Release( p ); }
+void operator delete[]( void* p, std::size_t, std::align_val_t ) noexcept { Release( p ); }
+
+namespace {
+
+using clock_t_ = std::chrono::steady_clock;
+
+struct Options {
+  std::string sHost;
+  std::string sPort;
+  std::string sLabel;
+  size_t nMessage;
+  size_t nPayload;
+  size_t nWindow;  // maximum outstanding qos 1 publishes
+  std::string sTransport; // paho, asio (transport_asio.hpp), or loopback to measure library overhead alone
+  Options()
+  : sHost( "127.0.0.1" ), sPort( "1883" ), sLabel( "unlabelled" )
+  , nMessage( 100000 ), nPayload( 64 ), nWindow( 64 )
+  , sTransport( "paho" )
+  {}
+};
+
+using pMqtt_t = std::unique_ptr<ou::Mqtt>;
+
+pMqtt_t Construct( const Options& options, const std::string& sId, ou::mqtt::Loopback& bus ) {
+  ou::mqtt::Config config;
+  config.sId = sId;
+  config.sHost = options.sHost;
+  config.sPort = options.sPort;
+  if ( "loopback" == options.sTransport ) {
+    return std::make_unique<ou::Mqtt>( config, std::make_unique<ou::mqtt::TransportLoopback>( bus ) );
+  }
+#if defined( OU_MQTT_ASIO )
+  else if ( "asio" == options.sTransport ) {
+    return std::make_unique<ou::Mqtt>( config, std::make_unique<ou::mqtt::TransportAsio>() );
+  }
+#endif
+  else {
+    return std::make_unique<ou::Mqtt>( config );
+  }
+}
+
+// one json object per line, keys in insertion order
+class Result {
+public:
+  Result( const std::string& sBenchmark, const Options& options ) {
+    m_ss << std::fixed << std::setprecision( 3 );
+    m_ss << "{\"benchmark\":\"" << sBenchmark << "\",\"label\":\"" << options.sLabel << '"';
+    m_ss << ",\"transport\":\"" << options.sTransport << '"';
+    Add( "messages", options.nMessage );
+    Add( "payload_bytes", options.nPayload );
+  }
+  template<typename value_t>
+  Result& Add( const char* szKey, value_t value ) {
+    m_ss << ",\"" << szKey << "\":" << value;
+    return *this;
+  }
+  void Emit() {
+    m_ss << '}';
+    std::cout << m_ss.str() << std::endl;
+  }
+private:
+  std::stringstream m_ss;
+};
+
+double Seconds( clock_t_::duration duration ) {
+  return std::chrono::duration<double>( duration ).count();
+}
+
+// waits for outstanding completions to drain, with an upper bound so a stalled broker does not hang the run
+void Drain( std::atomic<size_t>& nOutstanding, std::chrono::seconds limit ) {
+  const clock_t_::time_point end = clock_t_::now() + limit;
+  while ( ( 0 < nOutstanding.load() ) && ( clock_t_::now() < end ) ) {
+    std::this_thread::sleep_for( std::chrono::microseconds( 100 ) );
+  }
+}
+
+void PublishThroughput( ou::Mqtt& mqtt, const Options& options, int nQoS ) {
+
+  const std::string sTopic( "bench/" + std::to_string( ::getpid() ) + "/throughput" );
+  const std::string sPayload( options.nPayload, 'x' );
+
+  // completions still pending after a stall or a bounded drain need somewhere safe to land,
+  //   they capture a plain pointer so allocs_per_msg stays the library's own (a shared_ptr is not stored inline),
+  //   and a state left with completions pending is parked for the life of the process
+  struct State {
+    std::atomic<size_t> nOutstanding {};
+    std::atomic<size_t> nFailed {};
+  };
+  using pState_t = std::shared_ptr<State>;
+  static std::vector<pState_t> vParked;
+  pState_t pState = std::make_shared<State>();
+  State* const state( pState.get() );
+  std::atomic<size_t>& nOutstanding( state->nOutstanding );
+
+  std::cerr << "publish throughput qos " << nQoS << " ..." << std::endl;
+
+  const uint64_t nAllocationStart( g_nAllocation.load() );
+  const clock_t_::time_point start( clock_t_::now() );
+
+  for ( size_t ix = 0; ix < options.nMessage; ++ix ) {
+    if ( options.nWindow <= nOutstanding.load( std::memory_order_acquire ) ) {
+      // Publish does not complete while disconnected, so bound the wait
+      const clock_t_::time_point stall = clock_t_::now() + std::chrono::seconds( 10 );
+      while ( options.nWindow <= nOutstanding.load( std::memory_order_acquire ) ) {
+        if ( stall < clock_t_::now() ) {
+          std::cerr << "publish throughput: window stalled at message " << ix << std::endl;
+          vParked.emplace_back( std::move( pState ) );
+          return;
+        }
+        std::this_thread::yield();
+      }
+    }
+    ++nOutstanding;
+    mqtt.Publish(
+      sTopic, sPayload, nQoS,
+      [state]( bool bStatus, int ){
+        if ( !bStatus ) ++state->nFailed;
+        --state->nOutstanding;
+      } );
+  }
+  Drain( nOutstanding, std::chrono::seconds( 10 ) );
+  if ( 0 < nOutstanding.load() ) vParked.push_back( pState );
+
+  const clock_t_::time_point end( clock_t_::now() );
+  const uint64_t nAllocation( g_nAllocation.load() - nAllocationStart );
+
+  const double seconds = Seconds( end - start );
+  Result( 0 == nQoS ? "publish_qos0" : "publish_qos1", options )
+    .Add( "qos", nQoS )
+    .Add( "window", options.nWindow )
+    .Add( "seconds", seconds )
+    .Add( "msgs_per_sec", options.nMessage / seconds )
+    .Add( "mbytes_per_sec", ( options.nMessage * options.nPayload ) / seconds / 1e6 )
+    .Add( "failed", state->nFailed.load() )
+    .Add( "unacked", nOutstanding.load() )
+    .Add( "allocs_per_msg", double( nAllocation ) / options.nMessage )
+    .Emit();
+}
+
+// one publish outstanding at a time, so the figure is the round trip to the broker plus library overhead
+void PublishLatency( ou::Mqtt& mqtt, const Options& options ) {
+
+  const std::string sTopic( "bench/" + std::to_string( ::getpid() ) + "/latency" );
+  const std::string sPayload( options.nPayload, 'x' );
+
+  const size_t nSample = std::min<size_t>( options.nMessage, 20000 );
+
+  // shared so a completion arriving after an ack timeout has somewhere safe to land
+  struct State {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<double> vLatency;
+    size_t nFailed {};
+    bool bDone {};
+  };
+  auto pState = std::make_shared<State>();
+  pState->vLatency.reserve( nSample );
+
+  std::cerr << "publish to ack latency ..." << std::endl;
+
+  for ( size_t ix = 0; ix < nSample; ++ix ) {
+    pState->bDone = false;
+    const clock_t_::time_point start( clock_t_::now() );
+    mqtt.Publish(
+      sTopic, sPayload, 1,
+      [pState,start]( bool bStatus, int ){
+        const clock_t_::time_point end( clock_t_::now() );
+        std::lock_guard<std::mutex> lock( pState->mutex );
+        if ( bStatus ) pState->vLatency.push_back( 1e6 * Seconds( end - start ) );
+        else ++pState->nFailed;
+        pState->bDone = true;
+        pState->cv.notify_one();
+      } );
+    std::unique_lock<std::mutex> lock( pState->mutex );
+    if ( !pState->cv.wait_for( lock, std::chrono::seconds( 5 ), [&pState]{ return pState->bDone; } ) ) {
+      std::cerr << "latency: ack timeout" << std::endl;
+      break;
+    }
+  }
+
+  std::lock_guard<std::mutex> lock( pState->mutex );
+  std::vector<double>& vLatency( pState->vLatency );
+  std::sort( vLatency.begin(), vLatency.end() );
+  auto percentile = [&vLatency]( double p )->double{
+    if ( vLatency.empty() ) return 0.0;
+    const size_t ix = std::min<size_t>( vLatency.size() - 1, size_t( p * vLatency.size() ) );
+    return vLatency[ ix ];
+  };
+
+  Options sampled( options );
+  sampled.nMessage = vLatency.size();
+  Result( "publish_ack_latency", sampled )
+    .Add( "failed", pState->nFailed )
+    .Add( "p50_us", percentile( 0.50 ) )
+    .Add( "p90_us", percentile( 0.90 ) )
+    .Add( "p99_us", percentile( 0.99 ) )
+    .Add( "p999_us", percentile( 0.999 ) )
+    .Add( "max_us", vLatency.empty() ? 0.0 : vLatency.back() )
+    .Emit();
+}
+
+// a second client subscribes, the first floods at qos 0, rate is measured at the dispatch callback
+void InboundDispatch( ou::Mqtt& mqtt, const Options& options, ou::mqtt::Loopback& bus ) {
+
+  const std::string sTopic( "bench/" + std::to_string( ::getpid() ) + "/inbound" );
+  const std::string sPayload( options.nPayload, 'x' );
+
+  // written on the dispatch thread, read here, outlive the subscriber
+  std::atomic<size_t> nReceived( 0 );
+  std::atomic<clock_t_::rep> first {};
+  std::atomic<clock_t_::rep> last {};
+  std::atomic<uint64_t> nAllocationFirst {};
+  std::atomic<uint64_t> nAllocationLast {};
+
+  pMqtt_t pSubscriber = Construct( options, "bench_sub_" + std::to_string( ::getpid() ), bus );
+  ou::Mqtt& subscriber( *pSubscriber );
+
+  subscriber.Subscribe(
+    sTopic,
+    [&]( const std::string_view&, const std::string_view& ){
+      const size_t n = ++nReceived;
+      const clock_t_::rep now( clock_t_::now().time_since_epoch().count() );
+      if ( 1 == n ) {
+        first.store( now, std::memory_order_relaxed );
+        nAllocationFirst.store( t_nAllocation, std::memory_order_relaxed ); // dispatch thread only
+      }
+      last.store( now, std::memory_order_relaxed );
+      nAllocationLast.store( t_nAllocation, std::memory_order_release );
+    } );
+  std::this_thread::sleep_for( std::chrono::milliseconds( 200 ) ); // let the subscription settle
+
+  std::cerr << "inbound dispatch ..." << std::endl;
+
+  for ( size_t ix = 0; ix < options.nMessage; ++ix ) {
+    mqtt.Publish( sTopic, sPayload, 0, []( bool, int ){} );
+  }
+
+  const clock_t_::time_point end = clock_t_::now() + std::chrono::seconds( 10 );
+  size_t nPrevious {};
+  while ( ( nReceived.load() < options.nMessage ) && ( clock_t_::now() < end ) ) {
+    std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
+    const size_t nNow = nReceived.load();
+    if ( ( 0 < nNow ) && ( nPrevious == nNow ) ) break; // qos 0 may drop, stop once the stream has stalled
+    nPrevious = nNow;
+  }
+
+  subscriber.UnSubscribe( sTopic );
+
+  const size_t n = nReceived.load();
+  const uint64_t nAllocation( nAllocationLast.load( std::memory_order_acquire ) - nAllocationFirst.load( std::memory_order_relaxed ) );
+  const double seconds = ( 1 < n ) ? Seconds( clock_t_::duration( last.load( std::memory_order_relaxed ) - first.load( std::memory_order_relaxed ) ) ) : 0.0;
+  Result( "inbound_dispatch", options )
+    .Add( "received", n )
+    .Add( "seconds", seconds )
+    .Add( "msgs_per_sec", ( 0.0 < seconds ) ? ( n - 1 ) / seconds : 0.0 )
+    .Add( "allocs_per_msg", ( 1 < n ) ? double( nAllocation ) / ( n - 1 ) : 0.0 )
+    .Emit();
+}
+
+void Usage( const char* szName ) {
+  std::cerr
+    << "usage: " << szName
+    << " [--host 127.0.0.1] [--port 1883] [--count 100000] [--size 64] [--window 64] [--label text]"
+    << " [--transport paho|asio|loopback]"
+    << std::endl;
+}
+
+} // namespace anonymous
+
+int main( int argc, char* argv[] ) {
+
+  Options options;
+
+  for ( int ix = 1; ix < argc; ++ix ) {
+    const std::string sArg( argv[ ix ] );
+    if ( ( ix + 1 ) == argc ) {
+      Usage( argv[ 0 ] );
+      return EXIT_FAILURE;
+    }
+    const std::string sValue( argv[ ++ix ] );
+    if ( "--host" == sArg ) options.sHost = sValue;
+    else if ( "--port" == sArg ) options.sPort = sValue;
+    else if ( "--label" == sArg ) options.sLabel = sValue;
+    else if ( "--count" == sArg ) options.nMessage = std::stoul( sValue );
+    else if ( "--size" == sArg ) options.nPayload = std::stoul( sValue );
+    else if ( "--window" == sArg ) options.nWindow = std::stoul( sValue );
+    else if ( "--transport" == sArg ) options.sTransport = sValue;
+    else {
+      Usage( argv[ 0 ] );
+      return EXIT_FAILURE;
+    }
+  }
+
+  bool bTransport( ( "paho" == options.sTransport ) || ( "loopback" == options.sTransport ) );
+#if defined( OU_MQTT_ASIO )
+  bTransport = bTransport || ( "asio" == options.sTransport );
+#endif
+  if ( !bTransport ) {
+    Usage( argv[ 0 ] );
+    return EXIT_FAILURE;
+  }
+
+  ou::mqtt::Loopback bus; // only used with --transport loopback
+
+  try {
+    pMqtt_t pMqtt = Construct( options, "bench_pub_" + std::to_string( ::getpid() ), bus );
+    ou::Mqtt& mqtt( *pMqtt );
+
+    PublishThroughput( mqtt, options, 0 );
+    PublishThroughput( mqtt, options, 1 );
+    PublishLatency( mqtt, options );
+    InboundDispatch( mqtt, options, bus );
+  }
+  catch ( const ou::Mqtt::runtime_error& e ) {
+    std::cerr << "mqtt error: " << e.what() << ',' << e.rc << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
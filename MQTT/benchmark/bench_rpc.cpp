@@ -0,0 +1,196 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+  File:    bench_rpc.cpp
+  Project: Repertory/MQTT
+  Author:  raymond@burkholder.net
+  Created: October 19, 2026 14:48:26
+  request/response latency and throughput at increasing pipeline depth
+  results are written to stdout as one json object per line, progress to stderr
+*/
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+
+#include <unistd.h>
+
+#include "rpc.hpp"
+#include "loopback.hpp"
+
+namespace {
+
+using clock_t_ = std::chrono::steady_clock;
+
+struct Options {
+  std::string sHost;
+  std::string sPort;
+  std::string sLabel;
+  std::string sTransport;
+  size_t nRequest;
+  size_t nPayload;
+  Options()
+  : sHost( "127.0.0.1" ), sPort( "1883" ), sLabel( "unlabelled" ), sTransport( "paho" )
+  , nRequest( 20000 ), nPayload( 32 )
+  {}
+};
+
+using pMqtt_t = std::unique_ptr<ou::Mqtt>;
+
+pMqtt_t Construct( const Options& options, const std::string& sId, ou::mqtt::Loopback& bus ) {
+  ou::mqtt::Config config;
+  config.sId = sId;
+  config.sHost = options.sHost;
+  config.sPort = options.sPort;
+  if ( "loopback" == options.sTransport ) {
+    return std::make_unique<ou::Mqtt>( config, std::make_unique<ou::mqtt::TransportLoopback>( bus ) );
+  }
+  else {
+    return std::make_unique<ou::Mqtt>( config );
+  }
+}
+
+void Run( ou::mqtt::Rpc& rpc, const std::string& sTopic, const Options& options, size_t nDepth ) {
+
+  struct State {
+    std::atomic<size_t> nInFlight;
+    std::atomic<size_t> nFailed;
+    std::mutex mutex;
+    std::vector<double> vLatency;
+    State(): nInFlight {}, nFailed {} {}
+  };
+  auto pState = std::make_shared<State>();
+  pState->vLatency.reserve( options.nRequest );
+
+  const std::string sPayload( options.nPayload, 'r' );
+
+  std::cerr << "rpc depth " << nDepth << " ..." << std::endl;
+
+  const clock_t_::time_point start( clock_t_::now() );
+  for ( size_t ix = 0; ix < options.nRequest; ++ix ) {
+    while ( nDepth <= pState->nInFlight.load() ) std::this_thread::yield();
+    ++pState->nInFlight;
+    const clock_t_::time_point tpRequest( clock_t_::now() );
+    rpc.Request(
+      sTopic, sPayload, std::chrono::milliseconds( 5000 ),
+      [pState,tpRequest]( ou::mqtt::Rpc::EResult result, const std::string_view& ){
+        if ( ou::mqtt::Rpc::EResult::reply == result ) {
+          const double us = std::chrono::duration<double, std::micro>( clock_t_::now() - tpRequest ).count();
+          std::lock_guard<std::mutex> lock( pState->mutex );
+          pState->vLatency.push_back( us );
+        }
+        else ++pState->nFailed;
+        --pState->nInFlight;
+      } );
+  }
+  while ( 0 < pState->nInFlight.load() ) std::this_thread::sleep_for( std::chrono::microseconds( 100 ) );
+  const double seconds = std::chrono::duration<double>( clock_t_::now() - start ).count();
+
+  std::lock_guard<std::mutex> lock( pState->mutex );
+  std::vector<double>& vLatency( pState->vLatency );
+  std::sort( vLatency.begin(), vLatency.end() );
+  auto percentile = [&vLatency]( double p )->double{
+    if ( vLatency.empty() ) return 0.0;
+    return vLatency[ std::min<size_t>( vLatency.size() - 1, size_t( p * vLatency.size() ) ) ];
+  };
+
+  std::stringstream ss;
+  ss << std::fixed << std::setprecision( 3 )
+     << "{\"benchmark\":\"rpc\",\"label\":\"" << options.sLabel << '"'
+     << ",\"transport\":\"" << options.sTransport << '"'
+     << ",\"requests\":" << options.nRequest
+     << ",\"payload_bytes\":" << options.nPayload
+     << ",\"depth\":" << nDepth
+     << ",\"failed\":" << pState->nFailed.load()
+     << ",\"seconds\":" << seconds
+     << ",\"requests_per_sec\":" << options.nRequest / seconds
+     << ",\"p50_us\":" << percentile( 0.50 )
+     << ",\"p90_us\":" << percentile( 0.90 )
+     << ",\"p99_us\":" << percentile( 0.99 )
+     << ",\"max_us\":" << ( vLatency.empty() ? 0.0 : vLatency.back() )
+     << '}';
+  std::cout << ss.str() << std::endl;
+}
+
+void Usage( const char* szName ) {
+  std::cerr
+    << "usage: " << szName
+    << " [--host 127.0.0.1] [--port 1883] [--count 20000] [--size 32] [--label text] [--transport paho|loopback]"
+    << std::endl;
+}
+
+} // namespace anonymous
+
+int main( int argc, char* argv[] ) {
+
+  Options options;
+
+  for ( int ix = 1; ix < argc; ++ix ) {
+    const std::string sArg( argv[ ix ] );
+    if ( ( ix + 1 ) == argc ) {
+      Usage( argv[ 0 ] );
+      return EXIT_FAILURE;
+    }
+    const std::string sValue( argv[ ++ix ] );
+    if ( "--host" == sArg ) options.sHost = sValue;
+    else if ( "--port" == sArg ) options.sPort = sValue;
+    else if ( "--label" == sArg ) options.sLabel = sValue;
+    else if ( "--count" == sArg ) options.nRequest = std::stoul( sValue );
+    else if ( "--size" == sArg ) options.nPayload = std::stoul( sValue );
+    else if ( "--transport" == sArg ) options.sTransport = sValue;
+    else {
+      Usage( argv[ 0 ] );
+      return EXIT_FAILURE;
+    }
+  }
+
+  ou::mqtt::Loopback bus; // only used with --transport loopback
+
+  try {
+    const std::string sPid( std::to_string( ::getpid() ) );
+    const std::string sTopic( "bench/" + sPid + "/device" );
+
+    pMqtt_t pDevice = Construct( options, "bench_device_" + sPid, bus );
+    pMqtt_t pClient = Construct( options, "bench_client_" + sPid, bus );
+
+    {
+      ou::mqtt::Rpc device( *pDevice, "bench/" + sPid + "/device_reply" );
+      device.Serve(
+        sTopic,
+        []( const std::string_view&, const std::string_view& svRequest, ou::mqtt::Rpc::fRespond_t&& fRespond ){
+          fRespond( svRequest ); // echo
+        } );
+
+      ou::mqtt::Rpc client( *pClient, "bench/" + sPid + "/reply" );
+      std::this_thread::sleep_for( std::chrono::milliseconds( 200 ) ); // let the subscriptions settle
+
+      for ( size_t nDepth: { 1, 8, 64, 256 } ) {
+        Run( client, sTopic, options, nDepth );
+      }
+    }
+  }
+  catch ( const ou::Mqtt::runtime_error& e ) {
+    std::cerr << "mqtt error: " << e.what() << ',' << e.rc << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,293 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+
+/*
+  File:    bench_share.cpp
+  Project: Repertory/MQTT
+  Author:  raymond@burkholder.net
+  Created: October 19, 2026 21:48:17
+  shared subscription scaling: 1 to n consumer processes in one $share group against a broker on the loopback interface
+  each consumer spends --work-us per message, standing in for application processing,
+  results are written to stdout as one json object per line, progress to stderr
+*/
+
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <condition_variable>
+
+#include <unistd.h>
+#include <signal.h>
+#include <sys/wait.h>
+
+#include "mqtt.hpp"
+
+namespace {
+
+using clock_t_ = std::chrono::steady_clock; // CLOCK_MONOTONIC, comparable between processes
+
+struct Options {
+  std::string sHost;
+  std::string sPort;
+  std::string sLabel;
+  size_t nMessage;
+  size_t nPayload;
+  size_t nConsumerMax;
+  std::chrono::microseconds work;
+  Options()
+  : sHost( "127.0.0.1" ), sPort( "1883" ), sLabel( "unlabelled" )
+  , nMessage( 200000 ), nPayload( 64 ), nConsumerMax( 8 ), work( 20 )
+  {}
+};
+
+struct Consumed { // reported by each consumer through its pipe
+  uint64_t nMessage;
+  int64_t nsFirst;
+  int64_t nsLast;
+};
+
+int64_t Nanoseconds( clock_t_::time_point tp ) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>( tp.time_since_epoch() ).count();
+}
+
+ou::mqtt::Config Configure( const Options& options, const std::string& sId ) {
+  ou::mqtt::Config config;
+  config.sId = sId;
+  config.sHost = options.sHost;
+  config.sPort = options.sPort;
+  return config;
+}
+
+// in the child, reports "ready", then the count once the stop arrives on the control topic
+int Consumer( const Options& options, const std::string& sBase, size_t ixConsumer, int fd ) {
+
+  struct State {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool bStop {};
+    Consumed consumed {};
+  };
+  auto pState = std::make_shared<State>();
+
+  try {
+    ou::Mqtt mqtt( Configure( options, "bench_share_" + std::to_string( ::getpid() ) + "_" + std::to_string( ixConsumer ) ) );
+
+    mqtt.Subscribe(
+      "$share/bench/" + sBase + "/data/#",
+      [pState,work=options.work]( const std::string_view&, const std::string_view& ){
+        const clock_t_::time_point now( clock_t_::now() );
+        Consumed& consumed( pState->consumed ); // only the mqtt thread writes until stop
+        if ( 0 == consumed.nMessage ) consumed.nsFirst = Nanoseconds( now );
+        ++consumed.nMessage;
+        while ( ( now + work ) > clock_t_::now() ) {} // busy, as application processing
+        consumed.nsLast = Nanoseconds( clock_t_::now() );
+      } );
+    mqtt.Subscribe(
+      sBase + "/control",
+      [pState]( const std::string_view&, const std::string_view& ){
+        std::lock_guard<std::mutex> lock( pState->mutex );
+        pState->bStop = true;
+        pState->cv.notify_one();
+      } );
+
+    std::this_thread::sleep_for( std::chrono::milliseconds( 200 ) );
+    if ( 6 != ::write( fd, "ready\n", 6 ) ) return EXIT_FAILURE;
+
+    std::unique_lock<std::mutex> lock( pState->mutex );
+    pState->cv.wait( lock, [pState]{ return pState->bStop; } );
+  }
+  catch ( const ou::Mqtt::runtime_error& e ) {
+    std::cerr << "consumer " << ixConsumer << " mqtt error: " << e.what() << ',' << e.rc << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const Consumed& consumed( pState->consumed );
+  const std::string sLine(
+    std::to_string( consumed.nMessage ) + ' ' + std::to_string( consumed.nsFirst ) + ' ' + std::to_string( consumed.nsLast ) + '\n' );
+  return ( ssize_t( sLine.size() ) == ::write( fd, sLine.data(), sLine.size() ) ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+bool ReadLine( FILE* pFile, std::string& sLine ) {
+  sLine.clear();
+  int ch;
+  while ( EOF != ( ch = std::fgetc( pFile ) ) ) {
+    if ( '\n' == ch ) return true;
+    sLine.push_back( static_cast<char>( ch ) );
+  }
+  return false;
+}
+
+// false when a consumer could not be started, the parent forks before creating its own client
+bool Run( const Options& options, size_t nConsumer, double& dblBaseline ) {
+
+  const std::string sBase( "bench/" + std::to_string( ::getpid() ) + "/share_" + std::to_string( nConsumer ) );
+
+  std::cerr << "shared subscription, " << nConsumer << " consumers ..." << std::endl;
+
+  std::vector<pid_t> vPid;
+  std::vector<FILE*> vPipe;
+  for ( size_t ix = 0; ix < nConsumer; ++ix ) {
+    int rfd[ 2 ];
+    if ( 0 != ::pipe( rfd ) ) return false;
+    const pid_t pid( ::fork() );
+    if ( 0 > pid ) return false;
+    if ( 0 == pid ) {
+      ::close( rfd[ 0 ] );
+      ::_exit( Consumer( options, sBase, ix, rfd[ 1 ] ) );
+    }
+    ::close( rfd[ 1 ] );
+    vPid.push_back( pid );
+    vPipe.push_back( ::fdopen( rfd[ 0 ], "r" ) );
+  }
+
+  bool bReady( true );
+  std::string sLine;
+  for ( FILE* pFile: vPipe ) {
+    if ( !ReadLine( pFile, sLine ) || ( "ready" != sLine ) ) bReady = false;
+  }
+
+  size_t nFailed {};
+  double seconds {};
+  if ( bReady ) {
+    ou::Mqtt mqtt( Configure( options, "bench_share_pub_" + std::to_string( ::getpid() ) ) );
+    const std::string sPayload( options.nPayload, 'x' );
+    std::vector<std::string> vTopic;
+    for ( size_t ix = 0; ix < 64; ++ix ) vTopic.emplace_back( sBase + "/data/" + std::to_string( ix ) );
+
+    const clock_t_::time_point start( clock_t_::now() );
+    for ( size_t ix = 0; ix < options.nMessage; ++ix ) {
+      mqtt.Publish( vTopic[ ix % vTopic.size() ], sPayload, 0, [&nFailed]( bool bOk, int ){ if ( !bOk ) ++nFailed; } );
+    }
+    seconds = std::chrono::duration<double>( clock_t_::now() - start ).count();
+    // after the data in each consumer's queue, so it arrives once the consumer has caught up
+    mqtt.Publish( sBase + "/control", "stop", 1, []( bool, int ){} );
+  }
+  else {
+    for ( pid_t pid: vPid ) ::kill( pid, SIGTERM );
+  }
+
+  std::vector<Consumed> vConsumed;
+  for ( FILE* pFile: vPipe ) {
+    Consumed consumed {};
+    if ( bReady && ReadLine( pFile, sLine ) ) {
+      std::istringstream ss( sLine );
+      ss >> consumed.nMessage >> consumed.nsFirst >> consumed.nsLast;
+    }
+    vConsumed.push_back( consumed );
+    std::fclose( pFile );
+  }
+  for ( pid_t pid: vPid ) ::waitpid( pid, nullptr, 0 );
+
+  if ( !bReady ) return false;
+
+  uint64_t nReceived {};
+  uint64_t nMin( ~uint64_t( 0 ) ), nMax {};
+  int64_t nsFirst( INT64_MAX ), nsLast( INT64_MIN );
+  double dblMemberSum {};
+  for ( const Consumed& consumed: vConsumed ) {
+    nReceived += consumed.nMessage;
+    nMin = std::min( nMin, consumed.nMessage );
+    nMax = std::max( nMax, consumed.nMessage );
+    if ( 0 < consumed.nMessage ) {
+      nsFirst = std::min( nsFirst, consumed.nsFirst );
+      nsLast = std::max( nsLast, consumed.nsLast );
+      const double dblSpan( 1e-9 * ( consumed.nsLast - consumed.nsFirst ) );
+      if ( 0.0 < dblSpan ) dblMemberSum += consumed.nMessage / dblSpan;
+    }
+  }
+  const double dblSpan( ( nsLast > nsFirst ) ? 1e-9 * ( nsLast - nsFirst ) : 0.0 );
+  const double dblRate( ( 0.0 < dblSpan ) ? nReceived / dblSpan : 0.0 );
+  if ( 1 == nConsumer ) dblBaseline = dblRate;
+
+  std::stringstream ss;
+  ss << std::fixed << std::setprecision( 3 )
+     << "{\"benchmark\":\"shared_subscription\",\"label\":\"" << options.sLabel << '"'
+     << ",\"transport\":\"paho\""
+     << ",\"messages\":" << options.nMessage
+     << ",\"payload_bytes\":" << options.nPayload
+     << ",\"work_us\":" << options.work.count()
+     << ",\"consumers\":" << nConsumer
+     << ",\"publish_seconds\":" << seconds
+     << ",\"publish_failed\":" << nFailed
+     << ",\"received\":" << nReceived
+     << ",\"seconds\":" << dblSpan
+     << ",\"msgs_per_sec\":" << dblRate
+     << ",\"per_member_msgs_per_sec\":" << dblMemberSum / nConsumer
+     << ",\"min_member_share\":" << ( 0 < nReceived ? double( nMin ) / nReceived : 0.0 )
+     << ",\"max_member_share\":" << ( 0 < nReceived ? double( nMax ) / nReceived : 0.0 )
+     << ",\"scaling\":" << ( 0.0 < dblBaseline ? dblRate / dblBaseline : 0.0 )
+     << '}';
+  std::cout << ss.str() << std::endl;
+  return true;
+}
+
+void Usage( const char* szName ) {
+  std::cerr
+    << "usage: " << szName
+    << " [--host 127.0.0.1] [--port 1883] [--count 200000] [--size 64] [--consumers 8] [--work-us 20] [--label text]"
+    << std::endl;
+}
+
+} // namespace anonymous
+
+int main( int argc, char* argv[] ) {
+
+  Options options;
+
+  for ( int ix = 1; ix < argc; ++ix ) {
+    const std::string sArg( argv[ ix ] );
+    if ( ( ix + 1 ) == argc ) {
+      Usage( argv[ 0 ] );
+      return EXIT_FAILURE;
+    }
+    const std::string sValue( argv[ ++ix ] );
+    if ( "--host" == sArg ) options.sHost = sValue;
+    else if ( "--port" == sArg ) options.sPort = sValue;
+    else if ( "--label" == sArg ) options.sLabel = sValue;
+    else if ( "--count" == sArg ) options.nMessage = std::stoul( sValue );
+    else if ( "--size" == sArg ) options.nPayload = std::stoul( sValue );
+    else if ( "--consumers" == sArg ) options.nConsumerMax = std::stoul( sValue );
+    else if ( "--work-us" == sArg ) options.work = std::chrono::microseconds( std::stoul( sValue ) );
+    else {
+      Usage( argv[ 0 ] );
+      return EXIT_FAILURE;
+    }
+  }
+
+  if ( 0 == options.nConsumerMax ) {
+    Usage( argv[ 0 ] );
+    return EXIT_FAILURE;
+  }
+
+  double dblBaseline {};
+  for ( size_t nConsumer = 1; nConsumer <= options.nConsumerMax; ++nConsumer ) {
+    if ( !Run( options, nConsumer, dblBaseline ) ) {
+      std::cerr << "shared subscription: consumers did not start" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,164 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+  File:    bench_topic.cpp
+  Project: Repertory/MQTT
+  Author:  raymond@burkholder.net
+  Created: October 19, 2026 18:42:10
+  parameterised topic construction: string concatenation against a compiled template
+  results are written to stdout as one json object per line, progress to stderr
+  no broker is used, --host and --port are accepted for run.sh and ignored
+*/
+
+#include <new>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+#include <iostream>
+
+#include "topic_template.hpp"
+
+// count every allocation made through operator new
+
+namespace {
+  std::atomic<uint64_t> g_nAllocation( 0 );
+}
+
+void* operator new( std::size_t n ) {
+  ++g_nAllocation;
+  void* p = std::malloc( n ? n : 1 );
+  if ( nullptr == p ) throw std::bad_alloc();
+  return p;
+}
+
+void* operator new[]( std::size_t n ) {
+  return operator new( n );
+}
+
+void operator delete( void* p ) noexcept { std::free( p ); }
+void operator delete[]( void* p ) noexcept { std::free( p ); }
+void operator delete( void* p, std::size_t ) noexcept { std::free( p ); }
+void operator delete[]( void* p, std::size_t ) noexcept { std::free( p ); }
+
+namespace {
+
+using clock_t_ = std::chrono::steady_clock;
+
+struct Options {
+  std::string sLabel;
+  size_t nTopic;
+  size_t nSite;
+  size_t nSensor;
+  Options()
+  : sLabel( "unlabelled" ), nTopic( 5000000 ), nSite( 16 ), nSensor( 64 )
+  {}
+};
+
+// the sink keeps the optimiser from discarding the work
+volatile size_t g_nSink( 0 );
+
+// the topic handed to Mqtt::Publish, which takes a string_view
+void Consume( const std::string_view& svTopic ) {
+  g_nSink = g_nSink + svTopic.size() + svTopic[ svTopic.size() - 1 ];
+}
+
+template<typename F>
+void Run( const char* szMethod, const Options& options, const std::vector<std::string>& vSite, F&& f ) {
+
+  std::cerr << szMethod << " ..." << std::endl;
+
+  const uint64_t nAllocationStart( g_nAllocation.load() );
+  const clock_t_::time_point start( clock_t_::now() );
+  for ( size_t ix = 0; ix < options.nTopic; ++ix ) {
+    f( vSite[ ix % vSite.size() ], ( ix / vSite.size() ) % options.nSensor );
+  }
+  const double seconds = std::chrono::duration<double>( clock_t_::now() - start ).count();
+  const uint64_t nAllocation( g_nAllocation.load() - nAllocationStart );
+
+  std::stringstream ss;
+  ss << std::fixed << std::setprecision( 3 )
+     << "{\"benchmark\":\"topic_format\",\"label\":\"" << options.sLabel << '"'
+     << ",\"method\":\"" << szMethod << '"'
+     << ",\"topics\":" << options.nTopic
+     << ",\"distinct\":" << vSite.size() * options.nSensor
+     << ",\"seconds\":" << seconds
+     << ",\"ns_per_topic\":" << 1e9 * seconds / options.nTopic
+     << ",\"allocs_per_topic\":" << double( nAllocation ) / options.nTopic
+     << '}';
+  std::cout << ss.str() << std::endl;
+}
+
+void Usage( const char* szName ) {
+  std::cerr
+    << "usage: " << szName
+    << " [--count 5000000] [--sites 16] [--sensors 64] [--label text]"
+    << std::endl;
+}
+
+} // namespace anonymous
+
+int main( int argc, char* argv[] ) {
+
+  Options options;
+
+  for ( int ix = 1; ix < argc; ++ix ) {
+    const std::string sArg( argv[ ix ] );
+    if ( ( ix + 1 ) == argc ) {
+      Usage( argv[ 0 ] );
+      return EXIT_FAILURE;
+    }
+    const std::string sValue( argv[ ++ix ] );
+    if ( "--host" == sArg ) {}
+    else if ( "--port" == sArg ) {}
+    else if ( "--label" == sArg ) options.sLabel = sValue;
+    else if ( "--count" == sArg ) options.nTopic = std::stoul( sValue );
+    else if ( "--sites" == sArg ) options.nSite = std::stoul( sValue );
+    else if ( "--sensors" == sArg ) options.nSensor = std::stoul( sValue );
+    else {
+      Usage( argv[ 0 ] );
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::vector<std::string> vSite;
+  for ( size_t ix = 0; ix < options.nSite; ++ix ) vSite.emplace_back( "site_" + std::to_string( 1000 + ix ) );
+
+  Run( "concatenate", options, vSite,
+    []( const std::string& sSite, size_t nSensor ){
+      const std::string sTopic( "site/" + sSite + "/sensor/" + std::to_string( nSensor ) + "/temp" );
+      Consume( sTopic );
+    } );
+
+  const ou::mqtt::topic::Template topic( "site/{s}/sensor/{u}/temp" );
+
+  Run( "template_render", options, vSite,
+    [&topic]( const std::string& sSite, size_t nSensor ){
+      ou::mqtt::topic::Buffer buffer;
+      if ( topic.Render( buffer, sSite, nSensor ) ) Consume( buffer );
+    } );
+
+  ou::mqtt::topic::Intern intern;
+  Run( "template_intern", options, vSite,
+    [&topic,&intern]( const std::string& sSite, size_t nSensor ){
+      const ou::mqtt::topic::Intern::id_t id( topic.Id( intern, sSite, nSensor ) );
+      if ( ou::mqtt::topic::Intern::npos != id ) Consume( intern.Topic( id ) );
+    } );
+
+  return EXIT_SUCCESS;
+}
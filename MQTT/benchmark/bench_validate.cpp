@@ -0,0 +1,269 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+  File:    bench_validate.cpp
+  Project: Repertory/MQTT
+  Author:  raymond@burkholder.net
+  Created: October 19, 2026 23:18:37
+  inbound checks: utf-8 validation, topic level splitting and filter matching, scalar against sse4.2 and avx2
+  results are written to stdout as one json object per line, progress to stderr
+  no broker is used, --host and --port are accepted for run.sh and ignored
+*/
+
+#include <chrono>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <random>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+#include <iostream>
+
+#include "simd.hpp"
+#include "utf8.hpp"
+#include "topic.hpp"
+
+namespace {
+
+using clock_t_ = std::chrono::steady_clock;
+using ou::mqtt::simd::EIsa;
+
+struct Options {
+  std::string sLabel;
+  size_t nRound; // passes over each data set
+  size_t nFilter;
+  Options()
+  : sLabel( "unlabelled" ), nRound( 200 ), nFilter( 100 )
+  {}
+};
+
+using vString_t = std::vector<std::string>;
+
+// the sink keeps the optimiser from discarding the work
+volatile size_t g_nSink( 0 );
+
+// topics in the shapes seen in practice: site telemetry, sparkplug, health, and a few deep ones
+vString_t Topics( std::mt19937& rng ) {
+  static const char* rMeasure[] = { "temp", "pressure", "flow", "level", "vibration", "current" };
+  vString_t vTopic;
+  for ( size_t ix = 0; ix < 10000; ++ix ) {
+    const unsigned int n( rng() );
+    switch ( n % 8 ) {
+      case 0:
+        vTopic.emplace_back( "spBv1.0/plant_" + std::to_string( n % 4 ) + "/DDATA/edge_" + std::to_string( n % 32 ) + "/plc_" + std::to_string( n % 7 ) );
+        break;
+      case 1:
+        vTopic.emplace_back( "$health/collector_" + std::to_string( n % 16 ) );
+        break;
+      case 2:
+        vTopic.emplace_back( "site/site_" + std::to_string( 1000 + n % 16 ) + "/building/b" + std::to_string( n % 5 ) + "/floor/" + std::to_string( n % 12 )
+          + "/room/r" + std::to_string( n % 40 ) + "/sensor/" + std::to_string( n % 64 ) + '/' + rMeasure[ n % 6 ] );
+        break;
+      default:
+        vTopic.emplace_back( "site/site_" + std::to_string( 1000 + n % 16 ) + "/sensor/" + std::to_string( n % 64 ) + '/' + rMeasure[ n % 6 ] );
+        break;
+    }
+  }
+  return vTopic;
+}
+
+vString_t Filters( std::mt19937& rng, size_t nFilter ) {
+  static const char* rMeasure[] = { "temp", "pressure", "flow", "level", "vibration", "current" };
+  vString_t vFilter{ "#", "$health/+", "spBv1.0/+/DDATA/#", "site/+/sensor/+/temp", "site/+/building/+/floor/+/room/+/sensor/+/+" };
+  while ( vFilter.size() < nFilter ) {
+    const unsigned int n( rng() );
+    switch ( n % 4 ) {
+      case 0:
+        vFilter.emplace_back( "site/site_" + std::to_string( 1000 + n % 16 ) + "/#" );
+        break;
+      case 1:
+        vFilter.emplace_back( "site/+/sensor/" + std::to_string( n % 64 ) + '/' + rMeasure[ n % 6 ] );
+        break;
+      case 2:
+        vFilter.emplace_back( "spBv1.0/plant_" + std::to_string( n % 4 ) + "/DDATA/edge_" + std::to_string( n % 32 ) + "/+" );
+        break;
+      default:
+        vFilter.emplace_back( "site/site_" + std::to_string( 1000 + n % 16 ) + "/sensor/+/" + rMeasure[ n % 6 ] );
+        break;
+    }
+  }
+  return vFilter;
+}
+
+// sensor readings as json, ascii throughout
+vString_t PayloadJson( std::mt19937& rng ) {
+  vString_t vPayload;
+  for ( size_t ix = 0; ix < 2000; ++ix ) {
+    std::string s( "{\"ts\":" + std::to_string( 1790000000000 + rng() % 1000000 ) + ",\"values\":[" );
+    for ( size_t ixValue = 0; ixValue < 24; ++ixValue ) {
+      if ( 0 != ixValue ) s += ',';
+      s += std::to_string( rng() % 100000 ) + '.' + std::to_string( rng() % 100 );
+    }
+    s += "],\"unit\":\"kPa\",\"quality\":\"good\"}";
+    vPayload.emplace_back( std::move( s ) );
+  }
+  return vPayload;
+}
+
+// operator notes and alarm text, mostly ascii with accented, cjk and emoji characters
+vString_t PayloadText( std::mt19937& rng ) {
+  static const char* rWord[] = { "pump", "valve", "Temperatur", "überhöht", "température", "élevée", "压力", "报警", "\xe2\x9a\xa0", "\xf0\x9f\x94\xa5", "ok", "line", "2" };
+  vString_t vPayload;
+  for ( size_t ix = 0; ix < 2000; ++ix ) {
+    std::string s;
+    while ( 300 > s.size() ) {
+      s += rWord[ rng() % ( sizeof( rWord ) / sizeof( rWord[ 0 ] ) ) ];
+      s += ' ';
+    }
+    vPayload.emplace_back( std::move( s ) );
+  }
+  return vPayload;
+}
+
+std::vector<EIsa> Available() {
+  std::vector<EIsa> vIsa{ EIsa::scalar };
+  const EIsa eDetect( ou::mqtt::simd::Detect() );
+  if ( EIsa::scalar != eDetect ) vIsa.push_back( EIsa::sse42 );
+  if ( EIsa::avx2 == eDetect ) vIsa.push_back( EIsa::avx2 );
+  return vIsa;
+}
+
+size_t Bytes( const vString_t& v ) {
+  size_t n {};
+  for ( const std::string& s: v ) n += s.size();
+  return n;
+}
+
+void Emit( const char* szBenchmark, const Options& options, const char* szData, const char* szMethod, size_t nItem, size_t nByte, double seconds ) {
+  std::stringstream ss;
+  ss << std::fixed << std::setprecision( 3 )
+     << "{\"benchmark\":\"" << szBenchmark << "\",\"label\":\"" << options.sLabel << '"'
+     << ",\"data\":\"" << szData << '"'
+     << ",\"method\":\"" << szMethod << '"'
+     << ",\"items\":" << nItem
+     << ",\"seconds\":" << seconds
+     << ",\"ns_per_item\":" << 1e9 * seconds / nItem
+     << ",\"mb_per_sec\":" << nByte / seconds / 1e6
+     << '}';
+  std::cout << ss.str() << std::endl;
+}
+
+template<typename F>
+void Run( const char* szBenchmark, const Options& options, const char* szData, const char* szMethod, const vString_t& v, F&& f ) {
+
+  std::cerr << szBenchmark << ' ' << szData << ' ' << szMethod << " ..." << std::endl;
+
+  size_t nSink {};
+  const clock_t_::time_point start( clock_t_::now() );
+  for ( size_t ixRound = 0; ixRound < options.nRound; ++ixRound ) {
+    for ( const std::string& s: v ) nSink += f( s );
+  }
+  const double seconds = std::chrono::duration<double>( clock_t_::now() - start ).count();
+  g_nSink = g_nSink + nSink;
+
+  Emit( szBenchmark, options, szData, szMethod, v.size() * options.nRound, Bytes( v ) * options.nRound, seconds );
+}
+
+void Usage( const char* szName ) {
+  std::cerr
+    << "usage: " << szName
+    << " [--rounds 200] [--filters 100] [--label text]"
+    << std::endl;
+}
+
+} // namespace anonymous
+
+int main( int argc, char* argv[] ) {
+
+  Options options;
+
+  for ( int ix = 1; ix < argc; ++ix ) {
+    const std::string sArg( argv[ ix ] );
+    if ( ( ix + 1 ) == argc ) {
+      Usage( argv[ 0 ] );
+      return EXIT_FAILURE;
+    }
+    const std::string sValue( argv[ ++ix ] );
+    if ( "--host" == sArg ) {}
+    else if ( "--port" == sArg ) {}
+    else if ( "--label" == sArg ) options.sLabel = sValue;
+    else if ( "--rounds" == sArg ) options.nRound = std::stoul( sValue );
+    else if ( "--filters" == sArg ) options.nFilter = std::stoul( sValue );
+    else {
+      Usage( argv[ 0 ] );
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::mt19937 rng( 48 ); // the same data every run
+  const vString_t vTopic( Topics( rng ) );
+  const vString_t vFilter( Filters( rng, options.nFilter ) );
+  const vString_t vPayloadJson( PayloadJson( rng ) );
+  const vString_t vPayloadText( PayloadText( rng ) );
+
+  const std::vector<EIsa> vIsa( Available() );
+
+  struct Data {
+    const char* szName;
+    const vString_t& v;
+  };
+  for ( const Data& data: { Data{ "topic", vTopic }, Data{ "payload_json", vPayloadJson }, Data{ "payload_text", vPayloadText } } ) {
+    for ( EIsa eIsa: vIsa ) {
+      Run( "utf8_validate", options, data.szName, ou::mqtt::simd::Name( eIsa ), data.v,
+        [eIsa]( const std::string& s )->size_t{ return ou::mqtt::utf8::Valid( s.data(), s.size(), eIsa ) ? 1 : 0; } );
+    }
+  }
+
+  for ( EIsa eIsa: vIsa ) {
+    Run( "topic_split", options, "topic", ou::mqtt::simd::Name( eIsa ), vTopic,
+      [eIsa]( const std::string& s )->size_t{
+        ou::mqtt::topic::Levels levels;
+        return ou::mqtt::topic::Split( s, levels, eIsa ) ? levels.nLevel : 0;
+      } );
+  }
+
+  // one message against every filter, as Mqtt::Deliver does
+  Options optionsMatch( options );
+  optionsMatch.nRound = std::max<size_t>( 1, options.nRound / 20 );
+
+  Run( "topic_match", optionsMatch, "topic", "string", vTopic,
+    [&vFilter]( const std::string& sTopic )->size_t{
+      size_t nMatch {};
+      for ( const std::string& sFilter: vFilter ) {
+        if ( ou::mqtt::topic::Match( sFilter, sTopic ) ) ++nMatch;
+      }
+      return nMatch;
+    } );
+
+  std::vector<ou::mqtt::topic::Levels> vLevels( vFilter.size() );
+  for ( size_t ix = 0; ix < vFilter.size(); ++ix ) ou::mqtt::topic::Split( vFilter[ ix ], vLevels[ ix ] );
+
+  for ( EIsa eIsa: vIsa ) {
+    const std::string sMethod( std::string( "levels_" ) + ou::mqtt::simd::Name( eIsa ) );
+    Run( "topic_match", optionsMatch, "topic", sMethod.c_str(), vTopic,
+      [&vFilter,&vLevels,eIsa]( const std::string& sTopic )->size_t{
+        ou::mqtt::topic::Levels levels;
+        if ( !ou::mqtt::topic::Split( sTopic, levels, eIsa ) ) return 0;
+        size_t nMatch {};
+        for ( size_t ix = 0; ix < vFilter.size(); ++ix ) {
+          if ( ou::mqtt::topic::Match( vFilter[ ix ], vLevels[ ix ], sTopic, levels ) ) ++nMatch;
+        }
+        return nMatch;
+      } );
+  }
+
+  return EXIT_SUCCESS;
+}
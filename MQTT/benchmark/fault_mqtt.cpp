@@ -0,0 +1,530 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+  File:    fault_mqtt.cpp
+  Project: Repertory/MQTT
+  Author:  raymond@burkholder.net
+  Created: October 19, 2026 12:20:03
+  reconnect and recovery under load:
+    publisher --> tcp proxy (drop, stall, reset on a schedule) --> broker --> subscriber
+  results are written to stdout as one json object per line, progress to stderr
+*/
+
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <iostream>
+#include <stdexcept>
+#include <charconv>
+
+#include <poll.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "mqtt.hpp"
+
+namespace {
+
+using clock_t_ = std::chrono::steady_clock;
+
+double Milliseconds( clock_t_::duration duration ) {
+  return std::chrono::duration<double, std::milli>( duration ).count();
+}
+
+// ==== tcp proxy
+
+class Proxy {
+public:
+
+  Proxy( const std::string& sHostUpstream, const std::string& sPortUpstream, uint16_t portListen )
+  : m_sHostUpstream( sHostUpstream ), m_sPortUpstream( sPortUpstream )
+  , m_bRunning( true )
+  , m_stall( clock_t_::time_point::min() )
+  {
+    m_fdListen = ::socket( AF_INET, SOCK_STREAM, 0 );
+    if ( 0 > m_fdListen ) throw std::runtime_error( "proxy socket" );
+    int one( 1 );
+    ::setsockopt( m_fdListen, SOL_SOCKET, SO_REUSEADDR, &one, sizeof( one ) );
+    sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons( portListen );
+    addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+    if ( 0 != ::bind( m_fdListen, (sockaddr*)&addr, sizeof( addr ) ) ) throw std::runtime_error( "proxy bind" );
+    if ( 0 != ::listen( m_fdListen, 16 ) ) throw std::runtime_error( "proxy listen" );
+    m_threadAccept = std::thread( [this](){ Accept(); } );
+  }
+
+  ~Proxy() {
+    m_bRunning = false;
+    if ( m_threadAccept.joinable() ) m_threadAccept.join();
+    Fault( EFault::drop );
+    std::lock_guard<std::mutex> lock( m_mutex );
+    for ( pConnection_t& pConnection: m_vConnection ) {
+      if ( pConnection->thread.joinable() ) pConnection->thread.join();
+    }
+    ::close( m_fdListen );
+  }
+
+  enum class EFault { none, drop, reset };
+
+  // close every open connection, drop with FIN, reset with RST
+  void Fault( EFault fault ) {
+    std::lock_guard<std::mutex> lock( m_mutex );
+    for ( pConnection_t& pConnection: m_vConnection ) {
+      pConnection->fault = fault;
+    }
+  }
+
+  // stop forwarding in both directions, sockets stay open
+  void Stall( std::chrono::milliseconds duration ) {
+    m_stall = clock_t_::now() + duration;
+  }
+
+private:
+
+  struct Connection {
+    int fdClient;
+    int fdServer;
+    std::atomic<EFault> fault;
+    std::atomic<bool> bDone;
+    std::thread thread;
+    Connection( int fdClient_, int fdServer_ )
+    : fdClient( fdClient_ ), fdServer( fdServer_ ), fault( EFault::none ), bDone( false ) {}
+  };
+
+  using pConnection_t = std::unique_ptr<Connection>;
+  using vConnection_t = std::vector<pConnection_t>;
+
+  const std::string m_sHostUpstream;
+  const std::string m_sPortUpstream;
+
+  int m_fdListen;
+  std::atomic<bool> m_bRunning;
+  std::atomic<clock_t_::time_point> m_stall;
+
+  std::thread m_threadAccept;
+
+  std::mutex m_mutex;
+  vConnection_t m_vConnection;
+
+  int ConnectUpstream() {
+    addrinfo hints {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* pResult( nullptr );
+    if ( 0 != ::getaddrinfo( m_sHostUpstream.c_str(), m_sPortUpstream.c_str(), &hints, &pResult ) ) return -1;
+    int fd( -1 );
+    for ( addrinfo* p = pResult; nullptr != p; p = p->ai_next ) {
+      fd = ::socket( p->ai_family, p->ai_socktype, p->ai_protocol );
+      if ( 0 > fd ) continue;
+      if ( 0 == ::connect( fd, p->ai_addr, p->ai_addrlen ) ) break;
+      ::close( fd );
+      fd = -1;
+    }
+    ::freeaddrinfo( pResult );
+    return fd;
+  }
+
+  void Accept() {
+    while ( m_bRunning ) {
+      pollfd pfd { m_fdListen, POLLIN, 0 };
+      if ( 0 >= ::poll( &pfd, 1, 50 ) ) continue;
+      int fdClient = ::accept( m_fdListen, nullptr, nullptr );
+      if ( 0 > fdClient ) continue;
+      int fdServer = ConnectUpstream();
+      if ( 0 > fdServer ) {
+        std::cerr << "proxy: upstream connect failed" << std::endl;
+        ::close( fdClient );
+        continue;
+      }
+      std::lock_guard<std::mutex> lock( m_mutex );
+      // reap finished connections
+      for ( vConnection_t::iterator iter = m_vConnection.begin(); m_vConnection.end() != iter; ) {
+        if ( (*iter)->bDone ) {
+          (*iter)->thread.join();
+          iter = m_vConnection.erase( iter );
+        }
+        else ++iter;
+      }
+      m_vConnection.emplace_back( std::make_unique<Connection>( fdClient, fdServer ) );
+      Connection* pConnection = m_vConnection.back().get();
+      pConnection->thread = std::thread( [this,pConnection](){ Pump( *pConnection ); } );
+    }
+  }
+
+  void Pump( Connection& connection ) {
+    char buf[ 16 * 1024 ];
+    pollfd pfd[ 2 ] { { connection.fdClient, POLLIN, 0 }, { connection.fdServer, POLLIN, 0 } };
+    bool bOpen( true );
+    while ( bOpen ) {
+      const EFault fault = connection.fault.load();
+      if ( EFault::none != fault ) {
+        if ( EFault::reset == fault ) {
+          linger lin { 1, 0 }; // close sends RST
+          ::setsockopt( connection.fdClient, SOL_SOCKET, SO_LINGER, &lin, sizeof( lin ) );
+          ::setsockopt( connection.fdServer, SOL_SOCKET, SO_LINGER, &lin, sizeof( lin ) );
+        }
+        break;
+      }
+      if ( clock_t_::now() < m_stall.load() ) {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 5 ) );
+        continue;
+      }
+      if ( 0 >= ::poll( pfd, 2, 20 ) ) continue;
+      for ( int ix = 0; ix < 2; ++ix ) {
+        if ( 0 == ( pfd[ ix ].revents & ( POLLIN | POLLHUP | POLLERR ) ) ) continue;
+        const ssize_t n = ::recv( pfd[ ix ].fd, buf, sizeof( buf ), 0 );
+        if ( 0 >= n ) {
+          bOpen = false;
+          break;
+        }
+        const int fdTo = ( 0 == ix ) ? connection.fdServer : connection.fdClient;
+        ssize_t nSent {};
+        while ( nSent < n ) {
+          const ssize_t m = ::send( fdTo, buf + nSent, n - nSent, MSG_NOSIGNAL );
+          if ( 0 >= m ) {
+            bOpen = false;
+            break;
+          }
+          nSent += m;
+        }
+      }
+    }
+    ::close( connection.fdClient );
+    ::close( connection.fdServer );
+    connection.bDone = true;
+  }
+
+};
+
+// ==== harness
+
+struct Options {
+  std::string sHost;
+  std::string sPort;
+  std::string sLabel;
+  uint16_t portProxy;
+  size_t nPayload;
+  size_t nWindow;
+  std::chrono::milliseconds interval; // between faults
+  std::chrono::milliseconds stall;
+  std::chrono::milliseconds duration;
+  std::vector<std::string> vSchedule;
+  Options()
+  : sHost( "127.0.0.1" ), sPort( "1883" ), sLabel( "unlabelled" ), portProxy( 18831 )
+  , nPayload( 64 ), nWindow( 64 )
+  , interval( 5000 ), stall( 3000 ), duration( 32000 )
+  , vSchedule{ "drop", "stall", "reset" }
+  {}
+};
+
+// state shared with completion callbacks, which can outlive the publish loop
+struct State {
+
+  std::atomic<uint64_t> nPublished;   // accepted by the library, each with its own sequence number
+  std::atomic<uint64_t> nAcked;
+  std::atomic<uint64_t> nRejected;     // failed inside Publish, while disconnected, sequence number is reused
+  std::atomic<uint64_t> nFailedInFlight; // accepted, then failed when the connection dropped
+  std::atomic<uint64_t> nOutstanding;  // spool depth: accepted by the library, not yet completed
+
+  std::atomic<uint64_t> seqFault;      // first sequence number published after the most recent fault
+  std::atomic<bool> bRecovered;
+  std::atomic<clock_t_::time_point> tpFault;
+  std::atomic<clock_t_::time_point> tpRecovered;
+
+  enum EOutcome: uint8_t { pending = 0, acked, failed };
+
+  std::mutex mutex;
+  std::vector<uint8_t> vOutcome;  // by sequence number
+  std::vector<uint8_t> vReceived; // by sequence number, count of arrivals
+
+  State()
+  : nPublished {}, nAcked {}, nRejected {}, nFailedInFlight {}, nOutstanding {}
+  , seqFault {}, bRecovered( true )
+  {}
+};
+
+thread_local bool t_bInPublish( false );
+thread_local bool t_bRejected( false );
+
+std::string Payload( uint64_t seq, size_t nPayload ) {
+  std::string s( std::max<size_t>( nPayload, 20 ), ' ' );
+  std::to_chars( s.data(), s.data() + s.size(), seq );
+  return s;
+}
+
+class Result {
+public:
+  Result( const std::string& sBenchmark, const Options& options ) {
+    m_ss << std::fixed << std::setprecision( 3 );
+    m_ss << "{\"benchmark\":\"" << sBenchmark << "\",\"label\":\"" << options.sLabel << '"';
+  }
+  template<typename value_t>
+  Result& Add( const char* szKey, value_t value ) {
+    m_ss << ",\"" << szKey << "\":" << value;
+    return *this;
+  }
+  Result& AddString( const char* szKey, const std::string& value ) {
+    m_ss << ",\"" << szKey << "\":\"" << value << '"';
+    return *this;
+  }
+  void Emit() {
+    m_ss << '}';
+    std::cout << m_ss.str() << std::endl;
+  }
+private:
+  std::stringstream m_ss;
+};
+
+void Usage( const char* szName ) {
+  std::cerr
+    << "usage: " << szName
+    << " [--host 127.0.0.1] [--port 1883] [--proxy-port 18831] [--size 64] [--window 64]"
+    << " [--interval-ms 5000] [--stall-ms 3000] [--duration-ms 32000] [--schedule drop,stall,reset] [--label text]"
+    << std::endl;
+}
+
+} // namespace anonymous
+
+int main( int argc, char* argv[] ) {
+
+  Options options;
+
+  for ( int ix = 1; ix < argc; ++ix ) {
+    const std::string sArg( argv[ ix ] );
+    if ( ( ix + 1 ) == argc ) {
+      Usage( argv[ 0 ] );
+      return EXIT_FAILURE;
+    }
+    const std::string sValue( argv[ ++ix ] );
+    if ( "--host" == sArg ) options.sHost = sValue;
+    else if ( "--port" == sArg ) options.sPort = sValue;
+    else if ( "--label" == sArg ) options.sLabel = sValue;
+    else if ( "--proxy-port" == sArg ) options.portProxy = std::stoul( sValue );
+    else if ( "--size" == sArg ) options.nPayload = std::stoul( sValue );
+    else if ( "--window" == sArg ) options.nWindow = std::stoul( sValue );
+    else if ( "--interval-ms" == sArg ) options.interval = std::chrono::milliseconds( std::stoul( sValue ) );
+    else if ( "--stall-ms" == sArg ) options.stall = std::chrono::milliseconds( std::stoul( sValue ) );
+    else if ( "--duration-ms" == sArg ) options.duration = std::chrono::milliseconds( std::stoul( sValue ) );
+    else if ( "--schedule" == sArg ) {
+      options.vSchedule.clear();
+      std::stringstream ss( sValue );
+      std::string sFault;
+      while ( std::getline( ss, sFault, ',' ) ) options.vSchedule.push_back( sFault );
+    }
+    else {
+      Usage( argv[ 0 ] );
+      return EXIT_FAILURE;
+    }
+  }
+
+  try {
+
+    Proxy proxy( options.sHost, options.sPort, options.portProxy );
+    auto pState = std::make_shared<State>();
+
+    const std::string sTopic( "fault/" + std::to_string( ::getpid() ) );
+
+    ou::mqtt::Config config;
+    config.sHost = options.sHost;
+    config.sPort = options.sPort;
+
+    // the subscriber connects straight to the broker, it is the reference for what got through
+    config.sId = "fault_sub_" + std::to_string( ::getpid() );
+    ou::Mqtt subscriber( config );
+    subscriber.Subscribe(
+      sTopic,
+      [pState]( const std::string_view& /* svTopic */, const std::string_view& svMessage ){
+        uint64_t seq {};
+        std::from_chars( svMessage.data(), svMessage.data() + svMessage.size(), seq );
+        std::lock_guard<std::mutex> lock( pState->mutex );
+        if ( pState->vReceived.size() <= seq ) pState->vReceived.resize( 2 * seq + 1024 );
+        if ( 255 > pState->vReceived[ seq ] ) ++pState->vReceived[ seq ];
+      } );
+
+    config.sId = "fault_pub_" + std::to_string( ::getpid() );
+    config.sPort = std::to_string( options.portProxy );
+    ou::Mqtt publisher( config );
+
+    std::atomic<bool> bPublishing( true );
+    std::thread threadPublish(
+      [&options,&publisher,&bPublishing,&sTopic,pState](){
+        uint64_t seq {};
+        while ( bPublishing ) {
+          if ( options.nWindow <= pState->nOutstanding.load() ) {
+            std::this_thread::yield();
+            continue;
+          }
+          const std::string sPayload( Payload( seq, options.nPayload ) );
+          {
+            std::lock_guard<std::mutex> lock( pState->mutex );
+            if ( pState->vOutcome.size() <= seq ) pState->vOutcome.resize( 2 * seq + 1024, State::pending );
+          }
+          ++pState->nOutstanding;
+          t_bInPublish = true;
+          t_bRejected = false;
+          publisher.Publish(
+            sTopic, sPayload, 1,
+            [pState,seq]( bool bStatus, int /* rc */ ){
+              --pState->nOutstanding;
+              if ( !bStatus && t_bInPublish ) {
+                t_bRejected = true;
+                ++pState->nRejected;
+                return;
+              }
+              {
+                std::lock_guard<std::mutex> lock( pState->mutex );
+                pState->vOutcome[ seq ] = bStatus ? State::acked : State::failed;
+              }
+              if ( bStatus ) {
+                ++pState->nAcked;
+                if ( !pState->bRecovered.load() && ( seq >= pState->seqFault.load() ) ) {
+                  pState->tpRecovered = clock_t_::now();
+                  pState->bRecovered = true;
+                }
+              }
+              else {
+                ++pState->nFailedInFlight;
+              }
+            } );
+          t_bInPublish = false;
+          if ( t_bRejected ) {
+            std::this_thread::sleep_for( std::chrono::microseconds( 100 ) ); // keep retrying, without a pure spin
+          }
+          else {
+            ++pState->nPublished;
+            ++seq;
+          }
+        }
+      } );
+
+    std::cerr << "fault harness running for " << options.duration.count() << "ms" << std::endl;
+
+    const clock_t_::time_point end( clock_t_::now() + options.duration );
+    size_t ixSchedule {};
+    uint64_t nMaxSpool {};
+
+    while ( ( clock_t_::now() + options.interval ) < end ) {
+
+      // sample spool depth while waiting for the next fault
+      const clock_t_::time_point next( clock_t_::now() + options.interval );
+      while ( clock_t_::now() < next ) {
+        nMaxSpool = std::max<uint64_t>( nMaxSpool, pState->nOutstanding.load() );
+        std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+      }
+
+      if ( !pState->bRecovered.load() ) {
+        Result( "fault_recovery", options )
+          .AddString( "fault", options.vSchedule[ ( ixSchedule + options.vSchedule.size() - 1 ) % options.vSchedule.size() ] )
+          .AddString( "recovered", "false" )
+          .Emit();
+      }
+
+      const std::string& sFault( options.vSchedule[ ixSchedule++ % options.vSchedule.size() ] );
+      const uint64_t nSpoolAtFault( pState->nOutstanding.load() );
+
+      pState->bRecovered = false;
+      pState->seqFault = pState->nPublished.load() + options.nWindow; // past anything already in flight
+      pState->tpFault = clock_t_::now();
+
+      std::cerr << "fault: " << sFault << std::endl;
+      if ( "drop" == sFault ) proxy.Fault( Proxy::EFault::drop );
+      else if ( "reset" == sFault ) proxy.Fault( Proxy::EFault::reset );
+      else if ( "stall" == sFault ) proxy.Stall( options.stall );
+      else std::cerr << "unknown fault " << sFault << std::endl;
+
+      // wait for recovery, bounded by the next interval
+      const clock_t_::time_point limit( clock_t_::now() + options.interval );
+      while ( !pState->bRecovered.load() && ( clock_t_::now() < limit ) ) {
+        nMaxSpool = std::max<uint64_t>( nMaxSpool, pState->nOutstanding.load() );
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+      }
+      if ( pState->bRecovered.load() ) {
+        Result( "fault_recovery", options )
+          .AddString( "fault", sFault )
+          .AddString( "recovered", "true" )
+          .Add( "recovery_ms", Milliseconds( pState->tpRecovered.load() - pState->tpFault.load() ) )
+          .Add( "spool_at_fault", nSpoolAtFault )
+          .Emit();
+      }
+    }
+
+    bPublishing = false;
+    threadPublish.join();
+
+    // let acks and deliveries settle
+    const clock_t_::time_point settle( clock_t_::now() + std::chrono::seconds( 10 ) );
+    while ( ( 0 < pState->nOutstanding.load() ) && ( clock_t_::now() < settle ) ) {
+      std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+    }
+    std::this_thread::sleep_for( std::chrono::seconds( 1 ) );
+
+    uint64_t nReceived {};
+    uint64_t nDuplicate {};
+    uint64_t nLost {};          // acked, never arrived
+    uint64_t nFailedArrived {}; // reported failed, arrived anyway (ack lost with the connection)
+    {
+      std::lock_guard<std::mutex> lock( pState->mutex );
+      const uint64_t nPublished( pState->nPublished.load() );
+      for ( uint64_t seq = 0; seq < nPublished; ++seq ) {
+        const uint8_t n = ( seq < pState->vReceived.size() ) ? pState->vReceived[ seq ] : 0;
+        const uint8_t outcome = ( seq < pState->vOutcome.size() ) ? pState->vOutcome[ seq ] : uint8_t( State::pending );
+        if ( 0 == n ) {
+          if ( State::acked == outcome ) ++nLost;
+        }
+        else {
+          ++nReceived;
+          nDuplicate += n - 1;
+          if ( State::failed == outcome ) ++nFailedArrived;
+        }
+      }
+    }
+
+    Result( "fault_summary", options )
+      .Add( "published", pState->nPublished.load() )
+      .Add( "acked", pState->nAcked.load() )
+      .Add( "rejected_disconnected", pState->nRejected.load() )
+      .Add( "failed_in_flight", pState->nFailedInFlight.load() )
+      .Add( "unacked_at_end", pState->nOutstanding.load() )
+      .Add( "received", nReceived )
+      .Add( "duplicates", nDuplicate )
+      .Add( "lost_after_ack", nLost )
+      .Add( "failed_but_delivered", nFailedArrived )
+      .Add( "max_spool_depth", nMaxSpool )
+      .Emit();
+
+    subscriber.UnSubscribe( sTopic );
+  }
+  catch ( const ou::Mqtt::runtime_error& e ) {
+    std::cerr << "mqtt error: " << e.what() << ',' << e.rc << std::endl;
+    return EXIT_FAILURE;
+  }
+  catch ( const std::runtime_error& e ) {
+    std::cerr << "error: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
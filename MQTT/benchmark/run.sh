@@ -0,0 +1,42 @@
+#!/bin/sh
+
+# File:    run.sh
+# Project: Repertory/MQTT
+# Author:  raymond@burkholder.net
+# Created: October 19, 2026 09:12:40
+
+# starts a private mosquitto bound to the loopback interface, runs a benchmark
+# against it, and appends the json lines results to the output file
+#   usage: run.sh <path to mqtt_bench or mqtt_fault> <output.jsonl> [extra options]
+
+set -e
+
+BENCH="$1"
+OUTPUT="$2"
+shift 2
+
+PORT="${OU_BENCH_PORT:-18830}"
+MOSQUITTO="${OU_BENCH_MOSQUITTO:-mosquitto}"
+LABEL="$(git rev-parse --short HEAD 2>/dev/null || echo unknown)"
+
+DIR="$(mktemp -d)"
+trap 'kill "$BROKER" 2>/dev/null || true; rm -rf "$DIR"' EXIT
+
+cat > "$DIR/mosquitto.conf" <<CONF
+listener $PORT 127.0.0.1
+allow_anonymous true
+persistence false
+max_inflight_messages 0
+max_queued_messages 0
+CONF
+
+"$MOSQUITTO" -c "$DIR/mosquitto.conf" > "$DIR/mosquitto.log" 2>&1 &
+BROKER=$!
+sleep 1
+
+# through a file rather than a pipe to tee, so a failing benchmark fails the run
+STATUS=0
+"$BENCH" --host 127.0.0.1 --port "$PORT" --label "$LABEL" "$@" > "$DIR/result.jsonl" || STATUS=$?
+cat "$DIR/result.jsonl"
+cat "$DIR/result.jsonl" >> "$OUTPUT"
+exit $STATUS
@@ -0,0 +1,789 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+  File:    blob.cpp
+  Project: Repertory/MQTT
+  Author:  raymond@burkholder.net
+  Created: October 19, 2026 22:05:36
+*/
+
+#include <array>
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <thread.hpp>
+
+#include "blob.hpp"
+
+namespace {
+
+  const char c_szMagic[ 4 ] = { 'O', 'U', 'B', 'M' };
+  const uint32_t c_nVersion( 1 );
+  const size_t c_nRange( 256 ); // most ranges in one resend request
+
+  struct Meta {
+    char szMagic[ 4 ];
+    uint32_t nVersion;
+    uint64_t nSize;
+    uint32_t nChunkSize;
+    uint32_t nChunk;
+  };
+
+  struct ChunkHeader {
+    uint32_t ixChunk;
+    uint32_t crc; // of the data following
+  };
+
+  struct End {
+    uint64_t nSize;
+    uint32_t nChunk;
+    uint32_t crc; // of the whole blob
+  };
+
+  struct Range {
+    uint32_t ixFirst;
+    uint32_t nCount;
+  };
+
+  template<typename T>
+  inline bool Get( const std::string_view& sv, T& t ) {
+    if ( sizeof( T ) > sv.size() ) return false;
+    std::memcpy( &t, sv.data(), sizeof( T ) );
+    return true;
+  }
+
+  template<typename T>
+  inline void Put( std::string& s, const T& t ) {
+    s.append( reinterpret_cast<const char*>( &t ), sizeof( T ) );
+  }
+
+  bool Level( const std::string& sId ) { // usable as a single topic level
+    return !sId.empty() && ( std::string::npos == sId.find_first_of( "/+#" ) );
+  }
+
+  std::string Topic( const std::string& sBase, const std::string_view& svId, const char* szType ) {
+    std::string sTopic( sBase );
+    sTopic += '/';
+    sTopic += svId;
+    sTopic += '/';
+    sTopic += szType;
+    return sTopic;
+  }
+
+  // the id in <base>/<id>/<type>
+  std::string_view Id( const std::string& sBase, const std::string_view& svTopic ) {
+    if ( ( sBase.size() + 1 ) >= svTopic.size() ) return std::string_view();
+    const std::string_view svRest( svTopic.substr( sBase.size() + 1 ) );
+    const std::string_view::size_type ixSlash( svRest.find( '/' ) );
+    if ( std::string_view::npos == ixSlash ) return std::string_view();
+    return svRest.substr( 0, ixSlash );
+  }
+
+  // a read only mapping, released with the last fRead_t referring to it
+  struct Mapping {
+    const char* p;
+    size_t n;
+    Mapping( const char* p_, size_t n_ ): p( p_ ), n( n_ ) {}
+    ~Mapping() { if ( nullptr != p ) ::munmap( const_cast<char*>( p ), n ); }
+  };
+
+} // namespace anonymous
+
+namespace ou {
+namespace mqtt {
+namespace blob {
+
+uint32_t Crc32( const char* p, size_t n, uint32_t crc ) {
+  static const std::array<uint32_t, 256> rTable = [](){
+    std::array<uint32_t, 256> rTable;
+    for ( uint32_t ix = 0; ix < 256; ++ix ) {
+      uint32_t value( ix );
+      for ( int bit = 0; bit < 8; ++bit ) value = ( value & 1 ) ? ( 0xedb88320 ^ ( value >> 1 ) ) : ( value >> 1 );
+      rTable[ ix ] = value;
+    }
+    return rTable;
+  }();
+  crc = ~crc;
+  for ( size_t ix = 0; ix < n; ++ix ) {
+    crc = rTable[ ( crc ^ static_cast<uint8_t>( p[ ix ] ) ) & 0xff ] ^ ( crc >> 8 );
+  }
+  return ~crc;
+}
+
+// ==== Sender
+
+Sender::Transfer::Transfer( const std::string& sBase, const std::string& sId_, uint64_t nSize_, size_t nChunkSize, fRead_t&& fRead_, fDone_t&& fDone_ )
+: sId( sId_ )
+, sTopicMeta( Topic( sBase, sId_, "meta" ) )
+, sTopicChunk( Topic( sBase, sId_, "chunk" ) )
+, sTopicEnd( Topic( sBase, sId_, "end" ) )
+, nSize( nSize_ )
+, nChunk( static_cast<uint32_t>( ( nSize_ + nChunkSize - 1 ) / nChunkSize ) )
+, fRead( std::move( fRead_ ) ), fDone( std::move( fDone_ ) )
+, bMeta( true ), bEnd( true )
+, ixNext {}, crc {}
+, vQueued( nChunk, false ), vAcked( nChunk, false ), nAcked {}
+, bMetaAcked( false ), bEndAcked( false )
+, nInFlight {}, bDone( false )
+{}
+
+Sender::State::State( const Config& config_, const std::string& sBase_ )
+: config( config_ ), sBase( sBase_ )
+, bRunning( true ), bConnected( false )
+, stats {}
+{}
+
+Sender::Sender( Mqtt& mqtt, const std::string& sBase, const Config& config )
+: m_pState( std::make_shared<State>( config, sBase ) )
+, m_mqtt( mqtt )
+, m_idObserver {}
+, m_sFilterResend( sBase + "/+/resend" )
+{
+  assert( 0 < config.nChunk );
+  assert( 0 < config.nWindow );
+
+  pState_t pState( m_pState );
+  m_idObserver = m_mqtt.AddObserver(
+    [pState]( Mqtt::EConnection connection ){
+      {
+        std::lock_guard<std::mutex> lock( pState->mutex );
+        pState->bConnected = ( Mqtt::EConnection::connected == connection );
+      }
+      pState->cv.notify_one();
+    } );
+  m_mqtt.Subscribe(
+    m_sFilterResend,
+    [pState]( const std::string_view& svTopic, const std::string_view& svMessage ){ pState->Resend( svTopic, svMessage ); } );
+
+  m_threadSender = std::thread( [this](){ ou::thread::Enter( "mqtt.blob" ); Run(); } );
+}
+
+Sender::~Sender() {
+
+  m_mqtt.UnSubscribe( m_sFilterResend );
+  m_mqtt.RemoveObserver( m_idObserver );
+  {
+    std::lock_guard<std::mutex> lock( m_pState->mutex );
+    m_pState->bRunning = false;
+  }
+  m_pState->cv.notify_one();
+  if ( m_threadSender.joinable() ) m_threadSender.join();
+
+  // completions still in flight hold the state, so claim each fDone under the mutex as they do
+  vTransfer_t vTransfer;
+  std::vector<fDone_t> vfDone;
+  {
+    std::lock_guard<std::mutex> lock( m_pState->mutex );
+    vTransfer.swap( m_pState->vTransfer );
+    for ( pTransfer_t& pTransfer: vTransfer ) {
+      if ( !pTransfer->bDone ) {
+        pTransfer->bDone = true;
+        vfDone.emplace_back( std::move( pTransfer->fDone ) );
+      }
+    }
+  }
+  for ( fDone_t& fDone: vfDone ) {
+    if ( fDone ) fDone( false, result::disconnected );
+  }
+}
+
+bool Sender::Send( const std::string& sId, uint64_t nSize, fRead_t&& fRead, fDone_t&& fDone ) {
+  if ( !Level( sId ) ) return false;
+  if ( ( uint64_t( m_pState->config.nChunk ) * UINT32_MAX ) < nSize ) return false;
+  {
+    std::lock_guard<std::mutex> lock( m_pState->mutex );
+    for ( const pTransfer_t& pTransfer: m_pState->vTransfer ) {
+      if ( sId == pTransfer->sId ) return false;
+    }
+    m_pState->vTransfer.emplace_back(
+      std::make_shared<Transfer>( m_pState->sBase, sId, nSize, m_pState->config.nChunk, std::move( fRead ), std::move( fDone ) ) );
+    ++m_pState->stats.nTransfer;
+  }
+  m_pState->cv.notify_one();
+  return true;
+}
+
+bool Sender::Send( const std::string& sId, std::string&& sBlob, fDone_t&& fDone ) {
+  auto pBlob = std::make_shared<const std::string>( std::move( sBlob ) );
+  const uint64_t nSize( pBlob->size() );
+  return Send(
+    sId, nSize,
+    [pBlob]( uint64_t offset, char* p, size_t n )->bool {
+      std::memcpy( p, pBlob->data() + offset, n );
+      return true;
+    },
+    std::move( fDone ) );
+}
+
+bool Sender::SendFile( const std::string& sId, const std::string& sPath, fDone_t&& fDone ) {
+
+  const int fd = ::open( sPath.c_str(), O_RDONLY );
+  if ( 0 > fd ) throw blob_error( "blob open " + sPath + ": " + std::strerror( errno ) );
+  struct stat st;
+  if ( 0 != ::fstat( fd, &st ) ) {
+    const std::string sError( std::strerror( errno ) );
+    ::close( fd );
+    throw blob_error( "blob stat " + sPath + ": " + sError );
+  }
+  const size_t nSize( st.st_size );
+  void* p( nullptr );
+  if ( 0 < nSize ) {
+    p = ::mmap( nullptr, nSize, PROT_READ, MAP_PRIVATE, fd, 0 );
+    if ( MAP_FAILED == p ) {
+      const std::string sError( std::strerror( errno ) );
+      ::close( fd );
+      throw blob_error( "blob map " + sPath + ": " + sError );
+    }
+    ::madvise( p, nSize, MADV_SEQUENTIAL );
+  }
+  ::close( fd );
+
+  auto pMapping = std::make_shared<Mapping>( static_cast<const char*>( p ), nSize );
+  return Send(
+    sId, nSize,
+    [pMapping]( uint64_t offset, char* p, size_t n )->bool {
+      std::memcpy( p, pMapping->p + offset, n );
+      return true;
+    },
+    std::move( fDone ) );
+}
+
+void Sender::State::Resend( const std::string_view& svTopic, const std::string_view& svMessage ) {
+  const std::string_view svId( Id( sBase, svTopic ) );
+  {
+    std::lock_guard<std::mutex> lock( mutex );
+    vTransfer_t::iterator iter = std::find_if(
+      vTransfer.begin(), vTransfer.end(),
+      [&svId]( const pTransfer_t& pTransfer ){ return svId == pTransfer->sId; } );
+    if ( vTransfer.end() == iter ) return; // not ours, or released
+    Transfer& transfer( **iter );
+
+    if ( 0 == svMessage.size() ) transfer.bMeta = true; // the receiver does not know the transfer
+    std::string_view sv( svMessage );
+    Range range;
+    while ( Get( sv, range ) ) {
+      sv.remove_prefix( sizeof( Range ) );
+      const uint64_t ixEnd( std::min<uint64_t>( uint64_t( range.ixFirst ) + range.nCount, transfer.ixNext ) ); // the first pass sends the rest
+      for ( uint64_t ix = range.ixFirst; ix < ixEnd; ++ix ) {
+        if ( !transfer.vQueued[ ix ] ) {
+          transfer.vQueued[ ix ] = true;
+          transfer.dequeResend.push_back( static_cast<uint32_t>( ix ) );
+        }
+      }
+    }
+    if ( transfer.nChunk == transfer.ixNext ) transfer.bEnd = true; // again, after the resends
+  }
+  cv.notify_one();
+}
+
+void Sender::Run() {
+
+  State& state( *m_pState );
+  std::unique_lock<std::mutex> lock( state.mutex );
+
+  enum class EMessage { meta, chunk, end };
+
+  std::string sPayload; // reused
+  vTransfer_t vRelease;
+
+  while ( state.bRunning ) {
+
+    const clock_t_::time_point now( clock_t_::now() );
+    clock_t_::time_point tpWake( clock_t_::time_point::max() );
+
+    // a transfer with something to send and room in the window, released ones removed
+    pTransfer_t pTransfer;
+    size_t nInFlight {};
+    for ( vTransfer_t::iterator iter = state.vTransfer.begin(); state.vTransfer.end() != iter; ) {
+      Transfer& transfer( **iter );
+      if ( transfer.bDone && ( transfer.tpRelease <= now ) && ( 0 == transfer.nInFlight ) ) {
+        vRelease.emplace_back( std::move( *iter ) ); // fRead, and a mapping, released without the lock
+        iter = state.vTransfer.erase( iter );
+        continue;
+      }
+      if ( transfer.bDone ) tpWake = std::min( tpWake, transfer.tpRelease );
+      nInFlight += transfer.nInFlight;
+      if ( !pTransfer ) {
+        const bool bWork(
+             transfer.bMeta || !transfer.dequeResend.empty() || ( transfer.nChunk > transfer.ixNext )
+          || ( transfer.bEnd && ( transfer.nChunk == transfer.ixNext ) ) );
+        if ( bWork ) pTransfer = *iter;
+      }
+      ++iter;
+    }
+    if ( !vRelease.empty() ) {
+      lock.unlock();
+      vRelease.clear();
+      lock.lock();
+      continue;
+    }
+
+    if ( !pTransfer || !state.bConnected || ( state.config.nWindow <= nInFlight ) ) {
+      if ( clock_t_::time_point::max() == tpWake ) state.cv.wait( lock );
+      else state.cv.wait_until( lock, tpWake );
+      continue;
+    }
+
+    Transfer& transfer( *pTransfer );
+    EMessage eMessage;
+    uint32_t ixChunk {};
+    bool bFirst( false );
+    if ( transfer.bMeta ) {
+      eMessage = EMessage::meta;
+      transfer.bMeta = false;
+    }
+    else if ( !transfer.dequeResend.empty() ) {
+      eMessage = EMessage::chunk;
+      ixChunk = transfer.dequeResend.front();
+      transfer.dequeResend.pop_front();
+      transfer.vQueued[ ixChunk ] = false;
+      ++state.stats.nResent;
+    }
+    else if ( transfer.nChunk > transfer.ixNext ) {
+      eMessage = EMessage::chunk;
+      ixChunk = transfer.ixNext++;
+      bFirst = true;
+    }
+    else {
+      eMessage = EMessage::end;
+      transfer.bEnd = false;
+    }
+    ++transfer.nInFlight;
+
+    lock.unlock(); // fRead and crc belong to this thread, a completion may run inline
+
+    const std::string* psTopic( nullptr );
+    sPayload.clear();
+    bool bRead( true );
+    switch ( eMessage ) {
+      case EMessage::meta: {
+          Meta meta;
+          std::memcpy( meta.szMagic, c_szMagic, sizeof( c_szMagic ) );
+          meta.nVersion = c_nVersion;
+          meta.nSize = transfer.nSize;
+          meta.nChunkSize = static_cast<uint32_t>( state.config.nChunk );
+          meta.nChunk = transfer.nChunk;
+          Put( sPayload, meta );
+          psTopic = &transfer.sTopicMeta;
+        }
+        break;
+      case EMessage::chunk: {
+          const uint64_t offset( uint64_t( ixChunk ) * state.config.nChunk );
+          const size_t nData( std::min<uint64_t>( state.config.nChunk, transfer.nSize - offset ) );
+          sPayload.resize( sizeof( ChunkHeader ) + nData );
+          char* pData( &sPayload[ sizeof( ChunkHeader ) ] );
+          bRead = transfer.fRead( offset, pData, nData );
+          ChunkHeader header{ ixChunk, Crc32( pData, nData ) };
+          std::memcpy( &sPayload[ 0 ], &header, sizeof( ChunkHeader ) );
+          if ( bFirst ) transfer.crc = Crc32( pData, nData, transfer.crc ); // the first pass is in order
+          psTopic = &transfer.sTopicChunk;
+        }
+        break;
+      case EMessage::end: {
+          End end{ transfer.nSize, transfer.nChunk, transfer.crc };
+          Put( sPayload, end );
+          psTopic = &transfer.sTopicEnd;
+        }
+        break;
+    }
+
+    if ( !bRead ) {
+      lock.lock();
+      --transfer.nInFlight;
+      if ( !transfer.bDone ) {
+        transfer.bDone = true;
+        transfer.tpRelease = clock_t_::now(); // nothing worth resending
+        fDone_t fDone( std::move( transfer.fDone ) );
+        lock.unlock();
+        std::cerr << "blob " << transfer.sId << " read failed at chunk " << ixChunk << std::endl;
+        fDone( false, result::failure );
+        lock.lock();
+      }
+      continue;
+    }
+
+    pState_t pState( m_pState );
+    m_mqtt.Publish(
+      *psTopic, sPayload, 1,
+      [pState,pTransfer,eMessage,ixChunk]( bool bOk, int rc ){
+        Transfer& transfer( *pTransfer );
+        fDone_t fDone;
+        bool bDone {};
+        {
+          std::lock_guard<std::mutex> lock( pState->mutex );
+          --transfer.nInFlight;
+          if ( bOk ) {
+            switch ( eMessage ) {
+              case EMessage::meta:
+                transfer.bMetaAcked = true;
+                break;
+              case EMessage::chunk:
+                if ( !transfer.vAcked[ ixChunk ] ) {
+                  transfer.vAcked[ ixChunk ] = true;
+                  ++transfer.nAcked;
+                }
+                break;
+              case EMessage::end:
+                transfer.bEndAcked = true;
+                break;
+            }
+          }
+          else {
+            if ( result::disconnected == rc ) { // again, once reconnected
+              switch ( eMessage ) {
+                case EMessage::meta:
+                  transfer.bMeta = true;
+                  break;
+                case EMessage::chunk:
+                  if ( !transfer.vQueued[ ixChunk ] ) {
+                    transfer.vQueued[ ixChunk ] = true;
+                    transfer.dequeResend.push_back( ixChunk );
+                  }
+                  break;
+                case EMessage::end:
+                  transfer.bEnd = true;
+                  break;
+              }
+            }
+            else {
+              if ( !transfer.bDone ) {
+                transfer.bDone = true;
+                transfer.tpRelease = clock_t_::now();
+                fDone = std::move( transfer.fDone );
+              }
+            }
+          }
+          if ( !transfer.bDone && transfer.bMetaAcked && transfer.bEndAcked && ( transfer.nChunk == transfer.nAcked ) ) {
+            transfer.bDone = true;
+            transfer.tpRelease = clock_t_::now() + pState->config.linger;
+            fDone = std::move( transfer.fDone );
+            bDone = true;
+          }
+        }
+        pState->cv.notify_one();
+        if ( fDone ) fDone( bDone, bDone ? result::success : rc );
+      } );
+
+    lock.lock();
+    if ( EMessage::chunk == eMessage ) {
+      ++state.stats.nChunk;
+      state.stats.nBytes += sPayload.size() - sizeof( ChunkHeader );
+    }
+  }
+}
+
+Sender::Stats Sender::GetStats() const {
+  std::lock_guard<std::mutex> lock( m_pState->mutex );
+  return m_pState->stats;
+}
+
+// ==== Receiver
+
+Receiver::Transfer::~Transfer() {
+  if ( 0 <= fd ) {
+    if ( nullptr != pData ) ::munmap( pData, nSize );
+    ::close( fd );
+  }
+}
+
+Receiver::State::State( Mqtt& mqtt_, const Config& config_, const std::string& sBase_, fOffer_t&& fOffer_, fComplete_t&& fComplete_ )
+: mqtt( mqtt_ ), config( config_ ), sBase( sBase_ )
+, fOffer( std::move( fOffer_ ) ), fComplete( std::move( fComplete_ ) )
+, bRunning( true )
+, stats {}
+{}
+
+Receiver::Receiver( Mqtt& mqtt, const std::string& sBase, fOffer_t&& fOffer, fComplete_t&& fComplete, const Config& config )
+: m_pState( std::make_shared<State>( mqtt, config, sBase, std::move( fOffer ), std::move( fComplete ) ) )
+, m_mqtt( mqtt )
+, m_idObserver {}
+, m_sFilterMeta( sBase + "/+/meta" )
+, m_sFilterChunk( sBase + "/+/chunk" )
+, m_sFilterEnd( sBase + "/+/end" )
+{
+  assert( m_pState->fOffer );
+  assert( m_pState->fComplete );
+
+  pState_t pState( m_pState );
+  m_mqtt.Subscribe( m_sFilterMeta, [pState]( const std::string_view& svTopic, const std::string_view& svMessage ){ pState->Meta( svTopic, svMessage ); } );
+  m_mqtt.Subscribe( m_sFilterChunk, [pState]( const std::string_view& svTopic, const std::string_view& svMessage ){ pState->Chunk( svTopic, svMessage ); } );
+  m_mqtt.Subscribe( m_sFilterEnd, [pState]( const std::string_view& svTopic, const std::string_view& svMessage ){ pState->End( svTopic, svMessage ); } );
+
+  bool bConnected( m_mqtt.IsConnected() ); // the first call, on registration, is not a reconnect
+  m_idObserver = m_mqtt.AddObserver(
+    [pState,bConnected]( Mqtt::EConnection connection ) mutable {
+      const bool bNow( Mqtt::EConnection::connected == connection );
+      if ( bNow && !bConnected ) pState->Reconnected();
+      bConnected = bNow;
+    } );
+
+  m_threadStall = std::thread(
+    [pState](){
+      ou::thread::Enter( "mqtt.blob.stall" );
+      std::unique_lock<std::mutex> lock( pState->mutex );
+      while ( pState->bRunning ) {
+        pState->cv.wait_for( lock, pState->config.stall / 4 );
+        if ( pState->bRunning ) {
+          lock.unlock();
+          pState->Stalled();
+          lock.lock();
+        }
+      }
+    } );
+}
+
+Receiver::~Receiver() {
+  m_mqtt.UnSubscribe( m_sFilterMeta );
+  m_mqtt.UnSubscribe( m_sFilterChunk );
+  m_mqtt.UnSubscribe( m_sFilterEnd );
+  m_mqtt.RemoveObserver( m_idObserver );
+  {
+    std::lock_guard<std::mutex> lock( m_pState->mutex );
+    m_pState->bRunning = false;
+  }
+  m_pState->cv.notify_one();
+  if ( m_threadStall.joinable() ) m_threadStall.join();
+}
+
+void Receiver::State::Meta( const std::string_view& svTopic, const std::string_view& svMessage ) {
+
+  const std::string_view svId( Id( sBase, svTopic ) );
+  ::Meta meta;
+  if ( svId.empty() || !Get( svMessage, meta ) || ( 0 != std::memcmp( meta.szMagic, c_szMagic, sizeof( c_szMagic ) ) ) ) return;
+  if ( ( c_nVersion != meta.nVersion ) || ( 0 == meta.nChunkSize )
+    || ( meta.nChunk != ( meta.nSize + meta.nChunkSize - 1 ) / meta.nChunkSize ) ) {
+    std::cerr << "blob " << svId << " meta not recognised" << std::endl;
+    return;
+  }
+
+  const std::string sId( svId );
+  {
+    std::lock_guard<std::mutex> lock( mutex );
+    if ( umapTransfer.end() != umapTransfer.find( sId ) ) return; // sent again, after a reconnect or on request
+    umapFinished_t::iterator iter = umapFinished.find( sId );
+    if ( umapFinished.end() != iter ) {
+      if ( clock_t_::time_point::max() == iter->second ) return; // declined, or complete
+      umapFinished.erase( iter ); // only asked about
+    }
+  }
+
+  Target target( fOffer( svId, meta.nSize ) );
+
+  pTransfer_t pTransfer( std::make_unique<Transfer>() );
+  Transfer& transfer( *pTransfer );
+  transfer.sId = sId;
+  transfer.nSize = meta.nSize;
+  transfer.nChunkSize = meta.nChunkSize;
+  transfer.nChunk = meta.nChunk;
+  transfer.vHave.resize( meta.nChunk, false );
+  transfer.tpProgress = clock_t_::now();
+
+  bool bDeclined( false );
+  bool bFailed( false );
+  if ( nullptr != target.pBuffer ) transfer.pData = target.pBuffer;
+  else if ( !target.sPath.empty() ) {
+    transfer.fd = ::open( target.sPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644 );
+    if ( ( 0 > transfer.fd ) || ( 0 != ::ftruncate( transfer.fd, meta.nSize ) ) ) bFailed = true;
+    else if ( 0 < meta.nSize ) {
+      void* p = ::mmap( nullptr, meta.nSize, PROT_READ | PROT_WRITE, MAP_SHARED, transfer.fd, 0 );
+      if ( MAP_FAILED == p ) bFailed = true;
+      else transfer.pData = static_cast<char*>( p );
+    }
+    if ( bFailed ) std::cerr << "blob " << sId << " " << target.sPath << ": " << std::strerror( errno ) << std::endl;
+  }
+  else bDeclined = true;
+
+  {
+    std::lock_guard<std::mutex> lock( mutex );
+    if ( bDeclined || bFailed ) umapFinished[ sId ] = clock_t_::time_point::max();
+    else {
+      ++stats.nTransfer;
+      umapTransfer.emplace( sId, std::move( pTransfer ) );
+    }
+  }
+  if ( bFailed ) fComplete( svId, false, std::string_view() );
+}
+
+void Receiver::State::Chunk( const std::string_view& svTopic, const std::string_view& svMessage ) {
+
+  const std::string_view svId( Id( sBase, svTopic ) );
+  ChunkHeader header;
+  if ( svId.empty() || !Get( svMessage, header ) ) return;
+  const std::string_view svData( svMessage.substr( sizeof( ChunkHeader ) ) );
+
+  vRequest_t vRequest;
+  pTransfer_t pComplete;
+  {
+    std::lock_guard<std::mutex> lock( mutex );
+    umapTransfer_t::iterator iter = umapTransfer.find( std::string( svId ) );
+    if ( umapTransfer.end() == iter ) Unknown( svId, vRequest );
+    else {
+      Transfer& transfer( *iter->second );
+      const uint64_t offset( uint64_t( header.ixChunk ) * transfer.nChunkSize );
+      const size_t nExpect( ( transfer.nChunk > header.ixChunk ) ? std::min<uint64_t>( transfer.nChunkSize, transfer.nSize - offset ) : 0 );
+      if ( ( transfer.nChunk <= header.ixChunk ) || ( nExpect != svData.size() ) || ( header.crc != Crc32( svData.data(), svData.size() ) ) ) {
+        ++stats.nCorrupt; // asked for again by gap or stall
+      }
+      else if ( transfer.vHave[ header.ixChunk ] ) ++stats.nDuplicate;
+      else {
+        std::memcpy( transfer.pData + offset, svData.data(), svData.size() );
+        transfer.vHave[ header.ixChunk ] = true;
+        ++transfer.nHave;
+        ++stats.nChunk;
+        transfer.ixMax = std::max( transfer.ixMax, header.ixChunk + 1 );
+        transfer.tpProgress = clock_t_::now();
+        if ( transfer.bEnd && ( transfer.nChunk == transfer.nHave ) ) pComplete = Complete( transfer );
+      }
+    }
+  }
+  Publish( vRequest );
+  if ( pComplete ) Finish( std::move( pComplete ) );
+}
+
+void Receiver::State::End( const std::string_view& svTopic, const std::string_view& svMessage ) {
+
+  const std::string_view svId( Id( sBase, svTopic ) );
+  ::End end;
+  if ( svId.empty() || !Get( svMessage, end ) ) return;
+
+  vRequest_t vRequest;
+  pTransfer_t pComplete;
+  {
+    std::lock_guard<std::mutex> lock( mutex );
+    umapTransfer_t::iterator iter = umapTransfer.find( std::string( svId ) );
+    if ( umapTransfer.end() == iter ) Unknown( svId, vRequest );
+    else {
+      Transfer& transfer( *iter->second );
+      if ( ( end.nSize == transfer.nSize ) && ( end.nChunk == transfer.nChunk ) ) {
+        transfer.bEnd = true;
+        transfer.crcEnd = end.crc;
+        transfer.tpProgress = clock_t_::now();
+        if ( transfer.nChunk == transfer.nHave ) pComplete = Complete( transfer );
+        else Missing( transfer, transfer.nChunk, vRequest );
+      }
+    }
+  }
+  Publish( vRequest );
+  if ( pComplete ) Finish( std::move( pComplete ) );
+}
+
+void Receiver::State::Reconnected() {
+  vRequest_t vRequest;
+  {
+    std::lock_guard<std::mutex> lock( mutex );
+    for ( umapTransfer_t::value_type& vt: umapTransfer ) {
+      Transfer& transfer( *vt.second );
+      // gaps from the outage, later chunks are still to come unless the end has been seen
+      Missing( transfer, transfer.bEnd ? transfer.nChunk : transfer.ixMax, vRequest );
+    }
+  }
+  Publish( vRequest );
+}
+
+void Receiver::State::Stalled() {
+  vRequest_t vRequest;
+  {
+    std::lock_guard<std::mutex> lock( mutex );
+    const clock_t_::time_point now( clock_t_::now() );
+    for ( umapTransfer_t::value_type& vt: umapTransfer ) {
+      Transfer& transfer( *vt.second );
+      if ( ( transfer.tpProgress + config.stall ) <= now ) {
+        Missing( transfer, transfer.nChunk, vRequest ); // the end too may have been lost
+        transfer.tpProgress = now; // once per stall
+      }
+    }
+    for ( umapFinished_t::iterator iter = umapFinished.begin(); umapFinished.end() != iter; ) { // forget unknown ids asked about
+      if ( ( clock_t_::time_point::max() != iter->second ) && ( ( iter->second + config.stall ) <= now ) ) iter = umapFinished.erase( iter );
+      else ++iter;
+    }
+  }
+  Publish( vRequest );
+}
+
+void Receiver::State::Missing( Transfer& transfer, uint32_t ixLimit, vRequest_t& vRequest ) {
+  std::string sPayload;
+  size_t nRange {};
+  uint32_t ix {};
+  while ( ( ix < ixLimit ) && ( c_nRange > nRange ) ) {
+    if ( transfer.vHave[ ix ] ) {
+      ++ix;
+      continue;
+    }
+    Range range{ ix, 0 };
+    while ( ( ix < ixLimit ) && !transfer.vHave[ ix ] ) {
+      ++range.nCount;
+      ++ix;
+    }
+    Put( sPayload, range );
+    ++nRange;
+  }
+  const bool bEnd( transfer.bEnd || ( transfer.nChunk > ixLimit ) );
+  if ( 0 < nRange || !bEnd ) { // with all chunks in and no end, an empty range list asks for the meta and the end
+    ++stats.nRequest;
+    vRequest.emplace_back( Request{ Topic( sBase, transfer.sId, "resend" ), std::move( sPayload ) } );
+  }
+}
+
+void Receiver::State::Unknown( const std::string_view& svId, vRequest_t& vRequest ) {
+  const std::string sId( svId );
+  if ( umapFinished.end() != umapFinished.find( sId ) ) return; // finished, declined, or already asked
+  umapFinished[ sId ] = clock_t_::now();
+  ++stats.nRequest;
+  vRequest.emplace_back( Request{ Topic( sBase, svId, "resend" ), std::string() } );
+}
+
+Receiver::pTransfer_t Receiver::State::Complete( Transfer& transfer ) {
+  umapFinished[ transfer.sId ] = clock_t_::time_point::max();
+  umapTransfer_t::iterator iter = umapTransfer.find( transfer.sId );
+  pTransfer_t pTransfer( std::move( iter->second ) );
+  umapTransfer.erase( iter );
+  return pTransfer;
+}
+
+void Receiver::State::Publish( vRequest_t& vRequest ) {
+  for ( Request& request: vRequest ) {
+    mqtt.Publish( request.sTopic, request.sPayload, 1, []( bool, int ){} );
+  }
+}
+
+void Receiver::State::Finish( pTransfer_t&& pTransfer ) {
+  const Transfer& transfer( *pTransfer );
+  const std::string_view svBlob( transfer.pData, transfer.nSize );
+  const bool bOk( transfer.crcEnd == Crc32( svBlob.data(), svBlob.size() ) );
+  if ( 0 <= transfer.fd && ( nullptr != transfer.pData ) ) ::msync( transfer.pData, transfer.nSize, MS_SYNC );
+  {
+    std::lock_guard<std::mutex> lock( mutex );
+    if ( bOk ) ++stats.nComplete;
+    else ++stats.nCorrupt;
+  }
+  if ( !bOk ) std::cerr << "blob " << transfer.sId << " failed its crc" << std::endl;
+  fComplete( transfer.sId, bOk, svBlob );
+}
+
+Receiver::Stats Receiver::GetStats() const {
+  std::lock_guard<std::mutex> lock( m_pState->mutex );
+  return m_pState->stats;
+}
+
+} // namespace blob
+} // namespace mqtt
+} // namespace ou
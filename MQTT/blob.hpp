@@ -0,0 +1,256 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+ * File:    blob.hpp
+ * Project: Repertory/MQTT
+ * Author:  raymond@burkholder.net
+ * Created: October 19, 2026 22:05:36
+ */
+
+// chunked transfer of large blobs, firmware images and log bundles, through the broker
+//
+//   topics, under a base, per transfer id (a single topic level):
+//     <base>/<id>/meta    size, chunk size, chunk count
+//     <base>/<id>/chunk   chunk index and crc32, then the data
+//     <base>/<id>/end     crc32 of the whole blob, after every chunk has been sent
+//     <base>/<id>/resend  from a receiver, ranges of missing chunks, none to ask for the meta again
+//   all qos 1, at most nWindow messages of a Sender unacknowledged, fixed width fields little endian (the host's)
+//
+//   Sender reads chunks through fRead_t, so memory, a mapped file or any seekable stream will do,
+//     a chunk failing on a disconnect is sent again once reconnected,
+//     and a transfer answers resend requests until nLinger after it is done
+//   Receiver writes chunks into a pre-sized buffer or a mapped file chosen by fOffer_t, drops chunks failing
+//     their crc, checks the whole crc once complete, and asks for what is missing after a reconnect,
+//     when the end arrives with gaps, and when nothing has arrived for stall
+
+#pragma once
+
+#include <mutex>
+#include <deque>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+#include <functional>
+#include <string_view>
+#include <unordered_map>
+#include <condition_variable>
+
+#include "mqtt.hpp"
+
+namespace ou {
+namespace mqtt {
+namespace blob {
+
+struct blob_error: std::runtime_error {
+  blob_error( const std::string& e ): std::runtime_error( e ) {}
+};
+
+uint32_t Crc32( const char* p, size_t n, uint32_t crc = 0 ); // ieee, continues from a previous crc
+
+class Sender {
+public:
+
+  struct Config {
+    size_t nChunk;  // bytes of data per chunk, below the broker's message size limit
+    size_t nWindow; // unacknowledged messages
+    std::chrono::milliseconds linger; // resend requests are answered this long after done
+    Config(): nChunk( 64 * 1024 ), nWindow( 8 ), linger( 60000 ) {}
+  };
+
+  Sender( Mqtt&, const std::string& sBase, const Config& = Config() );
+  ~Sender(); // unfinished transfers complete with ( false, result::disconnected )
+
+  // reads n bytes at offset into p, false on error, called on the sender thread, again for a resent chunk
+  using fRead_t = std::function<bool( uint64_t offset, char* p, size_t n )>;
+  // meta, every chunk and the end acked, or ( false, rc ) on a read error or a publish failure other than a disconnect
+  using fDone_t = std::function<void( bool, int )>;
+
+  // false when the id is in use, or not a single topic level
+  bool Send( const std::string& sId, uint64_t nSize, fRead_t&&, fDone_t&& );
+  bool Send( const std::string& sId, std::string&& sBlob, fDone_t&& );
+  bool SendFile( const std::string& sId, const std::string& sPath, fDone_t&& ); // mapped, blob_error when it cannot be
+
+  struct Stats {
+    uint64_t nTransfer;
+    uint64_t nChunk;   // chunks published, resent ones included
+    uint64_t nResent;  // after a disconnect or on request
+    uint64_t nBytes;   // chunk data published
+  };
+  Stats GetStats() const;
+
+protected:
+private:
+
+  using clock_t_ = std::chrono::steady_clock;
+
+  struct Transfer {
+    const std::string sId;
+    const std::string sTopicMeta;
+    const std::string sTopicChunk;
+    const std::string sTopicEnd;
+    const uint64_t nSize;
+    const uint32_t nChunk;
+    fRead_t fRead;
+    fDone_t fDone;
+    bool bMeta;       // to be sent
+    bool bEnd;        // to be sent, once the first pass and the resends are out
+    uint32_t ixNext;  // first pass
+    uint32_t crc;     // over the first pass
+    std::deque<uint32_t> dequeResend;
+    std::vector<bool> vQueued; // in dequeResend
+    std::vector<bool> vAcked;
+    uint32_t nAcked;
+    bool bMetaAcked;
+    bool bEndAcked;
+    size_t nInFlight;
+    bool bDone;
+    clock_t_::time_point tpRelease; // once done
+    Transfer( const std::string& sBase, const std::string& sId, uint64_t nSize, size_t nChunkSize, fRead_t&&, fDone_t&& );
+  };
+  using pTransfer_t = std::shared_ptr<Transfer>;
+  using vTransfer_t = std::vector<pTransfer_t>;
+
+  // shared with completions and handlers, which may arrive after destruction
+  struct State {
+    const Config config;
+    const std::string sBase;
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+    bool bRunning;
+    bool bConnected;
+    vTransfer_t vTransfer; // in arrival order
+    Stats stats;
+    State( const Config&, const std::string& sBase );
+    void Resend( const std::string_view& svTopic, const std::string_view& svMessage );
+  };
+  using pState_t = std::shared_ptr<State>;
+  pState_t m_pState;
+
+  Mqtt& m_mqtt;
+  Mqtt::idObserver_t m_idObserver;
+  const std::string m_sFilterResend;
+  std::thread m_threadSender;
+
+  void Run(); // thread
+
+};
+
+class Receiver {
+public:
+
+  // where a transfer is written: pBuffer, at least nSize bytes and owned by the caller,
+  //   or sPath, a file created, sized and mapped, neither to decline the transfer
+  struct Target {
+    char* pBuffer;
+    std::string sPath;
+    Target(): pBuffer( nullptr ) {}
+  };
+  using fOffer_t = std::function<Target( const std::string_view& svId, uint64_t nSize )>;
+  // the blob is valid during the call, bOk false when the whole crc, or the file, failed
+  using fComplete_t = std::function<void( const std::string_view& svId, bool bOk, const std::string_view& svBlob )>;
+  // both are called on the mqtt thread, without the receiver's lock
+
+  struct Config {
+    std::chrono::milliseconds stall; // missing chunks are requested after this long without progress
+    Config(): stall( 5000 ) {}
+  };
+
+  Receiver( Mqtt&, const std::string& sBase, fOffer_t&&, fComplete_t&&, const Config& = Config() );
+  ~Receiver(); // unfinished transfers are abandoned, files keep what was written
+
+  struct Stats {
+    uint64_t nTransfer; // offered
+    uint64_t nComplete; // crc correct
+    uint64_t nChunk;
+    uint64_t nDuplicate;
+    uint64_t nCorrupt;  // chunk crc or size wrong, whole crc wrong
+    uint64_t nRequest;  // resend requests published
+  };
+  Stats GetStats() const;
+
+protected:
+private:
+
+  using clock_t_ = std::chrono::steady_clock;
+
+  struct Transfer {
+    std::string sId;
+    uint64_t nSize;
+    uint32_t nChunkSize;
+    uint32_t nChunk;
+    char* pData;
+    int fd;           // mapped file, or -1
+    std::vector<bool> vHave;
+    uint32_t nHave;
+    uint32_t ixMax;   // highest chunk received, plus one
+    bool bEnd;
+    uint32_t crcEnd;
+    clock_t_::time_point tpProgress;
+    Transfer(): nSize {}, nChunkSize {}, nChunk {}, pData( nullptr ), fd( -1 ), nHave {}, ixMax {}, bEnd( false ), crcEnd {} {}
+    ~Transfer(); // unmaps
+  };
+  using pTransfer_t = std::unique_ptr<Transfer>;
+  using umapTransfer_t = std::unordered_map<std::string, pTransfer_t>;
+  using umapFinished_t = std::unordered_map<std::string, clock_t_::time_point>; // completed or declined, and unknown ids asked about
+
+  struct Request { // built under the lock, published after
+    std::string sTopic;
+    std::string sPayload;
+  };
+  using vRequest_t = std::vector<Request>;
+
+  struct State {
+    Mqtt& mqtt;
+    const Config config;
+    const std::string sBase;
+    const fOffer_t fOffer;
+    const fComplete_t fComplete;
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+    bool bRunning;
+    umapTransfer_t umapTransfer;
+    umapFinished_t umapFinished;
+    Stats stats;
+    State( Mqtt&, const Config&, const std::string& sBase, fOffer_t&&, fComplete_t&& );
+    void Meta( const std::string_view& svTopic, const std::string_view& svMessage );
+    void Chunk( const std::string_view& svTopic, const std::string_view& svMessage );
+    void End( const std::string_view& svTopic, const std::string_view& svMessage );
+    void Reconnected();
+    void Stalled(); // thread
+    void Missing( Transfer&, uint32_t ixLimit, vRequest_t& ); // under mutex, chunks below ixLimit
+    void Unknown( const std::string_view& svId, vRequest_t& ); // under mutex, asks for the meta
+    pTransfer_t Complete( Transfer& ); // under mutex, when every chunk and the end are in, removes it
+    void Publish( vRequest_t& );
+    void Finish( pTransfer_t&& ); // without the mutex, calls fComplete
+  };
+  using pState_t = std::shared_ptr<State>;
+  pState_t m_pState;
+
+  Mqtt& m_mqtt;
+  Mqtt::idObserver_t m_idObserver;
+  const std::string m_sFilterMeta;
+  const std::string m_sFilterChunk;
+  const std::string m_sFilterEnd;
+  std::thread m_threadStall;
+
+};
+
+} // namespace blob
+} // namespace mqtt
+} // namespace ou
@@ -0,0 +1,343 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+  File:    capture.cpp
+  Project: Repertory/MQTT
+  Author:  raymond@burkholder.net
+  Created: October 19, 2026 18:05:37
+*/
+
+#include <chrono>
+#include <thread>
+#include <cassert>
+#include <cstring>
+#include <cstdio>
+#include <iostream>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "hash.hpp"
+#include "mqtt.hpp"
+#include "capture.hpp"
+
+namespace {
+
+  const char c_szMagic[ 8 ] = { 'O', 'U', 'M', 'Q', 'C', 'A', 'P', '1' };
+
+  struct SegmentHeader {
+    char szMagic[ 8 ];
+    uint32_t nVersion;
+    uint32_t nHeader; // sizeof( SegmentHeader )
+    uint64_t ixSegment;
+  };
+
+  enum ERecord: uint16_t { topic = 1, message = 2 };
+
+  struct RecordHeader {
+    uint32_t nSize;    // whole record, padded to 8, 0 marks the end
+    uint16_t eType;    // ERecord
+    uint16_t nFlags;
+    uint32_t idTopic;
+    uint32_t nPayload; // topic text or message payload
+    int64_t nsTime;    // system clock, messages only
+  };
+
+  static_assert( 0 == sizeof( SegmentHeader ) % 8, "segment header alignment" );
+  static_assert( 0 == sizeof( RecordHeader ) % 8, "record header alignment" );
+
+  inline size_t Align( size_t n ) { return ( n + 7 ) & ~size_t( 7 ); }
+  inline size_t Size( const std::string_view& sv ) { return Align( sizeof( RecordHeader ) + sv.size() ); }
+
+  std::string Error( const std::string& sWhat, const std::string& sName ) {
+    return sWhat + " " + sName + ": " + std::strerror( errno );
+  }
+
+} // namespace anonymous
+
+namespace ou {
+namespace mqtt {
+namespace capture {
+
+std::string SegmentName( const std::string& sBase, size_t ixSegment ) {
+  char szNumber[ 16 ];
+  std::snprintf( szNumber, sizeof( szNumber ), "%06zu", ixSegment );
+  return sBase + '.' + szNumber + ".cap";
+}
+
+// ==== Recorder
+
+Recorder::Recorder( const std::string& sBase, size_t nSegmentBytes )
+: m_sBase( sBase ), m_nSegmentBytes( Align( nSegmentBytes ) )
+, m_fd( -1 ), m_pSegment( nullptr ), m_nUsed {}, m_ixSegment {}
+, m_maskIndex( 1023 )
+, m_stats {}
+{
+  assert( 4096 <= nSegmentBytes );
+  m_vIndex.resize( m_maskIndex + 1, 0 );
+  if ( !Open( m_ixSegment ) ) {
+    throw capture_error( Error( "capture open", SegmentName( m_sBase, m_ixSegment ) ) );
+  }
+}
+
+Recorder::~Recorder() {
+  std::lock_guard<std::mutex> lock( m_mutex );
+  Close();
+}
+
+bool Recorder::Open( size_t ixSegment ) {
+
+  assert( nullptr == m_pSegment );
+
+  const std::string sName( SegmentName( m_sBase, ixSegment ) );
+
+  m_fd = ::open( sName.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644 );
+  if ( 0 > m_fd ) {
+    std::cerr << Error( "capture open", sName ) << std::endl;
+    return false;
+  }
+  if ( 0 != ::ftruncate( m_fd, m_nSegmentBytes ) ) {
+    std::cerr << Error( "capture size", sName ) << std::endl;
+    ::close( m_fd );
+    m_fd = -1;
+    return false;
+  }
+  void* p = ::mmap( nullptr, m_nSegmentBytes, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0 );
+  if ( MAP_FAILED == p ) {
+    std::cerr << Error( "capture map", sName ) << std::endl;
+    ::close( m_fd );
+    m_fd = -1;
+    return false;
+  }
+  m_pSegment = static_cast<char*>( p );
+  m_ixSegment = ixSegment;
+
+  SegmentHeader header {};
+  std::memcpy( header.szMagic, c_szMagic, sizeof( c_szMagic ) );
+  header.nVersion = 1;
+  header.nHeader = sizeof( SegmentHeader );
+  header.ixSegment = m_ixSegment;
+  std::memcpy( m_pSegment, &header, sizeof( SegmentHeader ) );
+  m_nUsed = sizeof( SegmentHeader );
+
+  ++m_stats.nSegment;
+  return true;
+}
+
+void Recorder::Close() {
+  if ( nullptr != m_pSegment ) {
+    ::munmap( m_pSegment, m_nSegmentBytes );
+    m_pSegment = nullptr;
+    if ( 0 != ::ftruncate( m_fd, m_nUsed ) ) { // trim the unused tail
+      std::cerr << Error( "capture trim", SegmentName( m_sBase, m_ixSegment ) ) << std::endl;
+    }
+    ::close( m_fd );
+    m_fd = -1;
+  }
+}
+
+bool Recorder::Reserve( size_t nRecord ) {
+  if ( ( nullptr != m_pSegment ) && ( ( m_nUsed + nRecord ) <= m_nSegmentBytes ) ) return true;
+  Close();
+  return Open( m_ixSegment + 1 ); // a failed roll is retried on the same number
+}
+
+uint32_t Recorder::Id( const std::string_view& svTopic ) {
+
+  size_t ixIndex( Hash( svTopic ) & m_maskIndex );
+  while ( 0 != m_vIndex[ ixIndex ] ) {
+    const uint32_t id( m_vIndex[ ixIndex ] - 1 );
+    if ( svTopic == m_vTopic[ id ] ) return id;
+    ixIndex = ( ixIndex + 1 ) & m_maskIndex;
+  }
+
+  const uint32_t id( m_vTopic.size() );
+  m_vTopic.emplace_back( svTopic );
+  m_vTopicSegment.emplace_back( 0 );
+  m_vIndex[ ixIndex ] = id + 1;
+
+  if ( ( 2 * m_vTopic.size() ) > m_maskIndex ) { // keep the load under a half
+    m_maskIndex = 2 * m_maskIndex + 1;
+    m_vIndex.assign( m_maskIndex + 1, 0 );
+    for ( uint32_t idRehash = 0; idRehash < m_vTopic.size(); ++idRehash ) {
+      size_t ix( Hash( m_vTopic[ idRehash ] ) & m_maskIndex );
+      while ( 0 != m_vIndex[ ix ] ) ix = ( ix + 1 ) & m_maskIndex;
+      m_vIndex[ ix ] = idRehash + 1;
+    }
+  }
+  return id;
+}
+
+void Recorder::Append( uint16_t eType, uint32_t idTopic, int64_t nsTime, const std::string_view& sv ) {
+  const size_t nSize( Size( sv ) );
+  assert( ( m_nUsed + nSize ) <= m_nSegmentBytes );
+  RecordHeader header { static_cast<uint32_t>( nSize ), eType, 0, idTopic, static_cast<uint32_t>( sv.size() ), nsTime };
+  char* p( m_pSegment + m_nUsed );
+  std::memcpy( p, &header, sizeof( RecordHeader ) );
+  std::memcpy( p + sizeof( RecordHeader ), sv.data(), sv.size() );
+  // padding is already zero, the segment was freshly sized
+  m_nUsed += nSize;
+  m_stats.nBytes += nSize;
+}
+
+void Recorder::Record( const std::string_view& svTopic, const std::string_view& svMessage ) {
+
+  const int64_t nsTime( std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::system_clock::now().time_since_epoch() ).count() );
+  const size_t nTopic( Size( svTopic ) );
+  const size_t nMessage( Size( svMessage ) );
+
+  std::lock_guard<std::mutex> lock( m_mutex );
+
+  if ( ( nTopic + nMessage ) > ( m_nSegmentBytes - sizeof( SegmentHeader ) ) ) {
+    ++m_stats.nDropped;
+    return;
+  }
+
+  const uint32_t idTopic( Id( svTopic ) );
+  const bool bDefined( ( nullptr != m_pSegment ) && ( ( m_ixSegment + 1 ) == m_vTopicSegment[ idTopic ] ) );
+  if ( !Reserve( nMessage + ( bDefined ? 0 : nTopic ) ) ) {
+    ++m_stats.nDropped;
+    return;
+  }
+  if ( ( m_ixSegment + 1 ) != m_vTopicSegment[ idTopic ] ) { // not yet defined in this segment, or just rolled
+    Append( ERecord::topic, idTopic, 0, svTopic );
+    m_vTopicSegment[ idTopic ] = m_ixSegment + 1;
+  }
+  Append( ERecord::message, idTopic, nsTime, svMessage );
+  ++m_stats.nMessage;
+}
+
+Recorder::Stats Recorder::GetStats() const {
+  std::lock_guard<std::mutex> lock( m_mutex );
+  return m_stats;
+}
+
+// ==== Replayer
+
+Replayer::Replayer( const std::string& sBase )
+: m_sBase( sBase )
+{
+  const std::string sName( SegmentName( m_sBase, 0 ) );
+  if ( 0 != ::access( sName.c_str(), R_OK ) ) {
+    throw capture_error( Error( "capture replay", sName ) );
+  }
+}
+
+uint64_t Replayer::Run( const fMessage_t& fMessage, double dblSpeed ) {
+
+  assert( 0.0 <= dblSpeed );
+
+  using clock_t_ = std::chrono::steady_clock;
+
+  uint64_t nMessage {};
+  std::vector<std::string> vTopic; // by id, NUL terminated for Publish
+  bool bFirst( true );
+  int64_t nsFirst {};
+  clock_t_::time_point tpStart;
+
+  for ( size_t ixSegment = 0; true; ++ixSegment ) {
+
+    const std::string sName( SegmentName( m_sBase, ixSegment ) );
+    const int fd = ::open( sName.c_str(), O_RDONLY );
+    if ( 0 > fd ) break; // end of capture
+
+    struct stat st;
+    if ( ( 0 != ::fstat( fd, &st ) ) || ( sizeof( SegmentHeader ) > static_cast<size_t>( st.st_size ) ) ) {
+      std::cerr << "capture replay: " << sName << " is truncated" << std::endl;
+      ::close( fd );
+      break;
+    }
+    const size_t nSize( st.st_size );
+    void* p = ::mmap( nullptr, nSize, PROT_READ, MAP_PRIVATE, fd, 0 );
+    ::close( fd );
+    if ( MAP_FAILED == p ) {
+      std::cerr << Error( "capture replay map", sName ) << std::endl;
+      break;
+    }
+    const char* pSegment( static_cast<const char*>( p ) );
+    ::madvise( p, nSize, MADV_SEQUENTIAL );
+
+    SegmentHeader header;
+    std::memcpy( &header, pSegment, sizeof( SegmentHeader ) );
+    if ( 0 != std::memcmp( header.szMagic, c_szMagic, sizeof( c_szMagic ) ) ) {
+      std::cerr << "capture replay: " << sName << " is not a capture segment" << std::endl;
+      ::munmap( p, nSize );
+      break;
+    }
+
+    bool bCorrupt( false );
+    size_t ix( header.nHeader );
+    while ( !bCorrupt && ( ( ix + sizeof( RecordHeader ) ) <= nSize ) ) {
+      RecordHeader record;
+      std::memcpy( &record, pSegment + ix, sizeof( RecordHeader ) );
+      if ( ( 0 == record.nSize ) || ( ( ix + record.nSize ) > nSize ) ) break;
+      const std::string_view sv( pSegment + ix + sizeof( RecordHeader ), record.nPayload );
+      switch ( record.eType ) {
+        case ERecord::topic:
+          if ( vTopic.size() <= record.idTopic ) vTopic.resize( record.idTopic + 1 );
+          vTopic[ record.idTopic ] = sv;
+          break;
+        case ERecord::message:
+          if ( ( vTopic.size() <= record.idTopic ) || vTopic[ record.idTopic ].empty() ) {
+            std::cerr << "capture replay: " << sName << " message refers to undefined topic " << record.idTopic << std::endl;
+            bCorrupt = true;
+            break;
+          }
+          if ( 0.0 < dblSpeed ) {
+            if ( bFirst ) {
+              bFirst = false;
+              nsFirst = record.nsTime;
+              tpStart = clock_t_::now();
+            }
+            const std::chrono::nanoseconds ns( static_cast<int64_t>( ( record.nsTime - nsFirst ) / dblSpeed ) );
+            std::this_thread::sleep_until( tpStart + ns );
+          }
+          fMessage( vTopic[ record.idTopic ], sv );
+          ++nMessage;
+          break;
+        default:
+          break; // later record types are skipped
+      }
+      ix += record.nSize;
+    }
+
+    ::munmap( p, nSize );
+    if ( bCorrupt ) break;
+  }
+
+  return nMessage;
+}
+
+uint64_t Replayer::Dispatch( Mqtt& mqtt, double dblSpeed ) {
+  return Run(
+    [&mqtt]( const std::string_view& svTopic, const std::string_view& svMessage ){
+      mqtt.Dispatch( svTopic, svMessage );
+    },
+    dblSpeed );
+}
+
+uint64_t Replayer::Republish( Mqtt& mqtt, double dblSpeed, int nQoS ) {
+  return Run(
+    [&mqtt,nQoS]( const std::string_view& svTopic, const std::string_view& svMessage ){
+      mqtt.Publish( svTopic, svMessage, nQoS, []( bool, int ){} );
+    },
+    dblSpeed );
+}
+
+} // namespace capture
+} // namespace mqtt
+} // namespace ou
@@ -0,0 +1,122 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+ * File:    capture.hpp
+ * Project: Repertory/MQTT
+ * Author:  raymond@burkholder.net
+ * Created: October 19, 2026 18:05:37
+ */
+
+// record inbound traffic to memory mapped capture segments, and replay it
+//
+//   segments are "<base>.<nnnnnn>.cap", each pre-sized and mapped, trimmed to length when closed
+//   a segment starts with a header, then 8 byte aligned records:
+//     topic:   defines a topic id, emitted the first time a topic appears in each segment,
+//              so any segment can be replayed alone
+//     message: wall clock time, topic id, payload
+//   a record size of 0 marks the end of a segment
+//
+//   Recorder is attached with Mqtt::SetRecorder, Replayer feeds a capture to Mqtt::Dispatch, Mqtt::Publish,
+//   or any fMessage_t, at the recorded pace, a multiple of it, or as fast as possible
+
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+#include <functional>
+#include <string_view>
+
+namespace ou {
+class Mqtt;
+namespace mqtt {
+namespace capture {
+
+struct capture_error: std::runtime_error {
+  capture_error( const std::string& e ): std::runtime_error( e ) {}
+};
+
+std::string SegmentName( const std::string& sBase, size_t ixSegment );
+
+class Recorder {
+public:
+
+  Recorder( const std::string& sBase, size_t nSegmentBytes = 64 * 1024 * 1024 ); // capture_error
+  ~Recorder();
+
+  void Record( const std::string_view& svTopic, const std::string_view& svMessage ); // any thread
+
+  struct Stats {
+    uint64_t nMessage;
+    uint64_t nBytes;   // written, all segments
+    uint64_t nDropped; // larger than a segment, or a segment could not be opened
+    size_t nSegment;
+  };
+  Stats GetStats() const;
+
+protected:
+private:
+
+  const std::string m_sBase;
+  const size_t m_nSegmentBytes;
+
+  mutable std::mutex m_mutex;
+
+  int m_fd;
+  char* m_pSegment;
+  size_t m_nUsed;
+  size_t m_ixSegment; // of the open segment, or of the last one opened
+
+  // topic ids, open addressed on the topic text so a message builds no std::string
+  std::vector<std::string> m_vTopic;      // by id
+  std::vector<size_t> m_vTopicSegment;    // by id, segment + 1 in which the topic was last defined
+  std::vector<uint32_t> m_vIndex;         // id + 1, 0 is empty
+  size_t m_maskIndex;
+
+  Stats m_stats;
+
+  uint32_t Id( const std::string_view& svTopic );
+  bool Open( size_t ixSegment ); // m_ixSegment follows only on success, so numbering has no gaps
+  void Close();
+  bool Reserve( size_t nRecord );
+  void Append( uint16_t eType, uint32_t idTopic, int64_t nsTime, const std::string_view& );
+
+};
+
+class Replayer {
+public:
+
+  explicit Replayer( const std::string& sBase ); // capture_error when the first segment is missing
+
+  using fMessage_t = std::function<void( const std::string_view& svTopic, const std::string_view& svMessage )>;
+
+  // dblSpeed: 1.0 as recorded, 10.0 ten times faster, 0.0 no pacing, returns messages delivered
+  //   svMessage refers to the mapped segment and is valid for the duration of the call
+  //   a damaged segment, or a message on a topic not defined before it, ends the replay with a note on std::cerr
+  uint64_t Run( const fMessage_t&, double dblSpeed = 1.0 );
+
+  uint64_t Dispatch( Mqtt&, double dblSpeed = 1.0 ); // through the subscription handlers
+  uint64_t Republish( Mqtt&, double dblSpeed = 1.0, int nQoS = 0 );
+
+protected:
+private:
+  const std::string m_sBase;
+};
+
+} // namespace capture
+} // namespace mqtt
+} // namespace ou
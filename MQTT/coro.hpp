@@ -0,0 +1,385 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+ * File:    coro.hpp
+ * Project: Repertory/MQTT
+ * Author:  raymond@burkholder.net
+ * Created: October 19, 2026 15:20:44
+ */
+
+// optional c++20 coroutine layer, header only, the library itself remains c++17
+//
+//   ou::mqtt::coro::Task Run( ou::mqtt::coro::Client& client ) {
+//     auto sub = client.Subscribe( "cmd/#" );
+//     while ( auto message = co_await sub.Next() ) {
+//       auto ack = co_await client.AsyncPublish( "reply/x", message->sMessage );
+//       if ( !ack ) break;
+//     }
+//   }
+//   ou::mqtt::coro::Spawn( executor, Run( client ) );
+//
+// coroutines are always resumed through the supplied Executor, never on the mqtt callback thread,
+// frames come from a per thread recycling allocator
+
+#pragma once
+
+#if !defined( __cpp_impl_coroutine ) || !__has_include( <coroutine> )
+#error "coro.hpp requires c++20 coroutines"
+#endif
+
+#include <mutex>
+#include <array>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <optional>
+#include <coroutine>
+#include <exception>
+#include <string_view>
+#include <condition_variable>
+
+#include "mqtt.hpp"
+
+namespace ou {
+namespace mqtt {
+namespace coro {
+
+// resumes coroutines, supplied by the application
+class Executor {
+public:
+  virtual ~Executor() {}
+  virtual void Post( std::coroutine_handle<> ) = 0; // any thread
+};
+
+// simple executor: Run() resumes posted coroutines on the calling thread until Stop()
+class LoopExecutor: public Executor {
+public:
+
+  LoopExecutor(): m_bRunning( true ) {}
+
+  void Post( std::coroutine_handle<> handle ) override {
+    {
+      std::lock_guard<std::mutex> lock( m_mutex );
+      m_vPosted.push_back( handle );
+    }
+    m_cv.notify_one();
+  }
+
+  void Run() {
+    std::vector<std::coroutine_handle<> > vRun; // swapped with m_vPosted, so capacity is retained by both
+    std::unique_lock<std::mutex> lock( m_mutex );
+    while ( true ) {
+      m_cv.wait( lock, [this]{ return !m_vPosted.empty() || !m_bRunning; } );
+      if ( m_vPosted.empty() ) break; // stopped and drained
+      vRun.swap( m_vPosted );
+      lock.unlock();
+      for ( std::coroutine_handle<>& handle: vRun ) handle.resume();
+      vRun.clear();
+      lock.lock();
+    }
+  }
+
+  void Stop() {
+    {
+      std::lock_guard<std::mutex> lock( m_mutex );
+      m_bRunning = false;
+    }
+    m_cv.notify_all();
+  }
+
+private:
+  bool m_bRunning;
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::vector<std::coroutine_handle<> > m_vPosted;
+};
+
+// coroutine frames, free lists per size class per thread
+//   a frame released on another thread joins that thread's list, lists are capped
+class FrameAllocator {
+public:
+
+  static void* Allocate( size_t nBytes ) {
+    const size_t ixClass( Class( nBytes ) );
+    if ( c_nClass <= ixClass ) {
+      Header* pHeader = static_cast<Header*>( ::operator new( sizeof( Header ) + nBytes ) );
+      pHeader->ixClass = ixClass;
+      return pHeader + 1;
+    }
+    List& list( Lists()[ ixClass ] );
+    Header* pHeader( list.pHead );
+    if ( nullptr != pHeader ) {
+      list.pHead = pHeader->pNext;
+      --list.nFree;
+      pHeader->ixClass = ixClass; // the union was in use as the link
+    }
+    else {
+      pHeader = static_cast<Header*>( ::operator new( sizeof( Header ) + ( ixClass + 1 ) * c_nGranule ) );
+      pHeader->ixClass = ixClass;
+    }
+    return pHeader + 1;
+  }
+
+  static void Release( void* p ) noexcept {
+    Header* pHeader = static_cast<Header*>( p ) - 1;
+    const size_t ixClass( pHeader->ixClass );
+    if ( c_nClass <= ixClass ) {
+      ::operator delete( pHeader );
+      return;
+    }
+    List& list( Lists()[ ixClass ] );
+    if ( c_nFreeMax <= list.nFree ) {
+      ::operator delete( pHeader );
+    }
+    else {
+      pHeader->pNext = list.pHead;
+      list.pHead = pHeader;
+      ++list.nFree;
+    }
+  }
+
+private:
+
+  static const size_t c_nGranule = 64;
+  static const size_t c_nClass = 32; // frames up to 2k are recycled
+  static const size_t c_nFreeMax = 256;
+
+  union alignas( std::max_align_t ) Header {
+    size_t ixClass;  // while allocated
+    Header* pNext;   // while free, class is implied by the list
+  };
+
+  struct List {
+    Header* pHead;
+    size_t nFree;
+    List(): pHead( nullptr ), nFree {} {}
+    ~List() {
+      while ( nullptr != pHead ) {
+        Header* pHeader( pHead );
+        pHead = pHeader->pNext;
+        ::operator delete( pHeader );
+      }
+    }
+  };
+  using rList_t = std::array<List, c_nClass>;
+
+  static size_t Class( size_t nBytes ) { return ( nBytes + c_nGranule - 1 ) / c_nGranule - 1; }
+
+  static rList_t& Lists() {
+    thread_local rList_t rList;
+    return rList;
+  }
+};
+
+// detached coroutine, started with Spawn, the frame is released when the body completes
+//   exceptions escaping the body terminate
+class Task {
+public:
+
+  struct promise_type {
+    Task get_return_object() { return Task( std::coroutine_handle<promise_type>::from_promise( *this ) ); }
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { std::terminate(); }
+    static void* operator new( size_t nBytes ) { return FrameAllocator::Allocate( nBytes ); }
+    static void operator delete( void* p ) noexcept { FrameAllocator::Release( p ); }
+  };
+
+  Task( Task&& rhs ): m_handle( std::exchange( rhs.m_handle, nullptr ) ) {}
+  Task( const Task& ) = delete;
+  ~Task() { if ( m_handle ) m_handle.destroy(); } // never spawned
+
+private:
+  friend void Spawn( Executor&, Task&& );
+  std::coroutine_handle<promise_type> m_handle;
+  explicit Task( std::coroutine_handle<promise_type> handle ): m_handle( handle ) {}
+};
+
+inline void Spawn( Executor& executor, Task&& task ) {
+  assert( task.m_handle );
+  executor.Post( std::exchange( task.m_handle, nullptr ) );
+}
+
+struct Ack {
+  bool bOk;
+  int rc; // mqtt::result
+  explicit operator bool() const { return bOk; }
+};
+
+struct Message {
+  std::string sTopic;
+  std::string sMessage;
+};
+
+// inbound messages of one filter, buffered until Next() is awaited
+//   when the buffer is full the oldest message is dropped and counted
+//   one awaiting coroutine at a time
+class Subscription {
+public:
+
+  Subscription( Subscription&& ) = default;
+  Subscription( const Subscription& ) = delete;
+  ~Subscription() { Close(); }
+
+  class NextAwaiter {
+  public:
+    explicit NextAwaiter( Subscription& sub ): m_sub( sub ) {}
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend( std::coroutine_handle<> handle ) { // false: resume immediately
+      std::lock_guard<std::mutex> lock( m_sub.m_pState->mutex );
+      if ( !m_sub.m_pState->dequeMessage.empty() || m_sub.m_pState->bClosed ) return false;
+      assert( !m_sub.m_pState->handle );
+      m_sub.m_pState->handle = handle;
+      return true;
+    }
+    std::optional<Message> await_resume() { // empty once closed and drained
+      std::lock_guard<std::mutex> lock( m_sub.m_pState->mutex );
+      if ( m_sub.m_pState->dequeMessage.empty() ) return std::nullopt;
+      std::optional<Message> message( std::move( m_sub.m_pState->dequeMessage.front() ) );
+      m_sub.m_pState->dequeMessage.pop_front();
+      return message;
+    }
+  private:
+    Subscription& m_sub;
+  };
+
+  NextAwaiter Next() { return NextAwaiter( *this ); }
+
+  size_t Dropped() const {
+    std::lock_guard<std::mutex> lock( m_pState->mutex );
+    return m_pState->nDropped;
+  }
+
+  // unsubscribes, a waiting coroutine resumes with an empty message
+  void Close() {
+    if ( !m_pState ) return; // moved from
+    std::coroutine_handle<> handle;
+    {
+      std::lock_guard<std::mutex> lock( m_pState->mutex );
+      if ( m_pState->bClosed ) return;
+      m_pState->bClosed = true;
+      handle = std::exchange( m_pState->handle, nullptr );
+    }
+    m_pState->mqtt.UnSubscribe( m_pState->sFilter );
+    if ( handle ) m_pState->executor.Post( handle );
+  }
+
+private:
+
+  friend class Client;
+
+  // shared with the handler registered in Mqtt, which may briefly outlive UnSubscribe
+  struct State {
+    Mqtt& mqtt;
+    Executor& executor;
+    const std::string sFilter;
+    const size_t nCapacity;
+    mutable std::mutex mutex;
+    std::deque<Message> dequeMessage;
+    std::coroutine_handle<> handle;
+    size_t nDropped;
+    bool bClosed;
+    State( Mqtt& mqtt_, Executor& executor_, const std::string_view& svFilter, size_t nCapacity_ )
+    : mqtt( mqtt_ ), executor( executor_ ), sFilter( svFilter ), nCapacity( nCapacity_ )
+    , nDropped {}, bClosed( false )
+    {}
+  };
+  using pState_t = std::shared_ptr<State>;
+  pState_t m_pState;
+
+  Subscription( Mqtt& mqtt, Executor& executor, const std::string_view& svFilter, size_t nCapacity )
+  : m_pState( std::make_shared<State>( mqtt, executor, svFilter, nCapacity ) )
+  {
+    assert( 0 < nCapacity );
+    pState_t pState( m_pState );
+    mqtt.Subscribe(
+      pState->sFilter,
+      [pState]( const std::string_view& svTopic, const std::string_view& svMessage ){
+        std::coroutine_handle<> handle;
+        {
+          std::lock_guard<std::mutex> lock( pState->mutex );
+          if ( pState->bClosed ) return;
+          if ( pState->nCapacity == pState->dequeMessage.size() ) {
+            pState->dequeMessage.pop_front();
+            ++pState->nDropped;
+          }
+          pState->dequeMessage.emplace_back( Message{ std::string( svTopic ), std::string( svMessage ) } );
+          handle = std::exchange( pState->handle, nullptr );
+        }
+        if ( handle ) pState->executor.Post( handle );
+      } );
+  }
+
+};
+
+// binds an Mqtt instance to the executor which resumes its coroutines
+class Client {
+public:
+
+  Client( Mqtt& mqtt, Executor& executor ): m_mqtt( mqtt ), m_executor( executor ) {}
+
+  // resumes when the publish completes, as per Mqtt::Publish: qos 1 on broker ack, qos 0 once handed off
+  //   svTopic and svMessage must stay valid until resumed, svTopic NUL terminated, as with Mqtt::Publish
+  class PublishAwaiter {
+  public:
+    PublishAwaiter( Mqtt& mqtt, Executor& executor, const std::string_view& svTopic, const std::string_view& svMessage, int nQoS )
+    : m_mqtt( mqtt ), m_executor( executor ), m_svTopic( svTopic ), m_svMessage( svMessage ), m_nQoS( nQoS )
+    , m_ack{ false, mqtt::result::failure }
+    {}
+    bool await_ready() const noexcept { return false; }
+    void await_suspend( std::coroutine_handle<> handle ) {
+      m_handle = handle;
+      // only 'this' is captured, small enough for std::function to hold without allocating
+      m_mqtt.Publish(
+        m_svTopic, m_svMessage, m_nQoS,
+        [this]( bool bOk, int rc ){
+          m_ack = Ack{ bOk, rc };
+          m_executor.Post( m_handle ); // 'this' may be gone once posted
+        } );
+    }
+    Ack await_resume() const noexcept { return m_ack; }
+  private:
+    Mqtt& m_mqtt;
+    Executor& m_executor;
+    std::string_view m_svTopic;
+    std::string_view m_svMessage;
+    int m_nQoS;
+    Ack m_ack;
+    std::coroutine_handle<> m_handle;
+  };
+
+  PublishAwaiter AsyncPublish( const std::string_view& svTopic, const std::string_view& svMessage, int nQoS = 1 ) {
+    return PublishAwaiter( m_mqtt, m_executor, svTopic, svMessage, nQoS );
+  }
+
+  Subscription Subscribe( const std::string_view& svFilter, size_t nCapacity = 1024 ) {
+    return Subscription( m_mqtt, m_executor, svFilter, nCapacity );
+  }
+
+  Executor& GetExecutor() { return m_executor; }
+
+private:
+  Mqtt& m_mqtt;
+  Executor& m_executor;
+};
+
+} // namespace coro
+} // namespace mqtt
+} // namespace ou
@@ -0,0 +1,44 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+  File:    counters.cpp
+  Project: Repertory/MQTT
+  Author:  raymond@burkholder.net
+  Created: October 19, 2026 13:31:48
+*/
+
+#include "counters.hpp"
+
+namespace ou {
+namespace mqtt {
+
+std::string Counters::Snapshot::Json() const {
+  std::string s;
+  s.reserve( 128 );
+  s += "{\"pub\":";     s += std::to_string( nPublished );
+  s += ",\"ack\":";     s += std::to_string( nAcked );
+  s += ",\"fail\":";    s += std::to_string( nFailed );
+  s += ",\"drop\":";    s += std::to_string( nDropped );
+  s += ",\"expire\":";  s += std::to_string( nExpired );
+  s += ",\"reconn\":";  s += std::to_string( nReconnect );
+  s += ",\"in\":";      s += std::to_string( nInbound );
+  s += ",\"env\":";     s += std::to_string( nEnvelope );
+  s += ",\"invalid\":"; s += std::to_string( nInvalid );
+  s += '}';
+  return s;
+}
+
+} // namespace mqtt
+} // namespace ou
@@ -0,0 +1,83 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+ * File:    counters.hpp
+ * Project: Repertory/MQTT
+ * Author:  raymond@burkholder.net
+ * Created: October 19, 2026 13:31:48
+ */
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <cstdint>
+
+namespace ou {
+namespace mqtt {
+
+// monotonic, updated with relaxed increments,
+//   each on its own cache line as publishers and the callback thread touch different ones
+struct Counters {
+
+  struct Snapshot {
+    uint64_t nPublished;
+    uint64_t nAcked;
+    uint64_t nFailed;
+    uint64_t nDropped;
+    uint64_t nExpired;
+    uint64_t nReconnect;
+    uint64_t nInbound;
+    uint64_t nEnvelope;
+    uint64_t nInvalid;
+    std::string Json() const; // compact, for the health topic
+  };
+
+  alignas( 64 ) std::atomic<uint64_t> nPublished; // accepted by the transport
+  alignas( 64 ) std::atomic<uint64_t> nAcked;     // qos 1 acked, qos 0 handed off
+  alignas( 64 ) std::atomic<uint64_t> nFailed;    // rejected by the transport, or lost in flight on disconnect
+  alignas( 64 ) std::atomic<uint64_t> nDropped;   // Publish while disconnected
+  alignas( 64 ) std::atomic<uint64_t> nExpired;   // deadline passed before sending
+  alignas( 64 ) std::atomic<uint64_t> nReconnect;
+  alignas( 64 ) std::atomic<uint64_t> nInbound;   // messages and envelope records, as dispatched
+  alignas( 64 ) std::atomic<uint64_t> nEnvelope;  // envelopes unpacked
+  alignas( 64 ) std::atomic<uint64_t> nInvalid;   // inbound dropped by validation, see Mqtt::SetValidation
+
+  Counters()
+  : nPublished {}, nAcked {}, nFailed {}, nDropped {}, nExpired {}, nReconnect {}, nInbound {}, nEnvelope {}, nInvalid {}
+  {}
+
+  static void Increment( std::atomic<uint64_t>& counter, uint64_t n = 1 ) {
+    counter.fetch_add( n, std::memory_order_relaxed );
+  }
+
+  Snapshot Take() const {
+    return Snapshot{
+      nPublished.load( std::memory_order_relaxed )
+    , nAcked.load( std::memory_order_relaxed )
+    , nFailed.load( std::memory_order_relaxed )
+    , nDropped.load( std::memory_order_relaxed )
+    , nExpired.load( std::memory_order_relaxed )
+    , nReconnect.load( std::memory_order_relaxed )
+    , nInbound.load( std::memory_order_relaxed )
+    , nEnvelope.load( std::memory_order_relaxed )
+    , nInvalid.load( std::memory_order_relaxed )
+    };
+  }
+
+};
+
+} // namespace mqtt
+} // namespace ou
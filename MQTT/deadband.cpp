@@ -0,0 +1,153 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+  File:    deadband.cpp
+  Project: Repertory/MQTT
+  Author:  raymond@burkholder.net
+  Created: October 19, 2026 16:58:40
+*/
+
+#include <cmath>
+#include <limits>
+#include <cassert>
+#include <charconv>
+
+#include "deadband.hpp"
+
+namespace {
+  const int c_nQoS( 1 );
+}
+
+namespace ou {
+namespace mqtt {
+
+Deadband::Deadband( Mqtt& mqtt, const vBand_t& vBand )
+: Deadband( mqtt, vBand, c_nQoS )
+{}
+
+Deadband::Deadband( Mqtt& mqtt, const vBand_t& vBand, int nQoS )
+: m_mqtt( mqtt ), m_nQoS( nQoS )
+, m_nPublished {}, m_nSuppressed {}
+{
+  assert( vBand.size() < npos );
+  m_pFailed.reset( new std::atomic<bool>[ vBand.size() ]() );
+  m_vEntry.reserve( vBand.size() );
+  m_vCold.reserve( vBand.size() );
+  for ( const Band& band: vBand ) {
+    assert( 0.0 <= band.dblAbsolute );
+    assert( 0.0 <= band.dblPercent );
+    const int64_t nsHeartbeat(
+      std::chrono::milliseconds::zero() < band.heartbeat
+      ? std::chrono::duration_cast<std::chrono::nanoseconds>( band.heartbeat ).count()
+      : std::numeric_limits<int64_t>::max() );
+    m_vEntry.emplace_back( Entry{ 0.0, band.dblAbsolute, band.dblPercent / 100.0, 0 } );
+    m_vCold.emplace_back( Cold{ band.sTopic, nsHeartbeat } );
+  }
+}
+
+Deadband::id_t Deadband::Find( const std::string_view& svTopic ) const {
+  for ( id_t id = 0; id < m_vCold.size(); ++id ) {
+    if ( svTopic == m_vCold[ id ].sTopic ) return id;
+  }
+  return npos;
+}
+
+bool Deadband::Changed( id_t id, double value, int64_t nsNow ) {
+
+  Entry& entry( m_vEntry[ id ] );
+  const Cold& cold( m_vCold[ id ] );
+
+  const double dblDelta( std::abs( value - entry.dblPublished ) );
+
+  bool bPublish( entry.nsDeadline <= nsNow ); // first sample, or heartbeat due
+  if ( m_pFailed[ id ].load( std::memory_order_relaxed ) ) { // the last publish was lost
+    m_pFailed[ id ].store( false, std::memory_order_relaxed );
+    bPublish = true;
+  }
+  if ( !bPublish ) {
+    // a band of 0 is disabled, but with both disabled any change is published
+    const bool bAbsolute( 0.0 < entry.dblAbsolute );
+    const bool bFraction( 0.0 < entry.dblFraction );
+    if ( bAbsolute && ( entry.dblAbsolute < dblDelta ) ) bPublish = true;
+    else if ( bFraction && ( ( entry.dblFraction * std::abs( entry.dblPublished ) ) < dblDelta ) ) bPublish = true;
+    else if ( !bAbsolute && !bFraction && ( 0.0 != dblDelta ) ) bPublish = true;
+  }
+
+  if ( bPublish ) {
+    entry.dblPublished = value;
+    entry.nsDeadline =
+      ( std::numeric_limits<int64_t>::max() - nsNow ) < cold.nsHeartbeat
+      ? std::numeric_limits<int64_t>::max()
+      : nsNow + cold.nsHeartbeat;
+    Counters::Increment( m_nPublished );
+  }
+  else {
+    Counters::Increment( m_nSuppressed );
+  }
+  return bPublish;
+}
+
+void Deadband::Publish( id_t id, double value, Mqtt::fPublishComplete_t&& fPublishComplete ) {
+
+  assert( id < m_vEntry.size() );
+
+  const int64_t nsNow( std::chrono::duration_cast<std::chrono::nanoseconds>( clock_t_::now().time_since_epoch() ).count() );
+  if ( Changed( id, value, nsNow ) ) {
+    char buf[ 32 ];
+    const std::to_chars_result conversion = std::to_chars( buf, buf + sizeof( buf ), value );
+    Send( id, std::string_view( buf, conversion.ptr - buf ), std::move( fPublishComplete ) );
+  }
+  else {
+    fPublishComplete( true, result::success );
+  }
+}
+
+void Deadband::Publish( id_t id, const std::string_view& svMessage, Mqtt::fPublishComplete_t&& fPublishComplete ) {
+
+  assert( id < m_vEntry.size() );
+
+  double value {};
+  const char* end( svMessage.data() + svMessage.size() );
+  const std::from_chars_result conversion = std::from_chars( svMessage.data(), end, value );
+  const bool bNumber( ( std::errc() == conversion.ec ) && ( end == conversion.ptr ) && std::isfinite( value ) );
+
+  const Cold& cold( m_vCold[ id ] );
+  if ( !bNumber ) {
+    Counters::Increment( m_nPublished );
+    m_mqtt.Publish( cold.sTopic, svMessage, m_nQoS, std::move( fPublishComplete ) );
+    return;
+  }
+
+  const int64_t nsNow( std::chrono::duration_cast<std::chrono::nanoseconds>( clock_t_::now().time_since_epoch() ).count() );
+  if ( Changed( id, value, nsNow ) ) {
+    Send( id, svMessage, std::move( fPublishComplete ) ); // as given, not reformatted
+  }
+  else {
+    fPublishComplete( true, result::success );
+  }
+}
+
+void Deadband::Send( id_t id, const std::string_view& svMessage, Mqtt::fPublishComplete_t&& fPublishComplete ) {
+  // dblPublished already holds the value, a failure, even one completed inline, has the next sample sent regardless
+  m_mqtt.Publish(
+    m_vCold[ id ].sTopic, svMessage, m_nQoS,
+    [pFailed=m_pFailed,id,fPublishComplete=std::move( fPublishComplete )]( bool bOk, int rc ){
+      if ( !bOk ) pFailed[ id ].store( true, std::memory_order_relaxed );
+      fPublishComplete( bOk, rc );
+    } );
+}
+
+} // namespace mqtt
+} // namespace ou
@@ -0,0 +1,117 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+ * File:    deadband.hpp
+ * Project: Repertory/MQTT
+ * Author:  raymond@burkholder.net
+ * Created: October 19, 2026 16:58:40
+ */
+
+// report by exception: a numeric value is published only when it moves outside its band,
+//   or when the topic has been silent for the heartbeat interval (checked as samples arrive)
+//
+//   topics are resolved once to an id, a sample is then an index into a flat table,
+//   the values compared on every sample are packed apart from the topic strings
+//   an id is expected to be fed from one thread at a time, different ids from any thread
+//   a publish which completes with an error leaves the consumer's view unknown, the next sample is published regardless
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <string_view>
+
+#include "mqtt.hpp"
+
+namespace ou {
+namespace mqtt {
+
+class Deadband {
+public:
+
+  struct Band {
+    std::string sTopic;
+    double dblAbsolute; // publish when | value - published | exceeds, 0 to disable
+    double dblPercent;  // publish when | value - published | exceeds this percentage of | published |, 0 to disable
+    std::chrono::milliseconds heartbeat; // publish regardless after this much silence, 0 to disable
+  };
+  using vBand_t = std::vector<Band>;
+
+  using id_t = uint32_t;
+  static const id_t npos = ~id_t( 0 );
+
+  Deadband( Mqtt&, const vBand_t& ); // ids are the band positions
+  Deadband( Mqtt&, const vBand_t&, int nQoS );
+
+  id_t Find( const std::string_view& svTopic ) const; // once per topic, not per sample
+
+  // suppressed samples complete with ( true, result::success ), as the consumer's view is unchanged
+  //   a payload which is not a number is always published
+  void Publish( id_t, const std::string_view& svMessage, Mqtt::fPublishComplete_t&& );
+  void Publish( id_t, double value, Mqtt::fPublishComplete_t&& );
+
+  struct Stats {
+    uint64_t nPublished;
+    uint64_t nSuppressed;
+  };
+  Stats GetStats() const {
+    return Stats{ m_nPublished.load( std::memory_order_relaxed ), m_nSuppressed.load( std::memory_order_relaxed ) };
+  }
+
+protected:
+private:
+
+  using clock_t_ = std::chrono::steady_clock;
+
+  // hot, 32 bytes, two to a cache line
+  struct Entry {
+    double dblPublished;
+    double dblAbsolute;
+    double dblFraction; // percent / 100
+    int64_t nsDeadline; // last publish + heartbeat, INT64_MAX without heartbeat, 0 forces the next sample
+  };
+  using vEntry_t = std::vector<Entry>;
+
+  struct Cold {
+    std::string sTopic;
+    int64_t nsHeartbeat;
+  };
+  using vCold_t = std::vector<Cold>;
+
+  Mqtt& m_mqtt;
+  const int m_nQoS;
+
+  vEntry_t m_vEntry;
+  vCold_t m_vCold;
+
+  // by id, set by a failed completion, shared as completions may arrive after destruction
+  using pFailed_t = std::shared_ptr<std::atomic<bool>[]>;
+  pFailed_t m_pFailed;
+
+  void Send( id_t, const std::string_view& svMessage, Mqtt::fPublishComplete_t&& );
+
+  alignas( 64 ) std::atomic<uint64_t> m_nPublished;
+  alignas( 64 ) std::atomic<uint64_t> m_nSuppressed;
+
+  bool Changed( id_t, double value, int64_t nsNow );
+
+};
+
+} // namespace mqtt
+} // namespace ou
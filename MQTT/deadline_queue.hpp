@@ -0,0 +1,206 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+ * File:    deadline_queue.hpp
+ * Project: Repertory/MQTT
+ * Author:  raymond@burkholder.net
+ * Created: October 20, 2026 09:12:40
+ */
+
+// fifo of messages with deadlines, where an expired message is found wherever it sits
+//
+//   messages sit in a table of slots, reused through a free list, each slot holding the sequence of its message,
+//     the fifo and a min-heap of ( deadline, sequence, slot ) refer to them, so either finds out in O(1)
+//     whether its message is still queued: the slot still holds the same sequence
+//   the heap gives the earliest deadline in O(1), expiry takes messages from anywhere in O(log n) each,
+//     leaving a gap in the fifo that is skipped at the front
+//   deadline_t::max() is never indexed
+//   heap entries of messages already popped are discarded lazily, on reaching the top,
+//     and both the gaps and the heap are compacted once they outnumber the live messages
+//   not thread safe, owners hold their own mutex
+
+#pragma once
+
+#include <deque>
+#include <chrono>
+#include <limits>
+#include <vector>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include <optional>
+#include <algorithm>
+
+namespace ou {
+namespace mqtt {
+
+template<typename message_t> // with a 'deadline' member of deadline_t
+class DeadlineQueue {
+public:
+
+  using deadline_t = std::chrono::steady_clock::time_point;
+
+  DeadlineQueue(): m_seqNext {}, m_nLive {} {}
+
+  size_t size() const { return m_nLive; }
+  bool empty() const { return 0 == m_nLive; }
+
+  void push_back( message_t&& message ) {
+    const uint64_t seq( m_seqNext++ );
+    size_t ixSlot;
+    if ( m_vFree.empty() ) {
+      ixSlot = m_vSlot.size();
+      m_vSlot.emplace_back();
+    }
+    else {
+      ixSlot = m_vFree.back();
+      m_vFree.pop_back();
+    }
+    if ( deadline_t::max() != message.deadline ) {
+      m_vHeap.emplace_back( Heap{ message.deadline, seq, ixSlot } );
+      std::push_heap( m_vHeap.begin(), m_vHeap.end(), Later() );
+    }
+    Slot& slot( m_vSlot[ ixSlot ] );
+    slot.seq = seq;
+    slot.message.emplace( std::move( message ) );
+    m_deque.emplace_back( Ref{ seq, ixSlot } );
+    ++m_nLive;
+  }
+
+  message_t& front() {
+    assert( !empty() );
+    return *m_vSlot[ m_deque.front().ixSlot ].message; // the front is always live
+  }
+
+  void pop_front() {
+    assert( !empty() );
+    Release( m_deque.front().ixSlot );
+    m_deque.pop_front();
+    --m_nLive;
+    Trim();
+  }
+
+  // earliest deadline of a queued message, deadline_t::max() when none
+  deadline_t Earliest() {
+    Purge();
+    return m_vHeap.empty() ? deadline_t::max() : m_vHeap.front().deadline;
+  }
+
+  // hands each message with deadline <= now to f, earliest deadline first, returns how many
+  template<typename F>
+  size_t Expire( deadline_t now, F&& f ) {
+    size_t nExpired {};
+    while ( deadline_t::max() != Earliest() ) {
+      if ( now < m_vHeap.front().deadline ) break;
+      const size_t ixSlot( m_vHeap.front().ixSlot ); // Purge left a live top
+      std::pop_heap( m_vHeap.begin(), m_vHeap.end(), Later() );
+      m_vHeap.pop_back();
+      --m_nLive;
+      f( std::move( *m_vSlot[ ixSlot ].message ) );
+      Release( ixSlot );
+      ++nExpired;
+    }
+    if ( 0 < nExpired ) {
+      Trim();
+      Compact();
+    }
+    return nExpired;
+  }
+
+  // hands every message to f in fifo order, leaves the queue empty
+  template<typename F>
+  void Take( F&& f ) {
+    for ( const Ref& ref: m_deque ) {
+      if ( Live( ref.seq, ref.ixSlot ) ) f( std::move( *m_vSlot[ ref.ixSlot ].message ) );
+    }
+    m_deque.clear();
+    m_vHeap.clear();
+    m_vSlot.clear();
+    m_vFree.clear();
+    m_nLive = 0;
+  }
+
+protected:
+private:
+
+  static const uint64_t c_seqFree = std::numeric_limits<uint64_t>::max();
+
+  struct Slot {
+    uint64_t seq; // of the message held, c_seqFree when on the free list
+    std::optional<message_t> message;
+    Slot(): seq( c_seqFree ) {}
+  };
+
+  struct Ref { // fifo entry
+    uint64_t seq;
+    size_t ixSlot;
+  };
+
+  struct Heap {
+    deadline_t deadline;
+    uint64_t seq;
+    size_t ixSlot;
+  };
+
+  struct Later { // min-heap on deadline, fifo among equal deadlines
+    bool operator()( const Heap& lhs, const Heap& rhs ) const {
+      return ( lhs.deadline == rhs.deadline ) ? ( lhs.seq > rhs.seq ) : ( lhs.deadline > rhs.deadline );
+    }
+  };
+
+  std::deque<Ref> m_deque; // ascending seq, gaps where expired
+  std::vector<Heap> m_vHeap;
+  std::vector<Slot> m_vSlot;
+  std::vector<size_t> m_vFree;
+  uint64_t m_seqNext;
+  size_t m_nLive;
+
+  bool Live( uint64_t seq, size_t ixSlot ) const { return seq == m_vSlot[ ixSlot ].seq; }
+
+  void Release( size_t ixSlot ) {
+    Slot& slot( m_vSlot[ ixSlot ] );
+    slot.seq = c_seqFree;
+    slot.message.reset();
+    m_vFree.push_back( ixSlot );
+  }
+
+  void Purge() { // drop heap tops no longer queued
+    while ( !m_vHeap.empty() && !Live( m_vHeap.front().seq, m_vHeap.front().ixSlot ) ) {
+      std::pop_heap( m_vHeap.begin(), m_vHeap.end(), Later() );
+      m_vHeap.pop_back();
+    }
+    if ( ( 2 * m_nLive + 16 ) < m_vHeap.size() ) { // popped messages with distant deadlines
+      m_vHeap.erase(
+        std::remove_if( m_vHeap.begin(), m_vHeap.end(), [this]( const Heap& heap ){ return !Live( heap.seq, heap.ixSlot ); } ),
+        m_vHeap.end() );
+      std::make_heap( m_vHeap.begin(), m_vHeap.end(), Later() );
+    }
+  }
+
+  void Trim() {
+    while ( !m_deque.empty() && !Live( m_deque.front().seq, m_deque.front().ixSlot ) ) m_deque.pop_front();
+  }
+
+  void Compact() { // gaps held behind a long lived front
+    if ( ( m_deque.size() - m_nLive ) <= ( m_nLive + 16 ) ) return;
+    m_deque.erase(
+      std::remove_if( m_deque.begin(), m_deque.end(), [this]( const Ref& ref ){ return !Live( ref.seq, ref.ixSlot ); } ),
+      m_deque.end() );
+  }
+
+};
+
+} // namespace mqtt
+} // namespace ou
@@ -0,0 +1,409 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+  File:    delta.cpp
+  Project: Repertory/MQTT
+  Author:  raymond@burkholder.net
+  Created: October 19, 2026 17:22:15
+*/
+
+#include <cassert>
+#include <algorithm>
+#include <charconv>
+
+#include "delta.hpp"
+
+namespace {
+
+  const int c_nQoS( 1 );
+
+  // no json text starts with a NUL, nor do many plain payloads
+  const char c_rMagic[] = { '\0', 'O', 'U', 'D' };
+  const std::string_view c_svMagic( c_rMagic, sizeof( c_rMagic ) );
+  const char c_chVersion( '1' );
+  const size_t c_nFrame( sizeof( c_rMagic ) + 2 ); // magic, version, type
+
+  void Frame( std::string& sPayload, char chType ) {
+    sPayload += c_svMagic;
+    sPayload += c_chVersion;
+    sPayload += chType;
+  }
+
+  inline bool Space( char ch ) { return ( ' ' == ch ) || ( '\t' == ch ) || ( '\n' == ch ) || ( '\r' == ch ); }
+
+  // index just past the string starting at ix ( a '"' ), npos when unterminated
+  size_t SkipString( const std::string_view& sv, size_t ix ) {
+    for ( ++ix; ix < sv.size(); ++ix ) {
+      if ( '\\' == sv[ ix ] ) ++ix;
+      else if ( '"' == sv[ ix ] ) return ix + 1;
+    }
+    return std::string_view::npos;
+  }
+
+  // index of the ',' or '}' ending the value starting at ix, npos when malformed
+  size_t SkipValue( const std::string_view& sv, size_t ix ) {
+    int nDepth {};
+    while ( ix < sv.size() ) {
+      const char ch( sv[ ix ] );
+      if ( '"' == ch ) {
+        ix = SkipString( sv, ix );
+        if ( std::string_view::npos == ix ) return ix;
+        continue;
+      }
+      if ( ( '{' == ch ) || ( '[' == ch ) ) ++nDepth;
+      else if ( ( '}' == ch ) || ( ']' == ch ) ) {
+        if ( 0 == nDepth ) return '}' == ch ? ix : std::string_view::npos;
+        --nDepth;
+      }
+      else if ( ( ',' == ch ) && ( 0 == nDepth ) ) return ix;
+      ++ix;
+    }
+    return std::string_view::npos;
+  }
+
+  std::string_view Trim( std::string_view sv ) {
+    while ( !sv.empty() && Space( sv.front() ) ) sv.remove_prefix( 1 );
+    while ( !sv.empty() && Space( sv.back() ) ) sv.remove_suffix( 1 );
+    return sv;
+  }
+
+  const ou::mqtt::delta::Field* Lookup( const ou::mqtt::delta::vField_t& vField, const std::string& sKey ) {
+    for ( const ou::mqtt::delta::Field& field: vField ) {
+      if ( sKey == field.first ) return &field;
+    }
+    return nullptr;
+  }
+
+  void Serialize( const ou::mqtt::delta::vField_t& vField, std::string& s ) {
+    s += '{';
+    bool bFirst( true );
+    for ( const ou::mqtt::delta::Field& field: vField ) {
+      if ( !bFirst ) s += ',';
+      bFirst = false;
+      s += field.first;
+      s += ':';
+      s += field.second;
+    }
+    s += '}';
+  }
+
+  // svArray is a json array of strings, as written by the publisher
+  bool Contains( const std::string_view& svArray, const std::string_view& svKey ) {
+    size_t ix( svArray.find( '"' ) );
+    while ( std::string_view::npos != ix ) {
+      const size_t ixEnd( SkipString( svArray, ix ) );
+      if ( std::string_view::npos == ixEnd ) return false;
+      if ( svKey == svArray.substr( ix, ixEnd - ix ) ) return true;
+      ix = svArray.find( '"', ixEnd );
+    }
+    return false;
+  }
+
+  bool Number( const std::string_view& sv, uint64_t& n ) {
+    const char* end( sv.data() + sv.size() );
+    const std::from_chars_result conversion = std::from_chars( sv.data(), end, n );
+    return ( std::errc() == conversion.ec ) && ( end == conversion.ptr );
+  }
+
+} // namespace anonymous
+
+namespace ou {
+namespace mqtt {
+namespace delta {
+
+bool Parse( const std::string_view& svDocument, vField_t& vField ) {
+
+  vField.clear();
+
+  const std::string_view sv( Trim( svDocument ) );
+  if ( ( 2 > sv.size() ) || ( '{' != sv.front() ) || ( '}' != sv.back() ) ) return false;
+
+  size_t ix( 1 );
+  while ( true ) {
+    while ( ( ix < sv.size() ) && Space( sv[ ix ] ) ) ++ix;
+    if ( ix >= sv.size() ) return false;
+    if ( '}' == sv[ ix ] ) return ( ix + 1 ) == sv.size() && vField.empty();
+    if ( '"' != sv[ ix ] ) return false;
+
+    const size_t ixKey( ix );
+    ix = SkipString( sv, ix );
+    if ( std::string_view::npos == ix ) return false;
+    const std::string_view svKey( sv.substr( ixKey, ix - ixKey ) );
+
+    while ( ( ix < sv.size() ) && Space( sv[ ix ] ) ) ++ix;
+    if ( ( ix >= sv.size() ) || ( ':' != sv[ ix ] ) ) return false;
+    ++ix;
+
+    const size_t ixValue( ix );
+    ix = SkipValue( sv, ix );
+    if ( std::string_view::npos == ix ) return false;
+    const std::string_view svValue( Trim( sv.substr( ixValue, ix - ixValue ) ) );
+    if ( svValue.empty() ) return false;
+
+    vField.emplace_back( Field( svKey, svValue ) );
+
+    if ( '}' == sv[ ix ] ) return ( ix + 1 ) == sv.size();
+    ++ix; // ','
+  }
+}
+
+// ==== Publisher
+
+Publisher::Publisher( Mqtt& mqtt, const Config& config )
+: m_pState( std::make_shared<State>( mqtt, config ) )
+{
+  assert( 0 < config.nDeltaPerKeyframe );
+  pState_t pState( m_pState );
+  mqtt.Subscribe(
+    config.sRequestTopic,
+    [pState]( const std::string_view&, const std::string_view& svTopic ){
+      pState->Requested( svTopic );
+    } );
+}
+
+Publisher::~Publisher() {
+  m_pState->mqtt.UnSubscribe( m_pState->config.sRequestTopic );
+}
+
+void Publisher::Keyframe( Topic& topic, const std::string_view& svDocument, std::string& sPayload ) {
+  topic.nKeyframe = topic.nSequence;
+  topic.nDelta = 0;
+  sPayload.reserve( 24 + svDocument.size() );
+  Frame( sPayload, 'K' );
+  sPayload += std::to_string( topic.nSequence );
+  sPayload += '\n';
+  sPayload += svDocument;
+}
+
+void Publisher::State::Requested( const std::string_view& svTopic ) {
+  std::string sTopic( svTopic );
+  std::string sPayload;
+  {
+    std::lock_guard<std::mutex> lock( mutex );
+    umapTopic_t::iterator iter = umapTopic.find( sTopic );
+    if ( umapTopic.end() == iter ) return; // another publisher's topic
+    Topic& topic( iter->second );
+    ++topic.nSequence;
+    Parse( topic.sDocument, topic.vKeyframe );
+    Keyframe( topic, topic.sDocument, sPayload );
+  }
+  mqtt.Publish( sTopic, sPayload, c_nQoS, []( bool, int ){} );
+}
+
+void Publisher::Publish( const std::string_view& svTopic, const std::string_view& svDocument, Mqtt::fPublishComplete_t&& fPublishComplete ) {
+
+  State& state( *m_pState );
+  std::string sPayload;
+
+  {
+    std::lock_guard<std::mutex> lock( state.mutex );
+
+    if ( !Parse( svDocument, state.vParsed ) ) { // not an object, as is
+      if ( c_svMagic == svDocument.substr( 0, c_svMagic.size() ) ) Frame( sPayload, 'P' ); // would read as a frame
+      sPayload += svDocument;
+    }
+    else {
+      Topic& topic( state.umapTopic[ std::string( svTopic ) ] );
+      ++topic.nSequence;
+      topic.sDocument = svDocument;
+
+      bool bKeyframe( ( 0 == topic.nKeyframe ) || ( state.config.nDeltaPerKeyframe <= topic.nDelta ) );
+
+      if ( !bKeyframe ) {
+        std::string sChanged;
+        std::string sRemoved;
+        for ( const Field& field: state.vParsed ) {
+          const Field* pKeyframe( Lookup( topic.vKeyframe, field.first ) );
+          if ( ( nullptr == pKeyframe ) || ( pKeyframe->second != field.second ) ) {
+            sChanged += sChanged.empty() ? '{' : ',';
+            sChanged += field.first;
+            sChanged += ':';
+            sChanged += field.second;
+          }
+        }
+        sChanged += sChanged.empty() ? "{}" : "}";
+        for ( const Field& field: topic.vKeyframe ) {
+          if ( nullptr == Lookup( state.vParsed, field.first ) ) {
+            sRemoved += sRemoved.empty() ? '[' : ',';
+            sRemoved += field.first;
+          }
+        }
+        if ( !sRemoved.empty() ) sRemoved += ']';
+
+        const size_t nDelta( 48 + sChanged.size() + sRemoved.size() );
+        if ( nDelta >= svDocument.size() ) bKeyframe = true; // no saving
+        else {
+          ++topic.nDelta;
+          sPayload.reserve( nDelta );
+          Frame( sPayload, 'D' );
+          sPayload += std::to_string( topic.nSequence );
+          sPayload += ' ';
+          sPayload += std::to_string( topic.nKeyframe );
+          sPayload += ' ';
+          sPayload += std::to_string( sChanged.size() );
+          sPayload += '\n';
+          sPayload += sChanged;
+          sPayload += sRemoved;
+        }
+      }
+
+      if ( bKeyframe ) {
+        topic.vKeyframe.swap( state.vParsed );
+        Keyframe( topic, svDocument, sPayload );
+      }
+    }
+  }
+
+  // outside the lock, so a delta may overtake the keyframe answering a request,
+  //   the subscriber then drops it and asks again after its retry interval
+  state.mqtt.Publish( svTopic, sPayload, c_nQoS, std::move( fPublishComplete ) );
+}
+
+// ==== Subscriber
+
+Subscriber::Subscriber( Mqtt& mqtt, const Config& config )
+: m_pState( std::make_shared<State>( mqtt, config ) )
+{}
+
+Subscriber::~Subscriber() {
+  for ( const std::string& sFilter: m_vFilter ) {
+    m_pState->mqtt.UnSubscribe( sFilter );
+  }
+}
+
+void Subscriber::Subscribe( const std::string& sFilter, Mqtt::fMessage_t&& fMessage ) {
+  m_vFilter.push_back( sFilter );
+  pState_t pState( m_pState );
+  m_pState->mqtt.Subscribe(
+    sFilter,
+    [pState,fMessage_=std::move( fMessage )]( const std::string_view& svTopic, const std::string_view& svMessage ){
+      pState->Received( svTopic, svMessage, fMessage_ );
+    } );
+}
+
+void Subscriber::UnSubscribe( const std::string& sFilter ) {
+  m_pState->mqtt.UnSubscribe( sFilter );
+  m_vFilter.erase( std::remove( m_vFilter.begin(), m_vFilter.end(), sFilter ), m_vFilter.end() );
+}
+
+Subscriber::Stats Subscriber::GetStats() const {
+  std::lock_guard<std::mutex> lock( m_pState->mutex );
+  return m_pState->stats;
+}
+
+void Subscriber::State::Received( const std::string_view& svTopic, const std::string_view& svMessage, const Mqtt::fMessage_t& fMessage ) {
+
+  const bool bFrame(
+       ( c_nFrame <= svMessage.size() )
+    && ( c_svMagic == svMessage.substr( 0, c_svMagic.size() ) )
+    && ( c_chVersion == svMessage[ c_svMagic.size() ] ) );
+  if ( !bFrame ) {
+    fMessage( svTopic, svMessage ); // plain, or a later version
+    return;
+  }
+
+  const char chType( svMessage[ c_nFrame - 1 ] );
+  if ( 'P' == chType ) {
+    fMessage( svTopic, svMessage.substr( c_nFrame ) );
+    return;
+  }
+
+  const size_t ixBody( svMessage.find( '\n', c_nFrame ) );
+  if ( std::string_view::npos == ixBody ) {
+    fMessage( svTopic, svMessage );
+    return;
+  }
+  const std::string_view svHeader( svMessage.substr( c_nFrame, ixBody - c_nFrame ) );
+  const std::string_view svBody( svMessage.substr( ixBody + 1 ) );
+
+  if ( 'K' == chType ) {
+    uint64_t nSequence {};
+    if ( !Number( svHeader, nSequence ) ) {
+      fMessage( svTopic, svMessage );
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock( mutex );
+      Topic& topic( umapTopic[ std::string( svTopic ) ] );
+      if ( Parse( svBody, topic.vKeyframe ) ) topic.nKeyframe = nSequence;
+      else topic.nKeyframe = 0;
+      ++stats.nKeyframe;
+    }
+    fMessage( svTopic, svBody );
+    return;
+  }
+
+  if ( 'D' != chType ) {
+    fMessage( svTopic, svMessage );
+    return;
+  }
+
+  // delta: "<seq> <keyframe seq> <bytes>"
+  const size_t ixSpace1( svHeader.find( ' ' ) );
+  const size_t ixSpace2( ( std::string_view::npos == ixSpace1 ) ? ixSpace1 : svHeader.find( ' ', ixSpace1 + 1 ) );
+  uint64_t nKeyframe {};
+  uint64_t nChanged {};
+  if ( ( std::string_view::npos == ixSpace2 )
+    || !Number( svHeader.substr( ixSpace1 + 1, ixSpace2 - ixSpace1 - 1 ), nKeyframe )
+    || !Number( svHeader.substr( ixSpace2 + 1 ), nChanged )
+    || ( svBody.size() < nChanged )
+  ) {
+    fMessage( svTopic, svMessage );
+    return;
+  }
+
+  const std::string_view svChanged( svBody.substr( 0, nChanged ) );
+  const std::string_view svRemoved( svBody.substr( nChanged ) );
+
+  std::string sRebuilt;
+  bool bRequest( false );
+  {
+    std::lock_guard<std::mutex> lock( mutex );
+    Topic& topic( umapTopic[ std::string( svTopic ) ] );
+    if ( ( nKeyframe != topic.nKeyframe ) || !Parse( svChanged, vDelta ) ) {
+      ++stats.nDropped;
+      const clock_t_::time_point tpNow( clock_t_::now() );
+      if ( ( tpNow - topic.tpRequested ) >= config.retry ) {
+        topic.tpRequested = tpNow;
+        ++stats.nRequest;
+        bRequest = true;
+      }
+    }
+    else {
+      ++stats.nDelta;
+      sRebuilt.reserve( svBody.size() + 64 * topic.vKeyframe.size() );
+      vField_t vField;
+      vField.reserve( topic.vKeyframe.size() + vDelta.size() );
+      for ( const Field& field: topic.vKeyframe ) {
+        if ( Contains( svRemoved, field.first ) ) continue;
+        const Field* pChanged( Lookup( vDelta, field.first ) );
+        vField.emplace_back( nullptr == pChanged ? field : *pChanged );
+      }
+      for ( const Field& field: vDelta ) {
+        if ( nullptr == Lookup( topic.vKeyframe, field.first ) ) vField.emplace_back( field );
+      }
+      Serialize( vField, sRebuilt );
+    }
+  }
+
+  if ( bRequest ) {
+    mqtt.Publish( config.sRequestTopic, std::string( svTopic ), c_nQoS, []( bool, int ){} );
+  }
+  if ( !sRebuilt.empty() ) fMessage( svTopic, sRebuilt );
+}
+
+} // namespace delta
+} // namespace mqtt
+} // namespace ou
@@ -0,0 +1,163 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+ * File:    delta.hpp
+ * Project: Repertory/MQTT
+ * Author:  raymond@burkholder.net
+ * Created: October 19, 2026 17:22:15
+ */
+
+// opt in delta encoding of json object payloads, top level fields are compared as text
+//
+//   frames open with "\0OUD" and a version, "1", then a type:
+//   keyframe: "\0OUD1K<seq>\n<document>"
+//   delta:    "\0OUD1D<seq> <keyframe seq> <bytes>\n<object of changed and added fields>[<array of removed keys>]",
+//             <bytes> the length of the object, so no value text is mistaken for a separator
+//   plain:    "\0OUD1P<payload>", only for a payload which itself opens with "\0OUD"
+//
+//   deltas are against the last keyframe, not the previous delta, so a lost delta costs nothing,
+//   a delta naming a keyframe the subscriber does not hold triggers a keyframe request:
+//   the topic is published to the request topic, and the publisher answers with a keyframe
+//
+//   payloads which are not json objects pass through unchanged in both directions,
+//   a payload published around the Publisher is taken as plain unless it opens with "\0OUD"
+
+#pragma once
+
+#include <mutex>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+
+#include "mqtt.hpp"
+
+namespace ou {
+namespace mqtt {
+namespace delta {
+
+using Field = std::pair<std::string, std::string>; // raw key (quoted), raw value
+using vField_t = std::vector<Field>;
+
+// top level fields of a json object, false when not an object
+bool Parse( const std::string_view& svDocument, vField_t& );
+
+const char c_szRequestTopic[] = "$delta/keyframe";
+
+class Publisher {
+public:
+
+  struct Config {
+    size_t nDeltaPerKeyframe;  // a keyframe after this many deltas
+    std::string sRequestTopic; // keyframe requests, shared by all publishers and subscribers
+    Config(): nDeltaPerKeyframe( 30 ), sRequestTopic( c_szRequestTopic ) {}
+  };
+
+  Publisher( Mqtt&, const Config& = Config() );
+  ~Publisher();
+
+  // as Mqtt::Publish, the document goes out as a keyframe or a delta, whichever is due and smaller
+  void Publish( const std::string_view& svTopic, const std::string_view& svDocument, Mqtt::fPublishComplete_t&& );
+
+protected:
+private:
+
+  struct Topic {
+    uint64_t nSequence;
+    uint64_t nKeyframe; // sequence of the last keyframe
+    size_t nDelta;      // since the keyframe
+    vField_t vKeyframe;
+    std::string sDocument; // latest, answers a keyframe request
+    Topic(): nSequence {}, nKeyframe {}, nDelta {} {}
+  };
+  using umapTopic_t = std::unordered_map<std::string, Topic>;
+
+  // shared with the request handler registered in Mqtt
+  struct State {
+    Mqtt& mqtt;
+    const Config config;
+    std::mutex mutex;
+    umapTopic_t umapTopic;
+    vField_t vParsed; // scratch, under mutex
+    State( Mqtt& mqtt_, const Config& config_ ): mqtt( mqtt_ ), config( config_ ) {}
+    void Requested( const std::string_view& svTopic );
+  };
+  using pState_t = std::shared_ptr<State>;
+  pState_t m_pState;
+
+  static void Keyframe( Topic&, const std::string_view& svDocument, std::string& sPayload );
+
+};
+
+class Subscriber {
+public:
+
+  struct Config {
+    std::string sRequestTopic;
+    std::chrono::milliseconds retry; // between keyframe requests for one topic
+    Config(): sRequestTopic( c_szRequestTopic ), retry( 1000 ) {}
+  };
+
+  Subscriber( Mqtt&, const Config& = Config() );
+  ~Subscriber();
+
+  // as Mqtt::Subscribe, fMessage_t receives full documents
+  void Subscribe( const std::string& sFilter, Mqtt::fMessage_t&& );
+  void UnSubscribe( const std::string& sFilter );
+
+  struct Stats {
+    uint64_t nKeyframe;
+    uint64_t nDelta;
+    uint64_t nRequest; // keyframe requests sent
+    uint64_t nDropped; // deltas which could not be applied
+  };
+  Stats GetStats() const;
+
+protected:
+private:
+
+  using clock_t_ = std::chrono::steady_clock;
+
+  struct Topic {
+    uint64_t nKeyframe; // 0: none held
+    vField_t vKeyframe;
+    clock_t_::time_point tpRequested;
+    Topic(): nKeyframe {} {}
+  };
+  using umapTopic_t = std::unordered_map<std::string, Topic>;
+
+  struct State {
+    Mqtt& mqtt;
+    const Config config;
+    mutable std::mutex mutex;
+    umapTopic_t umapTopic;
+    vField_t vDelta; // scratch, under mutex
+    Stats stats;
+    State( Mqtt& mqtt_, const Config& config_ ): mqtt( mqtt_ ), config( config_ ), stats {} {}
+    void Received( const std::string_view& svTopic, const std::string_view& svMessage, const Mqtt::fMessage_t& );
+  };
+  using pState_t = std::shared_ptr<State>;
+  pState_t m_pState;
+
+  std::vector<std::string> m_vFilter;
+
+};
+
+} // namespace delta
+} // namespace mqtt
+} // namespace ou
@@ -0,0 +1,187 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+  File:    downsample.cpp
+  Project: Repertory/MQTT
+  Author:  raymond@burkholder.net
+  Created: October 19, 2026 16:31:05
+*/
+
+#include <cmath>
+#include <cassert>
+#include <charconv>
+
+#include <thread.hpp>
+
+#include "hash.hpp"
+#include "downsample.hpp"
+
+namespace {
+
+void Append( std::string& s, double value ) {
+  char buf[ 32 ];
+  const std::to_chars_result result = std::to_chars( buf, buf + sizeof( buf ), value );
+  s.append( buf, result.ptr );
+}
+
+} // namespace anonymous
+
+namespace ou {
+namespace mqtt {
+
+Downsample::Downsample( Mqtt& mqtt, const Config& config )
+: m_mqtt( mqtt ), m_config( config )
+, m_nSlot( config.vTopic.size() )
+, m_bRunning( true )
+{
+  assert( std::chrono::milliseconds::zero() < m_config.window );
+
+  m_rSlot.reset( new Slot[ m_nSlot ] );
+
+  size_t nIndex( 16 );
+  while ( nIndex < 2 * m_nSlot ) nIndex *= 2;
+  m_vIndex.resize( nIndex, 0 );
+  m_maskIndex = nIndex - 1;
+
+  for ( size_t ix = 0; ix < m_nSlot; ++ix ) {
+    Slot& slot( m_rSlot[ ix ] );
+    slot.sTopic = m_config.vTopic[ ix ];
+    slot.sSummaryTopic = slot.sTopic + m_config.sSuffix;
+    slot.sPayload.reserve( 160 );
+    assert( nullptr == Find( slot.sTopic ) ); // duplicate topic
+    size_t ixIndex( Hash( slot.sTopic ) & m_maskIndex );
+    while ( 0 != m_vIndex[ ixIndex ] ) ixIndex = ( ixIndex + 1 ) & m_maskIndex;
+    m_vIndex[ ixIndex ] = ix + 1;
+  }
+
+  m_threadWindow = std::move( std::thread(
+    [this](){
+      ou::thread::Enter( "mqtt.downsample" );
+      clock_t_::time_point tpBoundary( clock_t_::now() );
+      std::unique_lock<std::mutex> lock( m_mutex );
+      while ( m_bRunning ) {
+        tpBoundary += m_config.window; // fixed cadence, no drift from the time spent publishing
+        if ( !m_cv.wait_until( lock, tpBoundary, [this]{ return !m_bRunning; } ) ) {
+          lock.unlock();
+          Flush( std::chrono::system_clock::now() );
+          lock.lock();
+        }
+      }
+    } ) );
+}
+
+Downsample::~Downsample() {
+  {
+    std::lock_guard<std::mutex> lock( m_mutex );
+    m_bRunning = false;
+  }
+  m_cv.notify_one();
+  if ( m_threadWindow.joinable() ) m_threadWindow.join();
+  Flush( std::chrono::system_clock::now() );
+}
+
+Downsample::Slot* Downsample::Find( const std::string_view& svTopic ) {
+  size_t ixIndex( Hash( svTopic ) & m_maskIndex );
+  while ( true ) {
+    const uint32_t ixSlot( m_vIndex[ ixIndex ] );
+    if ( 0 == ixSlot ) return nullptr;
+    Slot& slot( m_rSlot[ ixSlot - 1 ] );
+    if ( svTopic == slot.sTopic ) return &slot;
+    ixIndex = ( ixIndex + 1 ) & m_maskIndex;
+  }
+}
+
+void Downsample::Fold( Slot& slot, double value ) {
+  slot.Lock();
+  if ( 0 == slot.nCount ) {
+    slot.dblMin = slot.dblMax = slot.dblSum = value;
+  }
+  else {
+    if ( value < slot.dblMin ) slot.dblMin = value;
+    if ( value > slot.dblMax ) slot.dblMax = value;
+    slot.dblSum += value;
+  }
+  slot.dblLast = value;
+  ++slot.nCount;
+  slot.Unlock();
+}
+
+bool Downsample::Sample( const std::string_view& svTopic, double value ) {
+  Slot* pSlot( Find( svTopic ) );
+  if ( nullptr == pSlot ) return false;
+  Fold( *pSlot, value );
+  return true;
+}
+
+void Downsample::Publish( const std::string_view& svTopic, const std::string_view& svMessage, Mqtt::fPublishComplete_t&& fPublishComplete ) {
+
+  Slot* pSlot( Find( svTopic ) );
+  if ( nullptr == pSlot ) {
+    m_mqtt.Publish( svTopic, svMessage, std::move( fPublishComplete ) );
+    return;
+  }
+
+  std::string_view sv( svMessage );
+  while ( !sv.empty() && ( ' ' == sv.front() ) ) sv.remove_prefix( 1 );
+  while ( !sv.empty() && ( ( ' ' == sv.back() ) || ( '\n' == sv.back() ) ) ) sv.remove_suffix( 1 );
+
+  double value {};
+  const char* end( sv.data() + sv.size() );
+  const std::from_chars_result conversion = std::from_chars( sv.data(), end, value );
+  if ( ( std::errc() != conversion.ec ) || ( end != conversion.ptr ) || !std::isfinite( value ) ) {
+    fPublishComplete( false, result::failure );
+    return;
+  }
+
+  Fold( *pSlot, value );
+  fPublishComplete( true, result::success );
+}
+
+void Downsample::Flush( std::chrono::system_clock::time_point tpNow ) {
+
+  const std::string sTimeStamp(
+    std::to_string( std::chrono::duration_cast<std::chrono::milliseconds>( tpNow.time_since_epoch() ).count() ) );
+
+  for ( size_t ix = 0; ix < m_nSlot; ++ix ) {
+
+    Slot& slot( m_rSlot[ ix ] );
+
+    slot.Lock();
+    const uint64_t nCount( slot.nCount );
+    const double dblMin( slot.dblMin );
+    const double dblMax( slot.dblMax );
+    const double dblSum( slot.dblSum );
+    const double dblLast( slot.dblLast );
+    slot.nCount = 0;
+    slot.Unlock();
+
+    if ( 0 == nCount ) continue;
+
+    std::string& s( slot.sPayload );
+    s.clear();
+    s += "{\"min\":";    Append( s, dblMin );
+    s += ",\"max\":";    Append( s, dblMax );
+    s += ",\"mean\":";   Append( s, dblSum / nCount );
+    s += ",\"last\":";   Append( s, dblLast );
+    s += ",\"count\":";  s += std::to_string( nCount );
+    s += ",\"ts\":";     s += sTimeStamp;
+    s += '}';
+
+    m_mqtt.Publish( slot.sSummaryTopic, s, m_config.nQoS, []( bool, int ){} );
+  }
+}
+
+} // namespace mqtt
+} // namespace ou
@@ -0,0 +1,116 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+ * File:    downsample.hpp
+ * Project: Repertory/MQTT
+ * Author:  raymond@burkholder.net
+ * Created: October 19, 2026 16:31:05
+ */
+
+// publisher side tumbling window summaries, for producers sampling faster than consumers need
+//
+//   Publish() on a configured topic folds the numeric payload into that topic's slot,
+//   other topics pass straight through to Mqtt::Publish,
+//   at the end of each window a summary is published for every slot which saw a sample:
+//     {"min":..,"max":..,"mean":..,"last":..,"count":..,"ts":<window end, ms since epoch>}
+//
+//   slots are allocated at construction, a sample takes a per slot spin lock and does not allocate
+
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <string_view>
+#include <condition_variable>
+
+#include "mqtt.hpp"
+
+namespace ou {
+namespace mqtt {
+
+class Downsample {
+public:
+
+  struct Config {
+    std::vector<std::string> vTopic; // exact topics to summarise
+    std::chrono::milliseconds window;
+    std::string sSuffix;             // summary topic is topic + suffix
+    int nQoS;
+    Config()
+    : window( 1000 ), sSuffix( "/summary" ), nQoS( 0 ) // each summary supersedes the last
+    {}
+  };
+
+  Downsample( Mqtt&, const Config& );
+  ~Downsample(); // the partial window is published
+
+  // configured topic: ( true, 0 ) once folded in, ( false, result::failure ) when the payload is not a finite number
+  //   otherwise as Mqtt::Publish
+  void Publish( const std::string_view& svTopic, const std::string_view& svMessage, Mqtt::fPublishComplete_t&& );
+
+  // for producers holding the number, false when the topic is not configured
+  bool Sample( const std::string_view& svTopic, double value );
+
+protected:
+private:
+
+  using clock_t_ = std::chrono::steady_clock;
+
+  struct alignas( 64 ) Slot {
+
+    std::atomic_flag flag; // spin lock, held for a handful of instructions
+    double dblMin;
+    double dblMax;
+    double dblSum;
+    double dblLast;
+    uint64_t nCount;
+
+    std::string sTopic;
+    std::string sSummaryTopic;
+    std::string sPayload; // reused, by the window thread only
+
+    Slot(): dblMin {}, dblMax {}, dblSum {}, dblLast {}, nCount {} { flag.clear(); }
+
+    void Lock() { while ( flag.test_and_set( std::memory_order_acquire ) ) {} }
+    void Unlock() { flag.clear( std::memory_order_release ); }
+  };
+
+  Mqtt& m_mqtt;
+  const Config m_config;
+
+  std::unique_ptr<Slot[]> m_rSlot;
+  size_t m_nSlot;
+
+  std::vector<uint32_t> m_vIndex; // open addressed, slot + 1, 0 is empty, fixed after construction
+  size_t m_maskIndex;
+
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  bool m_bRunning;
+  std::thread m_threadWindow;
+
+  Slot* Find( const std::string_view& svTopic );
+  static void Fold( Slot&, double );
+  void Flush( std::chrono::system_clock::time_point );
+
+};
+
+} // namespace mqtt
+} // namespace ou
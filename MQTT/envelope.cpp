@@ -0,0 +1,97 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+  File:    envelope.cpp
+  Project: Repertory/MQTT
+  Author:  raymond@burkholder.net
+  Created: October 19, 2026 21:10:05
+*/
+
+#include "varint.hpp"
+#include "envelope.hpp"
+
+namespace ou {
+namespace mqtt {
+namespace envelope {
+
+std::string Topic( const std::string_view& svBase ) {
+  std::string sTopic( svBase );
+  sTopic += '/';
+  sTopic += c_szLevel;
+  return sTopic;
+}
+
+std::string_view Base( const std::string_view& svTopic ) {
+  const size_t nLevel( sizeof( c_szLevel ) - 1 );
+  if ( ( nLevel + 1 ) >= svTopic.size() ) return std::string_view();
+  const size_t ixSlash( svTopic.size() - nLevel - 1 );
+  if ( ( '/' != svTopic[ ixSlash ] ) || ( c_szLevel != svTopic.substr( ixSlash + 1 ) ) ) return std::string_view();
+  return svTopic.substr( 0, ixSlash );
+}
+
+// ==== Writer
+
+void Writer::Clear() {
+  m_sBuffer.assign( c_szMagic, c_nMagic );
+  m_nRecord = 0;
+}
+
+void Writer::Append( const std::string_view& svSuffix, const std::string_view& svPayload ) {
+  PutVarint( m_sBuffer, svSuffix.size() );
+  m_sBuffer.append( svSuffix.data(), svSuffix.size() );
+  PutVarint( m_sBuffer, svPayload.size() );
+  m_sBuffer.append( svPayload.data(), svPayload.size() );
+  ++m_nRecord;
+}
+
+size_t Writer::Overhead( size_t nSuffix, size_t nPayload ) {
+  return VarintSize( nSuffix ) + VarintSize( nPayload );
+}
+
+// ==== Reader
+
+Reader::Reader( const std::string_view& svEnvelope )
+: m_sv( svEnvelope )
+, m_bValid( ( c_nMagic <= svEnvelope.size() ) && ( std::string_view( c_szMagic, c_nMagic ) == svEnvelope.substr( 0, c_nMagic ) ) )
+{
+  if ( m_bValid ) m_sv.remove_prefix( c_nMagic );
+}
+
+bool Reader::Varint( uint64_t& value ) {
+  const char* p( m_sv.data() );
+  const bool bOk( GetVarint( p, m_sv.data() + m_sv.size(), value ) );
+  m_sv.remove_prefix( p - m_sv.data() );
+  return bOk;
+}
+
+bool Reader::Next( std::string_view& svSuffix, std::string_view& svPayload ) {
+  if ( !m_bValid || m_sv.empty() ) return false;
+  uint64_t n;
+  if ( Varint( n ) && ( n <= m_sv.size() ) ) {
+    svSuffix = m_sv.substr( 0, n );
+    m_sv.remove_prefix( n );
+    if ( Varint( n ) && ( n <= m_sv.size() ) ) {
+      svPayload = m_sv.substr( 0, n );
+      m_sv.remove_prefix( n );
+      return true;
+    }
+  }
+  m_bValid = false;
+  return false;
+}
+
+} // namespace envelope
+} // namespace mqtt
+} // namespace ou
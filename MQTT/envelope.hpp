@@ -0,0 +1,86 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+ * File:    envelope.hpp
+ * Project: Repertory/MQTT
+ * Author:  raymond@burkholder.net
+ * Created: October 19, 2026 21:10:05
+ */
+
+// multi-record envelopes, many small ( topic suffix, payload ) records in one publish
+//
+//   topic:   <base>/$batch, each record's topic is <base>/<suffix>
+//            '$' only marks system topics in the first level, so <base>/# subscribers receive envelopes too
+//   payload: "OUB" version(1), then per record: varint suffix length, suffix, varint payload length, payload
+
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <string_view>
+
+namespace ou {
+namespace mqtt {
+namespace envelope {
+
+const char c_szLevel[] = "$batch";
+const char c_szMagic[] = "OUB\x01";
+const size_t c_nMagic = 4;
+
+std::string Topic( const std::string_view& svBase ); // <base>/$batch
+
+// the base of a batch topic, empty when svTopic is not one
+std::string_view Base( const std::string_view& svTopic );
+
+class Writer {
+public:
+
+  Writer(): m_nRecord {} { Clear(); }
+
+  void Clear(); // keeps the capacity
+  void Append( const std::string_view& svSuffix, const std::string_view& svPayload );
+
+  size_t Records() const { return m_nRecord; }
+  size_t Size() const { return m_sBuffer.size(); }
+  static size_t Overhead( size_t nSuffix, size_t nPayload ); // bytes added by Append, beyond the suffix and payload
+
+  operator std::string_view() const { return m_sBuffer; }
+
+protected:
+private:
+  std::string m_sBuffer;
+  size_t m_nRecord;
+};
+
+// walks the records in place, the views point into the envelope
+class Reader {
+public:
+
+  explicit Reader( const std::string_view& svEnvelope ); // Valid false when the magic does not match
+
+  bool Valid() const { return m_bValid; }
+  // false at the end, or on a truncated record, which clears Valid
+  bool Next( std::string_view& svSuffix, std::string_view& svPayload );
+
+protected:
+private:
+  std::string_view m_sv; // remaining
+  bool m_bValid;
+  bool Varint( uint64_t& );
+};
+
+} // namespace envelope
+} // namespace mqtt
+} // namespace ou
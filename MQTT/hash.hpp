@@ -0,0 +1,42 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+ * File:    hash.hpp
+ * Project: Repertory/MQTT
+ * Author:  raymond@burkholder.net
+ * Created: October 21, 2026 10:05:12
+ */
+
+// topic hashing for the open addressed indexes inside the library, not installed
+
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace ou {
+namespace mqtt {
+
+inline uint64_t Hash( const std::string_view& sv ) { // fnv-1a
+  uint64_t hash( 14695981039346656037ull );
+  for ( const char ch: sv ) {
+    hash ^= static_cast<uint8_t>( ch );
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+} // namespace mqtt
+} // namespace ou
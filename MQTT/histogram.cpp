@@ -0,0 +1,81 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+  File:    histogram.cpp
+  Project: Repertory/MQTT
+  Author:  raymond@burkholder.net
+  Created: October 19, 2026 20:02:31
+*/
+
+#include <sstream>
+
+#include "histogram.hpp"
+
+namespace ou {
+namespace mqtt {
+
+void Histogram::Add( std::chrono::microseconds us ) {
+  uint64_t n( 0 < us.count() ? us.count() : 0 );
+  size_t ixBucket {};
+  while ( ( 0 != n ) && ( ( c_nBucket - 1 ) > ixBucket ) ) {
+    n >>= 1;
+    ++ixBucket;
+  }
+  rBucket[ ixBucket ].fetch_add( 1, std::memory_order_relaxed );
+}
+
+Histogram::Snapshot Histogram::Take() const {
+
+  std::array<uint64_t, c_nBucket> rCount;
+  uint64_t nCount {};
+  for ( size_t ix = 0; ix < c_nBucket; ++ix ) {
+    rCount[ ix ] = rBucket[ ix ].load( std::memory_order_relaxed );
+    nCount += rCount[ ix ];
+  }
+
+  auto bound = []( size_t ixBucket )->uint64_t { return 0 == ixBucket ? 0 : ( uint64_t( 1 ) << ixBucket ) - 1; };
+
+  auto percentile = [&]( double p )->uint64_t {
+    if ( 0 == nCount ) return 0;
+    const uint64_t nRank( static_cast<uint64_t>( p * ( nCount - 1 ) ) + 1 );
+    uint64_t nSum {};
+    for ( size_t ix = 0; ix < c_nBucket; ++ix ) {
+      nSum += rCount[ ix ];
+      if ( nRank <= nSum ) return bound( ix );
+    }
+    return bound( c_nBucket - 1 );
+  };
+
+  uint64_t nMax {};
+  for ( size_t ix = 0; ix < c_nBucket; ++ix ) {
+    if ( 0 != rCount[ ix ] ) nMax = bound( ix );
+  }
+
+  return Snapshot{ nCount, percentile( 0.50 ), percentile( 0.90 ), percentile( 0.99 ), nMax };
+}
+
+std::string Histogram::Snapshot::Json() const {
+  std::stringstream ss;
+  ss << "{\"count\":" << nCount
+     << ",\"p50_us\":" << p50_us
+     << ",\"p90_us\":" << p90_us
+     << ",\"p99_us\":" << p99_us
+     << ",\"max_us\":" << max_us
+     << '}';
+  return ss.str();
+}
+
+} // namespace mqtt
+} // namespace ou
@@ -0,0 +1,57 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+ * File:    histogram.hpp
+ * Project: Repertory/MQTT
+ * Author:  raymond@burkholder.net
+ * Created: October 19, 2026 20:02:31
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <cstdint>
+
+namespace ou {
+namespace mqtt {
+
+// microsecond latencies in power of two buckets, relaxed atomics, written by the completing thread
+struct Histogram {
+
+  static const size_t c_nBucket = 32; // bucket n holds [ 2^(n-1), 2^n ) us, bucket 0 holds 0
+
+  std::array<std::atomic<uint64_t>, c_nBucket> rBucket;
+
+  Histogram() { for ( std::atomic<uint64_t>& bucket: rBucket ) bucket.store( 0, std::memory_order_relaxed ); }
+
+  void Add( std::chrono::microseconds );
+
+  struct Snapshot {
+    uint64_t nCount;
+    uint64_t p50_us; // upper bound of the bucket holding the percentile
+    uint64_t p90_us;
+    uint64_t p99_us;
+    uint64_t max_us;
+    std::string Json() const;
+  };
+  Snapshot Take() const;
+
+};
+
+} // namespace mqtt
+} // namespace ou
@@ -0,0 +1,224 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+  File:    lanes.cpp
+  Project: Repertory/MQTT
+  Author:  raymond@burkholder.net
+  Created: October 19, 2026 20:02:31
+*/
+
+#include <cassert>
+#include <algorithm>
+
+#include <thread.hpp>
+
+#include "lanes.hpp"
+
+namespace ou {
+namespace mqtt {
+
+bool Lanes::State::Ready( size_t ixLane ) const {
+  const Queue& queue( rQueue[ ixLane ] );
+  return !queue.pending.empty() && ( queue.nInFlight < queue.lane.nInFlight );
+}
+
+size_t Lanes::State::Next() {
+
+  size_t ixNext( c_nLane );
+  for ( size_t ix = 0; ix < c_nLane; ++ix ) { // a starved lane first
+    const Queue& queue( rQueue[ ix ] );
+    if ( Ready( ix ) && ( 0 != queue.lane.nStarve ) && ( queue.lane.nStarve <= queue.nPassed ) ) {
+      ixNext = ix;
+      break;
+    }
+  }
+  if ( c_nLane == ixNext ) { // then strict priority
+    for ( size_t ix = 0; ix < c_nLane; ++ix ) {
+      if ( Ready( ix ) ) {
+        ixNext = ix;
+        break;
+      }
+    }
+  }
+  if ( c_nLane != ixNext ) {
+    for ( size_t ix = 0; ix < c_nLane; ++ix ) {
+      Queue& queue( rQueue[ ix ] );
+      if ( ixNext == ix ) queue.nPassed = 0;
+      else if ( Ready( ix ) ) ++queue.nPassed;
+    }
+  }
+  return ixNext;
+}
+
+Mqtt::deadline_t Lanes::State::Expire( Mqtt::deadline_t now, vMessage_t& vExpired ) {
+  Mqtt::deadline_t next( Mqtt::deadline_t::max() );
+  for ( Queue& queue: rQueue ) {
+    queue.nExpired += queue.pending.Expire( now, [&vExpired]( Message&& message ){ vExpired.emplace_back( std::move( message ) ); } );
+    next = std::min( next, queue.pending.Earliest() );
+  }
+  return next;
+}
+
+Lanes::Lanes( Mqtt& mqtt, const Config& config )
+: m_pState( std::make_shared<State>() )
+, m_mqtt( mqtt )
+, m_idObserver {}
+{
+  for ( size_t ix = 0; ix < c_nLane; ++ix ) {
+    assert( 0 < config.rLane[ ix ].nInFlight );
+    m_pState->rQueue[ ix ].lane = config.rLane[ ix ];
+  }
+
+  pState_t pState( m_pState );
+  m_idObserver = m_mqtt.AddObserver(
+    [pState]( Mqtt::EConnection connection ){
+      {
+        std::lock_guard<std::mutex> lock( pState->mutex );
+        pState->bConnected = ( Mqtt::EConnection::connected == connection );
+      }
+      pState->cv.notify_one();
+    } );
+
+  m_threadSender = std::thread( [this](){ ou::thread::Enter( "mqtt.lanes" ); Sender(); } );
+}
+
+Lanes::~Lanes() {
+
+  m_mqtt.RemoveObserver( m_idObserver );
+  {
+    std::lock_guard<std::mutex> lock( m_pState->mutex );
+    m_pState->bRunning = false;
+  }
+  m_pState->cv.notify_one();
+  if ( m_threadSender.joinable() ) m_threadSender.join();
+
+  vMessage_t vMessage;
+  {
+    std::lock_guard<std::mutex> lock( m_pState->mutex );
+    for ( Queue& queue: m_pState->rQueue ) {
+      queue.pending.Take( [&vMessage]( Message&& message ){ vMessage.emplace_back( std::move( message ) ); } );
+    }
+  }
+  for ( Message& message: vMessage ) {
+    message.fPublishComplete( false, result::disconnected );
+  }
+}
+
+void Lanes::Publish( EPriority ePriority, const std::string_view& svTopic, const std::string_view& svMessage, int nQoS, Mqtt::fPublishComplete_t&& fPublishComplete ) {
+  Publish( ePriority, svTopic, svMessage, nQoS, Mqtt::deadline_t::max(), std::move( fPublishComplete ) );
+}
+
+void Lanes::Publish( EPriority ePriority, const std::string_view& svTopic, const std::string_view& svMessage, int nQoS, Mqtt::deadline_t deadline, Mqtt::fPublishComplete_t&& fPublishComplete ) {
+
+  const size_t ixLane( static_cast<size_t>( ePriority ) );
+  assert( c_nLane > ixLane );
+
+  const clock_t_::time_point now( clock_t_::now() );
+  if ( deadline <= now ) {
+    {
+      std::lock_guard<std::mutex> lock( m_pState->mutex );
+      ++m_pState->rQueue[ ixLane ].nExpired;
+    }
+    fPublishComplete( false, result::expired );
+    return;
+  }
+
+  bool bQueued( false );
+  vMessage_t vExpired;
+  {
+    std::lock_guard<std::mutex> lock( m_pState->mutex );
+    Queue& queue( m_pState->rQueue[ ixLane ] );
+    if ( queue.lane.nCapacity <= queue.pending.size() ) { // full, make room from expired messages
+      m_pState->Expire( now, vExpired );
+    }
+    if ( queue.lane.nCapacity > queue.pending.size() ) {
+      bQueued = true;
+      queue.pending.push_back(
+        Message{ std::string( svTopic ), std::string( svMessage ), nQoS, std::move( fPublishComplete ), now, deadline } );
+      ++queue.nQueued;
+    }
+    else {
+      ++queue.nRejected;
+    }
+  }
+  for ( Message& message: vExpired ) message.fPublishComplete( false, result::expired );
+  if ( bQueued ) m_pState->cv.notify_one();
+  else fPublishComplete( false, result::max_inflight );
+}
+
+void Lanes::Sender() {
+
+  State& state( *m_pState );
+  std::unique_lock<std::mutex> lock( state.mutex );
+
+  vMessage_t vExpired;
+
+  while ( state.bRunning ) {
+
+    const Mqtt::deadline_t next( state.Expire( clock_t_::now(), vExpired ) );
+    if ( !vExpired.empty() ) {
+      lock.unlock();
+      for ( Message& message: vExpired ) message.fPublishComplete( false, result::expired );
+      vExpired.clear();
+      lock.lock();
+      continue;
+    }
+
+    const size_t ixLane( state.bConnected ? state.Next() : c_nLane );
+    if ( c_nLane == ixLane ) {
+      if ( Mqtt::deadline_t::max() == next ) state.cv.wait( lock );
+      else state.cv.wait_until( lock, next );
+      continue;
+    }
+
+    Queue& queue( state.rQueue[ ixLane ] );
+    Message message( std::move( queue.pending.front() ) );
+    queue.pending.pop_front();
+    ++queue.nInFlight;
+    ++queue.nSent;
+
+    lock.unlock(); // a completion may run inline
+
+    pState_t pState( m_pState );
+    m_mqtt.Publish(
+      message.sTopic, message.sMessage, message.nQoS,
+      [pState,ixLane,tpQueued=message.tpQueued,fPublishComplete=std::move( message.fPublishComplete )]( bool bOk, int rc ){
+        Queue& queue( pState->rQueue[ ixLane ] );
+        queue.histogram.Add( std::chrono::duration_cast<std::chrono::microseconds>( clock_t_::now() - tpQueued ) );
+        if ( !bOk ) queue.nFailed.fetch_add( 1, std::memory_order_relaxed );
+        {
+          std::lock_guard<std::mutex> lock( pState->mutex );
+          --queue.nInFlight;
+        }
+        pState->cv.notify_one();
+        fPublishComplete( bOk, rc );
+      } );
+
+    lock.lock();
+  }
+}
+
+Lanes::Stats Lanes::GetStats( EPriority ePriority ) const {
+  const size_t ixLane( static_cast<size_t>( ePriority ) );
+  assert( c_nLane > ixLane );
+  std::lock_guard<std::mutex> lock( m_pState->mutex );
+  const Queue& queue( m_pState->rQueue[ ixLane ] );
+  return Stats{
+    queue.nQueued, queue.nRejected, queue.nSent, queue.nFailed.load( std::memory_order_relaxed ),
+    queue.nExpired, queue.pending.size(), queue.histogram.Take() };
+}
+
+} // namespace mqtt
+} // namespace ou
@@ -0,0 +1,152 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+ * File:    lanes.hpp
+ * Project: Repertory/MQTT
+ * Author:  raymond@burkholder.net
+ * Created: October 19, 2026 20:02:31
+ */
+
+// priority publish lanes in front of Mqtt::Publish, so alarms overtake bulk telemetry
+//
+//   each priority has its own queue and in-flight quota (publishes handed to Mqtt, not yet completed),
+//   a sender thread takes the highest priority lane with a message and room in its quota,
+//   except that a waiting lane passed over nStarve times in a row is served once, ahead of the others
+//
+//   while disconnected the queues hold, and drain in priority order on reconnect
+//   a message past its deadline is taken from its queue, wherever it sits, and completes with ( false, result::expired ),
+//     each queue keeps its deadlines in a heap (deadline_queue.hpp) and the sender wakes for the earliest,
+//     so a stale backlog after a reconnect is discarded without delaying fresh data,
+//     and a full lane reclaims expired slots before rejecting
+//   latency, Publish to completion (qos 1 ack, qos 0 hand off), is kept per lane in a log2 histogram
+
+#pragma once
+
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <string_view>
+#include <condition_variable>
+
+#include "mqtt.hpp"
+#include "histogram.hpp"
+#include "deadline_queue.hpp"
+
+namespace ou {
+namespace mqtt {
+
+class Lanes {
+public:
+
+  enum class EPriority { critical, high, normal, bulk };
+  static const size_t c_nLane = 4;
+
+  struct Lane {
+    size_t nCapacity; // queued messages, Publish beyond this completes with ( false, result::max_inflight )
+    size_t nInFlight; // quota handed to Mqtt at once
+    size_t nStarve;   // served once after being passed over this many times, 0 is never (strict)
+  };
+
+  struct Config {
+    std::array<Lane, c_nLane> rLane;
+    Config()
+    : rLane{ {
+        { 1024, 64, 0 }     // critical
+      , { 4096, 32, 64 }    // high
+      , { 16384, 16, 256 }  // normal
+      , { 65536, 8, 1024 }  // bulk
+      } }
+    {}
+  };
+
+  Lanes( Mqtt&, const Config& = Config() );
+  ~Lanes(); // queued messages complete with ( false, result::disconnected ), in-flight ones complete as usual
+
+  // as Mqtt::Publish, topic and message are copied
+  void Publish( EPriority, const std::string_view& svTopic, const std::string_view& svMessage, int nQoS, Mqtt::fPublishComplete_t&& );
+  void Publish( EPriority, const std::string_view& svTopic, const std::string_view& svMessage, int nQoS, Mqtt::deadline_t, Mqtt::fPublishComplete_t&& );
+
+  struct Stats {
+    uint64_t nQueued;   // accepted into the lane
+    uint64_t nRejected; // lane full
+    uint64_t nSent;     // handed to Mqtt
+    uint64_t nFailed;   // completed with an error
+    uint64_t nExpired;  // deadline passed while queued
+    size_t nDepth;      // queued now
+    Histogram::Snapshot latency;
+  };
+  Stats GetStats( EPriority ) const;
+
+protected:
+private:
+
+  using clock_t_ = std::chrono::steady_clock;
+
+  struct Message {
+    std::string sTopic;
+    std::string sMessage;
+    int nQoS;
+    Mqtt::fPublishComplete_t fPublishComplete;
+    clock_t_::time_point tpQueued;
+    Mqtt::deadline_t deadline;
+  };
+  using vMessage_t = std::vector<Message>;
+
+  struct Queue {
+    Lane lane;
+    DeadlineQueue<Message> pending;
+    size_t nInFlight;
+    size_t nPassed; // consecutive services of other lanes while this one waited
+    uint64_t nQueued;
+    uint64_t nRejected;
+    uint64_t nSent;
+    uint64_t nExpired;
+    std::atomic<uint64_t> nFailed;
+    Histogram histogram;
+    Queue(): nInFlight {}, nPassed {}, nQueued {}, nRejected {}, nSent {}, nExpired {}, nFailed {} {}
+  };
+
+  // shared with completions, which may arrive after destruction
+  struct State {
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+    bool bRunning;
+    bool bConnected;
+    std::array<Queue, c_nLane> rQueue;
+    State(): bRunning( true ), bConnected( false ) {}
+    bool Ready( size_t ixLane ) const; // under mutex
+    size_t Next(); // under mutex, c_nLane when nothing can be sent
+    // under mutex, moves expired messages to vExpired, returns the earliest remaining deadline
+    Mqtt::deadline_t Expire( Mqtt::deadline_t now, vMessage_t& vExpired );
+  };
+  using pState_t = std::shared_ptr<State>;
+  pState_t m_pState;
+
+  Mqtt& m_mqtt;
+  Mqtt::idObserver_t m_idObserver;
+  std::thread m_threadSender;
+
+  void Sender();
+
+};
+
+} // namespace mqtt
+} // namespace ou
@@ -0,0 +1,251 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+  File:    loopback.cpp
+  Project: Repertory/MQTT
+  Author:  raymond@burkholder.net
+  Created: October 19, 2026 10:41:52
+*/
+
+#include <cassert>
+#include <algorithm>
+
+#include <thread.hpp>
+
+#include "topic.hpp"
+#include "loopback.hpp"
+
+namespace ou {
+namespace mqtt {
+
+// class Loopback
+
+Loopback::Loopback()
+: m_bRunning( true )
+, m_sequence {}
+, m_idTransport {}
+, m_latency {}
+, m_dblLoss {}
+, m_distribution( 0.0, 1.0 )
+, m_pDispatching( nullptr )
+{
+  m_thread = std::move( std::thread( [this](){ ou::thread::Enter( "mqtt.loopback" ); Dispatch(); } ) );
+}
+
+Loopback::~Loopback() {
+  {
+    std::lock_guard<std::mutex> lock( m_mutex );
+    assert( m_vTransport.empty() );
+    m_bRunning = false;
+  }
+  m_cvEvent.notify_one();
+  if ( m_thread.joinable() ) m_thread.join();
+}
+
+void Loopback::SetLatency( std::chrono::microseconds latency ) {
+  std::lock_guard<std::mutex> lock( m_mutex );
+  m_latency = latency;
+}
+
+void Loopback::SetLoss( double probability ) {
+  assert( ( 0.0 <= probability ) && ( 1.0 >= probability ) );
+  std::lock_guard<std::mutex> lock( m_mutex );
+  m_dblLoss = probability;
+}
+
+void Loopback::Attach( TransportLoopback* pTransport ) {
+  std::lock_guard<std::mutex> lock( m_mutex );
+  if ( !pTransport->m_bConnected ) {
+    pTransport->m_id = ++m_idTransport;
+    pTransport->m_bConnected = true;
+    m_vTransport.push_back( pTransport );
+  }
+}
+
+void Loopback::Detach( TransportLoopback* pTransport ) {
+  std::unique_lock<std::mutex> lock( m_mutex );
+  vTransport_t::iterator iter = std::find( m_vTransport.begin(), m_vTransport.end(), pTransport );
+  if ( m_vTransport.end() != iter ) {
+    m_vTransport.erase( iter );
+    pTransport->m_bConnected = false;
+    pTransport->m_vFilter.clear(); // clean session
+  }
+  // queued events are skipped by id, but one may be in flight right now
+  if ( std::this_thread::get_id() != m_thread.get_id() ) {
+    m_cvDispatch.wait( lock, [this,pTransport]{ return pTransport != m_pDispatching; } );
+  }
+}
+
+int Loopback::Publish(
+  TransportLoopback* pFrom
+, const std::string_view& svTopic, const std::string_view& svMessage, int nQoS
+, Transport::token_t& token
+) {
+
+  std::lock_guard<std::mutex> lock( m_mutex );
+
+  if ( !pFrom->m_bConnected ) return result::disconnected;
+
+  token = ++pFrom->m_token;
+
+  if ( ( 0.0 < m_dblLoss ) && ( m_distribution( m_random ) < m_dblLoss ) ) {
+    return result::success; // lost in transit, the ack never arrives
+  }
+
+  const clock_t_::time_point due( clock_t_::now() + m_latency );
+
+  m_vMember.clear();
+  for ( TransportLoopback* pTransport: m_vTransport ) {
+    bool bCopy( false ); // one copy per client with overlapping subscriptions
+    for ( const std::string& sFilter: pTransport->m_vFilter ) {
+      std::string_view svGroup, svFilter( sFilter );
+      if ( topic::EShared::yes == topic::Shared( sFilter, svGroup, svFilter ) ) {
+        if ( topic::Match( svFilter, svTopic ) ) m_vMember.emplace_back( Member{ &sFilter, pTransport } );
+      }
+      else {
+        if ( !bCopy && topic::Match( sFilter, svTopic ) ) {
+          m_queueEvent.push(
+            Event{ due, ++m_sequence, EEvent::message, pTransport, pTransport->m_id, 0, std::string( svTopic ), std::string( svMessage ) } );
+          bCopy = true;
+        }
+      }
+    }
+  }
+
+  if ( !m_vMember.empty() ) { // group members by subscription, in attach order, and pick one from each
+    std::stable_sort(
+      m_vMember.begin(), m_vMember.end(),
+      []( const Member& lhs, const Member& rhs ){ return *lhs.psSubscription < *rhs.psSubscription; } );
+    vMember_t::const_iterator iter( m_vMember.begin() );
+    while ( m_vMember.end() != iter ) {
+      vMember_t::const_iterator end( iter );
+      while ( ( m_vMember.end() != end ) && ( *end->psSubscription == *iter->psSubscription ) ) ++end;
+      uint64_t& nNext( m_umapShare[ *iter->psSubscription ] );
+      TransportLoopback* pTransport( ( iter + ( nNext++ % ( end - iter ) ) )->pTransport );
+      m_queueEvent.push(
+        Event{ due, ++m_sequence, EEvent::message, pTransport, pTransport->m_id, 0, std::string( svTopic ), std::string( svMessage ) } );
+      iter = end;
+    }
+  }
+
+  if ( 1 == nQoS ) {
+    m_queueEvent.push( Event{ due, ++m_sequence, EEvent::ack, pFrom, pFrom->m_id, token, std::string(), std::string() } );
+  }
+
+  m_cvEvent.notify_one();
+
+  return result::success;
+}
+
+void Loopback::Dispatch() {
+
+  std::unique_lock<std::mutex> lock( m_mutex );
+
+  while ( m_bRunning ) {
+
+    if ( m_queueEvent.empty() ) {
+      m_cvEvent.wait( lock );
+      continue;
+    }
+
+    if ( clock_t_::now() < m_queueEvent.top().due ) {
+      m_cvEvent.wait_until( lock, m_queueEvent.top().due );
+      continue;
+    }
+
+    Event event( std::move( const_cast<Event&>( m_queueEvent.top() ) ) );
+    m_queueEvent.pop();
+
+    vTransport_t::iterator iter = std::find( m_vTransport.begin(), m_vTransport.end(), event.pTarget );
+    if ( ( m_vTransport.end() == iter ) || ( event.idTarget != event.pTarget->m_id ) ) continue; // disconnected since
+
+    m_pDispatching = event.pTarget;
+    lock.unlock();
+
+    switch ( event.event ) {
+      case EEvent::message:
+        if ( event.pTarget->m_fMessageArrived ) event.pTarget->m_fMessageArrived( event.sTopic, event.sMessage );
+        break;
+      case EEvent::ack:
+        if ( event.pTarget->m_fDeliveryComplete ) event.pTarget->m_fDeliveryComplete( event.token );
+        break;
+    }
+
+    lock.lock();
+    m_pDispatching = nullptr;
+    m_cvDispatch.notify_all();
+  }
+}
+
+// class TransportLoopback
+
+TransportLoopback::TransportLoopback( Loopback& bus )
+: m_bus( bus )
+, m_id {}
+, m_bConnected( false )
+, m_token {}
+{}
+
+TransportLoopback::~TransportLoopback() {
+  m_bus.Detach( this );
+}
+
+int TransportLoopback::Create( const Config&, const std::string& /* sId */ ) {
+  return result::success;
+}
+
+void TransportLoopback::SetCallbacks( fConnectionLost_t&& fConnectionLost, fMessageArrived_t&& fMessageArrived, fDeliveryComplete_t&& fDeliveryComplete ) {
+  m_fConnectionLost = std::move( fConnectionLost );
+  m_fMessageArrived = std::move( fMessageArrived );
+  m_fDeliveryComplete = std::move( fDeliveryComplete );
+}
+
+int TransportLoopback::Connect() {
+  m_bus.Attach( this );
+  return result::success;
+}
+
+int TransportLoopback::Disconnect( int /* msTimeout */ ) {
+  m_bus.Detach( this );
+  return result::success;
+}
+
+bool TransportLoopback::IsConnected() {
+  std::lock_guard<std::mutex> lock( m_bus.m_mutex );
+  return m_bConnected;
+}
+
+int TransportLoopback::Publish( const std::string_view& svTopic, const std::string_view& svMessage, int nQoS, token_t& token ) {
+  return m_bus.Publish( this, svTopic, svMessage, nQoS, token );
+}
+
+int TransportLoopback::Subscribe( const std::string_view& svTopic, int /* nQoS */ ) {
+  std::lock_guard<std::mutex> lock( m_bus.m_mutex );
+  if ( !m_bConnected ) return result::disconnected;
+  if ( m_vFilter.end() == std::find( m_vFilter.begin(), m_vFilter.end(), svTopic ) ) {
+    m_vFilter.emplace_back( svTopic );
+  }
+  return result::success;
+}
+
+int TransportLoopback::UnSubscribe( const std::string_view& svTopic ) {
+  std::lock_guard<std::mutex> lock( m_bus.m_mutex );
+  vFilter_t::iterator iter = std::find( m_vFilter.begin(), m_vFilter.end(), svTopic );
+  if ( m_vFilter.end() != iter ) m_vFilter.erase( iter );
+  return result::success;
+}
+
+} // namespace mqtt
+} // namespace ou
@@ -0,0 +1,162 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+ * File:    loopback.hpp
+ * Project: Repertory/MQTT
+ * Author:  raymond@burkholder.net
+ * Created: October 19, 2026 10:41:52
+ */
+
+// in-process broker, for measuring library overhead without a network,
+//   and as a zero-hop bus between components in the same process
+//
+//   ou::mqtt::Loopback bus;
+//   ou::Mqtt a( config, std::make_unique<ou::mqtt::TransportLoopback>( bus ) );
+//   ou::Mqtt b( config, std::make_unique<ou::mqtt::TransportLoopback>( bus ) );
+
+#pragma once
+
+#include <mutex>
+#include <queue>
+#include <random>
+#include <thread>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <chrono>
+#include <condition_variable>
+
+#include "transport.hpp"
+
+namespace ou {
+namespace mqtt {
+
+class TransportLoopback;
+
+class Loopback {
+public:
+
+  Loopback();
+  ~Loopback(); // TransportLoopback instances must be destroyed first
+
+  // injected faults, applied to messages published from here on
+  void SetLatency( std::chrono::microseconds ); // publish to delivery, and publish to ack
+  void SetLoss( double probability ); // [0.0, 1.0], a lost qos 1 message loses its ack as well
+
+protected:
+private:
+
+  friend class TransportLoopback;
+
+  using clock_t_ = std::chrono::steady_clock;
+
+  enum class EEvent { message, ack };
+
+  struct Event {
+    clock_t_::time_point due;
+    uint64_t sequence; // fifo among equal due times
+    EEvent event;
+    TransportLoopback* pTarget;
+    uint64_t idTarget; // guards against a new client at a recycled address
+    Transport::token_t token;
+    std::string sTopic;
+    std::string sMessage;
+    bool operator>( const Event& rhs ) const {
+      return ( due == rhs.due ) ? ( sequence > rhs.sequence ) : ( due > rhs.due );
+    }
+  };
+
+  using queueEvent_t = std::priority_queue<Event, std::vector<Event>, std::greater<Event> >;
+
+  std::mutex m_mutex;
+  std::condition_variable m_cvEvent;
+  std::condition_variable m_cvDispatch;
+
+  bool m_bRunning;
+  uint64_t m_sequence;
+  uint64_t m_idTransport;
+  queueEvent_t m_queueEvent;
+
+  clock_t_::duration m_latency;
+  double m_dblLoss;
+  std::minstd_rand m_random;
+  std::uniform_real_distribution<double> m_distribution;
+
+  using vTransport_t = std::vector<TransportLoopback*>;
+  vTransport_t m_vTransport; // connected clients
+
+  // shared subscriptions, each message goes to one member per "$share/<group>/<filter>", round robin
+  struct Member {
+    const std::string* psSubscription;
+    TransportLoopback* pTransport;
+  };
+  using vMember_t = std::vector<Member>;
+  vMember_t m_vMember; // reused in Publish
+  using umapShare_t = std::unordered_map<std::string, uint64_t>;
+  umapShare_t m_umapShare; // next member, by subscription
+
+  TransportLoopback* m_pDispatching; // client inside a callback
+
+  std::thread m_thread;
+
+  void Attach( TransportLoopback* );
+  void Detach( TransportLoopback* );
+
+  int Publish( TransportLoopback*, const std::string_view& svTopic, const std::string_view& svMessage, int nQoS, Transport::token_t& );
+
+  void Dispatch();
+
+};
+
+class TransportLoopback: public Transport {
+public:
+
+  TransportLoopback( Loopback& );
+  virtual ~TransportLoopback();
+
+  int Create( const Config&, const std::string& sId ) override;
+  void SetCallbacks( fConnectionLost_t&&, fMessageArrived_t&&, fDeliveryComplete_t&& ) override;
+
+  int Connect() override;
+  int Disconnect( int msTimeout ) override;
+  bool IsConnected() override;
+
+  int Publish( const std::string_view& svTopic, const std::string_view& svMessage, int nQoS, token_t& ) override;
+  int Subscribe( const std::string_view& svTopic, int nQoS ) override;
+  int UnSubscribe( const std::string_view& svTopic ) override;
+
+protected:
+private:
+
+  friend class Loopback;
+
+  Loopback& m_bus;
+
+  // guarded by the bus mutex
+  uint64_t m_id;
+  bool m_bConnected;
+  token_t m_token;
+
+  using vFilter_t = std::vector<std::string>;
+  vFilter_t m_vFilter;
+
+  fConnectionLost_t m_fConnectionLost;
+  fMessageArrived_t m_fMessageArrived;
+  fDeliveryComplete_t m_fDeliveryComplete;
+
+};
+
+} // namespace mqtt
+} // namespace ou
@@ -22,141 +22,269 @@
 
 #include <chrono>
 #include <cassert>
+#include <cstring>
+#include <algorithm>
 #include <iostream>
 
-#include "mqtt.hpp"
+#include <thread.hpp>
 
-// documentation: https://eclipse.github.io/paho.mqtt.c/MQTTClient/html/_m_q_t_t_client_8h.html
+#include "mqtt.hpp"
+#include "utf8.hpp"
+#include "topic.hpp"
+#include "capture.hpp"
+#include "envelope.hpp"
+#include "topic_profiler.hpp"
+#include "transport_paho.hpp"
 
 namespace {
   unsigned int c_nQOS( 1 );
-  unsigned int c_nTimeOut( 2 ); // seconds
+
+  ou::mqtt::Config Renamed( const ou::mqtt::Config& config, const std::string& sId ) {
+    ou::mqtt::Config copy( config );
+    copy.sId = sId;
+    return copy;
+  }
 }
 
 namespace ou {
 
 Mqtt::Mqtt( const mqtt::Config& choices )
-: m_state( EState::init )
-, m_config( choices )
-, m_fMessage( nullptr )
-{
-  Init( choices.sId );
-}
+: Mqtt( mqtt::Config( choices ), std::make_unique<mqtt::TransportPaho>(), EStart::blocking, 0 )
+{}
 
 Mqtt::Mqtt( const mqtt::Config& choices, const std::string& sId )
-: m_state( EState::init )
-, m_config( choices )
-, m_fMessage( nullptr )
-{
-  Init( sId );
-}
+: Mqtt( Renamed( choices, sId ), std::make_unique<mqtt::TransportPaho>(), EStart::blocking, 0 )
+{}
 
 Mqtt::Mqtt( mqtt::Config&& choices )
+: Mqtt( std::move( choices ), std::make_unique<mqtt::TransportPaho>(), EStart::blocking, 0 )
+{}
+
+Mqtt::Mqtt( const mqtt::Config& choices, mqtt::pTransport_t&& pTransport )
+: Mqtt( mqtt::Config( choices ), std::move( pTransport ), EStart::blocking, 0 )
+{}
+
+Mqtt::Mqtt( const mqtt::Config& choices, EStart eStart, size_t nPreConnect )
+: Mqtt( mqtt::Config( choices ), std::make_unique<mqtt::TransportPaho>(), eStart, nPreConnect )
+{}
+
+Mqtt::Mqtt( const mqtt::Config& choices, mqtt::pTransport_t&& pTransport, EStart eStart, size_t nPreConnect )
+: Mqtt( mqtt::Config( choices ), std::move( pTransport ), eStart, nPreConnect )
+{}
+
+Mqtt::Mqtt( mqtt::Config&& choices, mqtt::pTransport_t&& pTransport, EStart eStart, size_t nPreConnect )
 : m_state( EState::init )
 , m_config( std::move( choices ) )
-, m_fMessage( nullptr )
+, m_pTransport( std::move( pTransport ) )
+, m_pvSubscription( std::make_shared<const vSubscription_t>() )
+, m_pvObserver( std::make_shared<const vObserver_t>() )
+, m_idObserver {}
+, m_futureReady( m_promiseReady.get_future() )
+, m_bReady( false )
+, m_nPreConnect( nPreConnect )
+, m_bPreConnect( EStart::blocking != eStart )
+, m_pProfiler( nullptr )
+, m_pRecorder( nullptr )
+, m_eValidate( EValidate::topic )
+, m_bHealth( false )
 {
-  Init( choices.sId );
+  assert( m_pTransport );
+  Init( m_config.sId, eStart );
 }
 
-void Mqtt::Init( const std::string& sId ) {
-
-  const std::string sMqttUrl("tcp://" + m_config.sHost + ':' + m_config.sPort );
-
-  MQTTClient_connectOptions options = MQTTClient_connectOptions_initializer;
-  options.keepAliveInterval = 20;
-  options.cleansession = 1;
-  options.reliable = 0;
-  options.connectTimeout = c_nTimeOut;
-  options.username = m_config.sUserName.c_str();
-  options.password = m_config.sPassword.c_str();
+void Mqtt::Init( const std::string& sId, EStart eStart ) {
 
   int result;
 
-  result = MQTTClient_create(
-    &m_clientMqtt, sMqttUrl.c_str(), sId.c_str(),
-    MQTTCLIENT_PERSISTENCE_NONE, nullptr
-    );
+  m_sId = sId;
+  result = m_pTransport->Create( m_config, m_sId );
 
   //std::cout << "ou::mqtt create status " << result << std::endl;
 
-  if ( MQTTCLIENT_SUCCESS != result ) {
+  if ( mqtt::result::success != result ) {
     throw( runtime_error( "Failed to create client", result ) );
   }
 
-  m_state = EState::created;
+  Transition( EState::init, EState::created );
 
-  result = MQTTClient_setCallbacks( m_clientMqtt, this, &Mqtt::ConnectionLost, &Mqtt::MessageArrived, &Mqtt::DeliveryComplete );
-  assert( MQTTCLIENT_SUCCESS == result ); // MQTTCLIENT_FAILURE  on error
+  m_pTransport->SetCallbacks(
+    [this]( const char* szCause ){ ConnectionLost( szCause ); },
+    [this]( const std::string_view& svTopic, const std::string_view& svMessage ){ MessageArrived( svTopic, svMessage ); },
+    [this]( mqtt::Transport::token_t token ){ DeliveryComplete( token ); }
+  );
+
+  if ( EStart::deferred == eStart ) return; // waits for Start
+
+  if ( EStart::background == eStart ) { // the first attempt is made on the connect thread
+    Transition( EState::created, EState::connecting );
+    Connect();
+    return;
+  }
 
   try {
-    result = MQTTClient_connect( m_clientMqtt, &options );
+    result = m_pTransport->Connect();
   }
   catch (...) {
+    result = mqtt::result::failure;
     std::cerr << "mqtt initial connect broken" << std::endl;
   }
 
   //std::cout << "ou::mqtt connect status " << result << std::endl;
 
-  if ( MQTTCLIENT_SUCCESS == result ) {
-    m_state = EState::connected;
+  if ( mqtt::result::success == result ) {
+    Transition( EState::created, EState::connected );
   }
   else {
-    m_state = EState::connecting;
+    Transition( EState::created, EState::connecting );
     Connect();
   }
 }
 
+void Mqtt::Start() {
+  if ( Transition( EState::created, EState::connecting ) ) Connect();
+  else assert( false ); // not deferred, or started already
+}
+
 Mqtt::~Mqtt() {
-  int rc {};
-  switch ( m_state ) {
-    case EState::retry_connect:
-      m_state = EState::disconnecting;
-      if ( m_threadConnect.joinable() ) m_threadConnect.join();
-      // fall through to EState::connected:
-    case EState::connected:
-      m_state = EState::disconnecting;
-      rc = MQTTClient_disconnect( m_clientMqtt, 1000 );
-      if ( MQTTCLIENT_SUCCESS != rc ) {
-        std::cerr << "Failed to disconnect, return code " << rc << std::endl;
+  StopHealth();
+  // the reconnect thread may be moving retry_connect -> connected at the same time, so loop on the exchange
+  while ( true ) {
+    EState state( m_state.load( std::memory_order_acquire ) );
+    if ( EState::start_reconnect == state ) { // ConnectionLost is about to start the reconnect thread
+      std::this_thread::yield();
+      continue;
+    }
+    if ( ( EState::retry_connect != state ) && ( EState::connected != state ) ) break; // never connected
+    if ( Transition( state, EState::disconnecting ) ) {
+      {
+        std::lock_guard<std::mutex> lock( m_mutexConnect ); // Connect may still be assigning the thread
+        if ( m_threadConnect.joinable() ) m_threadConnect.join(); // ends on seeing disconnecting, or left over from a reconnect
+      }
+      if ( m_pTransport->IsConnected() ) {
+        int rc = m_pTransport->Disconnect( 1000 );
+        if ( mqtt::result::success != rc ) {
+          std::cerr << "Failed to disconnect, return code " << rc << std::endl;
+        }
       }
-      m_state = EState::destruct;
+      Transition( EState::disconnecting, EState::destruct );
       break;
+    }
+  }
+
+  FailPreConnect();
+  if ( !m_bReady.exchange( true ) ) {
+    m_promiseReady.set_exception( std::make_exception_ptr( runtime_error( "closed before connecting", mqtt::result::disconnected ) ) );
+  }
+
+  // m_pTransport releases the client
+}
+
+bool Mqtt::Valid( EState from, EState to ) {
+  switch ( from ) {
+    case EState::init:            return EState::created == to;
+    case EState::created:         return ( EState::connected == to ) || ( EState::connecting == to );
+    case EState::connecting:      return EState::retry_connect == to;
+    case EState::connected:       return ( EState::start_reconnect == to ) || ( EState::disconnecting == to );
+    case EState::start_reconnect: return EState::retry_connect == to;
+    case EState::retry_connect:   return ( EState::connected == to ) || ( EState::disconnecting == to );
+    case EState::disconnecting:   return EState::destruct == to;
+    case EState::destruct:        return false;
+  }
+  return false;
+}
+
+Mqtt::EConnection Mqtt::Public( EState state ) {
+  switch ( state ) {
+    case EState::connected:
+      return EConnection::connected;
+    case EState::disconnecting:
+    case EState::destruct:
+      return EConnection::closed;
     default:
-      break;
+      return EConnection::disconnected;
+  }
+}
+
+bool Mqtt::Transition( EState from, EState to ) {
+  if ( !Valid( from, to ) ) {
+    std::cerr << "mqtt invalid transition " << (int)from << " -> " << (int)to << std::endl;
+    return false;
+  }
+  if ( !m_state.compare_exchange_strong( from, to, std::memory_order_acq_rel ) ) return false;
+  if ( ( EState::connected == to ) && !m_bReady.load( std::memory_order_acquire ) ) {
+    if ( !m_bReady.exchange( true ) ) m_promiseReady.set_value();
+  }
+  const EConnection connection( Public( to ) );
+  if ( Public( from ) != connection ) {
+    pvObserver_t pvObserver( std::atomic_load( &m_pvObserver ) );
+    for ( const Observer& observer: *pvObserver ) {
+      observer.fConnection( connection );
+    }
   }
+  return true;
+}
 
-  if ( EState::init != m_state ) {
-    assert( EState::destruct == m_state );
-    MQTTClient_destroy( &m_clientMqtt );
+Mqtt::idObserver_t Mqtt::AddObserver( fConnection_t&& fConnection ) {
+  assert( fConnection );
+  idObserver_t id;
+  {
+    std::lock_guard<std::mutex> lock( m_mutexObserver );
+    id = ++m_idObserver;
+    auto pvObserver = std::make_shared<vObserver_t>( *m_pvObserver );
+    pvObserver->emplace_back( Observer{ id, fConnection } );
+    std::atomic_store( &m_pvObserver, pvObserver_t( std::move( pvObserver ) ) );
   }
+  // a transition racing with this may also be reported, observers see the latest state last
+  fConnection( Connection() );
+  return id;
+}
+
+void Mqtt::RemoveObserver( idObserver_t id ) {
+  std::lock_guard<std::mutex> lock( m_mutexObserver );
+  auto pvObserver = std::make_shared<vObserver_t>( *m_pvObserver );
+  pvObserver->erase(
+    std::remove_if(
+      pvObserver->begin(), pvObserver->end(),
+      [id]( const Observer& observer ){ return id == observer.id; } ),
+    pvObserver->end() );
+  std::atomic_store( &m_pvObserver, pvObserver_t( std::move( pvObserver ) ) );
 }
 
 void Mqtt::Connect() {
-  assert( EState::init != m_state );
-  if ( 1 == MQTTClient_isConnected( m_clientMqtt ) ) {
-    assert( EState::connected == m_state );
+  assert( EState::init != m_state.load() );
+  std::lock_guard<std::mutex> lock( m_mutexConnect );
+  if ( m_pTransport->IsConnected() ) {
     std::cerr << "mqtt is already connected" << std::endl;
+    const EState state( m_state.load( std::memory_order_acquire ) );
+    if ( ( EState::connecting == state ) || ( EState::start_reconnect == state ) ) {
+      if ( Transition( state, EState::retry_connect ) ) {
+        if ( Transition( EState::retry_connect, EState::connected ) ) Connected( EState::start_reconnect == state );
+      }
+    }
   }
   else {
-    m_state = EState::retry_connect;
+    if ( m_threadConnect.joinable() ) {
+      // the thread from a previous reconnect has finished, assigning over it would terminate
+      assert( std::this_thread::get_id() != m_threadConnect.get_id() );
+      m_threadConnect.join();
+    }
+    const EState state( m_state.load( std::memory_order_acquire ) );
+    assert( ( EState::connecting == state ) || ( EState::start_reconnect == state ) );
+    if ( !Transition( state, EState::retry_connect ) ) return; // being destroyed
+    const bool bReconnect( EState::start_reconnect == state );
+    // the destructor joins under m_mutexConnect, so sees the thread once it has moved past retry_connect
     m_threadConnect = std::move( std::thread(
-      [this](){
-        while ( EState::retry_connect == m_state ) {
+      [this,bReconnect](){
+        ou::thread::Enter( "mqtt.connect" );
+        while ( EState::retry_connect == m_state.load( std::memory_order_acquire ) ) {
           try {
-
-            MQTTClient_connectOptions options = MQTTClient_connectOptions_initializer;
-            options.keepAliveInterval = 20;
-            options.cleansession = 1;
-            options.reliable = 0;
-            options.connectTimeout = c_nTimeOut;
-            options.username = m_config.sUserName.c_str();
-            options.password = m_config.sPassword.c_str();
-
-            int result = MQTTClient_connect( m_clientMqtt, &options );
-            if ( MQTTCLIENT_SUCCESS == result ) {
-              m_state = EState::connected;
-              std::cout << "mqtt re-connected" << std::endl;
+            int result = m_pTransport->Connect();
+            if ( mqtt::result::success == result ) {
+              if ( bReconnect ) mqtt::Counters::Increment( m_counters.nReconnect );
+              if ( Transition( EState::retry_connect, EState::connected ) ) {
+                Connected( bReconnect );
+              }
+              // else the destructor has taken over, and disconnects
             }
             else {
               std::cerr << "mqtt reconnect wait" << std::endl;
@@ -171,6 +299,12 @@ void Mqtt::Connect() {
   }
 }
 
+void Mqtt::Connected( bool bReconnect ) {
+  Resubscribe(); // clean session, a racing Subscribe at worst subscribes twice
+  FlushPreConnect();
+  std::cout << ( bReconnect ? "mqtt re-connected" : "mqtt connected" ) << std::endl;
+}
+
 void Mqtt::Publish( const std::string& sTopic, const std::string& sMessage, fPublishComplete_t&& fPublishComplete ) {
   const std::string_view svTopic( sTopic );
   const std::string_view svMessage( sMessage );
@@ -178,87 +312,360 @@ void Mqtt::Publish( const std::string& sTopic, const std::string& sMessage, fPub
 }
 
 void Mqtt::Publish( const std::string_view& svTopic, const std::string_view& svMessage, fPublishComplete_t&& fPublishComplete ) {
+  Publish( svTopic, svMessage, c_nQOS, std::move( fPublishComplete ) );
+}
 
-  if ( EState::connected == m_state ) {
-    MQTTClient_deliveryToken token;
+void Mqtt::Publish( const std::string_view& svTopic, const std::string_view& svMessage, int nQoS, fPublishComplete_t&& fPublishComplete ) {
+  assert( ( 0 == nQoS ) || ( 1 == nQoS ) );
+  if ( m_bPreConnect.load( std::memory_order_relaxed ) ) {
+    if ( HoldPreConnect( svTopic, svMessage, nQoS, deadline_t::max(), fPublishComplete ) ) return;
+  }
+  Send( svTopic, svMessage, nQoS, std::move( fPublishComplete ) );
+}
 
-    int result = MQTTClient_publish( m_clientMqtt, svTopic.begin(), svMessage.size(), svMessage.begin(), c_nQOS, 0, &token );
+void Mqtt::Publish( const std::string_view& svTopic, const std::string_view& svMessage, int nQoS, deadline_t deadline, fPublishComplete_t&& fPublishComplete ) {
+  assert( ( 0 == nQoS ) || ( 1 == nQoS ) );
+  if ( deadline <= deadline_t::clock::now() ) {
+    mqtt::Counters::Increment( m_counters.nExpired );
+    fPublishComplete( false, mqtt::result::expired );
+    return;
+  }
+  if ( m_bPreConnect.load( std::memory_order_relaxed ) ) {
+    if ( HoldPreConnect( svTopic, svMessage, nQoS, deadline, fPublishComplete ) ) return;
+  }
+  Send( svTopic, svMessage, nQoS, std::move( fPublishComplete ) );
+}
 
-    if ( MQTTCLIENT_SUCCESS != result ) {
+bool Mqtt::HoldPreConnect( const std::string_view& svTopic, const std::string_view& svMessage, int nQoS, deadline_t deadline, fPublishComplete_t& fPublishComplete ) {
+  vPreConnect_t vExpired;
+  bool bHeld( false );
+  {
+    std::lock_guard<std::mutex> lock( m_mutexPreConnect );
+    if ( !m_bPreConnect.load( std::memory_order_relaxed ) ) return false; // flushed meanwhile, send directly
+    if ( m_nPreConnect <= m_queuePreConnect.size() ) { // full, make room from expired messages, wherever they are
+      m_queuePreConnect.Expire(
+        deadline_t::clock::now(),
+        [&vExpired]( PreConnect&& pre ){ vExpired.emplace_back( std::move( pre ) ); } );
+    }
+    if ( m_nPreConnect > m_queuePreConnect.size() ) {
+      m_queuePreConnect.push_back(
+        PreConnect{ std::string( svTopic ), std::string( svMessage ), nQoS, deadline, std::move( fPublishComplete ) } );
+      bHeld = true;
+    }
+  }
+  for ( PreConnect& pre: vExpired ) {
+    mqtt::Counters::Increment( m_counters.nExpired );
+    pre.fPublishComplete( false, mqtt::result::expired );
+  }
+  if ( !bHeld ) {
+    mqtt::Counters::Increment( m_counters.nDropped ); // held messages are full
+    fPublishComplete( false, mqtt::result::disconnected );
+  }
+  return true;
+}
+
+void Mqtt::FlushPreConnect() {
+  // Publish keeps holding until the buffer is seen empty, so held messages go out ahead of new ones
+  vPreConnect_t vPreConnect;
+  while ( true ) {
+    {
+      std::lock_guard<std::mutex> lock( m_mutexPreConnect );
+      if ( m_queuePreConnect.empty() ) {
+        m_bPreConnect.store( false, std::memory_order_relaxed );
+        break;
+      }
+      m_queuePreConnect.Take( [&vPreConnect]( PreConnect&& pre ){ vPreConnect.emplace_back( std::move( pre ) ); } );
+    }
+    for ( PreConnect& pre: vPreConnect ) {
+      if ( pre.deadline <= deadline_t::clock::now() ) {
+        mqtt::Counters::Increment( m_counters.nExpired );
+        pre.fPublishComplete( false, mqtt::result::expired );
+      }
+      else Send( pre.sTopic, pre.sMessage, pre.nQoS, std::move( pre.fPublishComplete ) );
+    }
+    vPreConnect.clear();
+  }
+}
+
+void Mqtt::FailPreConnect() {
+  vPreConnect_t vPreConnect;
+  {
+    std::lock_guard<std::mutex> lock( m_mutexPreConnect );
+    m_bPreConnect.store( false, std::memory_order_relaxed );
+    m_queuePreConnect.Take( [&vPreConnect]( PreConnect&& pre ){ vPreConnect.emplace_back( std::move( pre ) ); } );
+  }
+  for ( PreConnect& pre: vPreConnect ) {
+    mqtt::Counters::Increment( m_counters.nDropped );
+    pre.fPublishComplete( false, mqtt::result::disconnected );
+  }
+}
+
+void Mqtt::Send( const std::string_view& svTopic, const std::string_view& svMessage, int nQoS, fPublishComplete_t&& fPublishComplete ) {
+
+  mqtt::TopicProfiler* pProfiler( m_pProfiler.load( std::memory_order_acquire ) );
+  if ( pProfiler ) pProfiler->Record( mqtt::TopicProfiler::EDirection::outbound, svTopic, svMessage.size() );
+
+  if ( IsConnected() ) {
+    mqtt::Transport::token_t token;
+
+    int result = m_pTransport->Publish( svTopic, svMessage, nQoS, token );
+
+    if ( mqtt::result::success != result ) {
+      mqtt::Counters::Increment( m_counters.nFailed );
       fPublishComplete( false, result );
       //throw( runtime_error( "Failed to publish message", rc ) );
     }
+    else
+    if ( 0 == nQoS ) {
+      mqtt::Counters::Increment( m_counters.nPublished );
+      mqtt::Counters::Increment( m_counters.nAcked );
+      fPublishComplete( true, 0 ); // DeliveryComplete is not called with QoS0
+    }
     else {
+      mqtt::Counters::Increment( m_counters.nPublished );
       std::lock_guard<std::mutex> lock( m_mutexDeliveryToken );
       umapDeliveryToken_t::iterator iterDeliveryToken = m_umapDeliveryToken.find( token );
       if ( m_umapDeliveryToken.end() == iterDeliveryToken ) {
         m_umapDeliveryToken.emplace( token, std::move( fPublishComplete ) );
       }
       else {
-        std::cerr << "delivery token " << token << " already delivered" << std::endl;
+        // ack raced ahead of registration
         fPublishComplete( true, 0 );
         assert( nullptr == iterDeliveryToken->second );
         m_umapDeliveryToken.erase( iterDeliveryToken );
       }
     }
   }
+  else {
+    mqtt::Counters::Increment( m_counters.nDropped );
+    fPublishComplete( false, mqtt::result::disconnected );
+  }
 }
 
 void Mqtt::Subscribe( const std::string_view& topic, fMessage_t&& fMessage ) {
-  m_fMessage = std::move( fMessage );
-  assert( m_clientMqtt );
-  assert( EState::connected == m_state );
-  // TODO: memory leaks on topic?
-  int result = MQTTClient_subscribe( m_clientMqtt, topic.begin(), c_nQOS );
-  assert( MQTTCLIENT_SUCCESS == result );
+  std::string_view svGroup, svFilter( topic );
+  if ( mqtt::topic::EShared::malformed == mqtt::topic::Shared( topic, svGroup, svFilter ) ) {
+    std::cerr << "mqtt subscribe " << topic << " malformed shared subscription" << std::endl;
+    return;
+  }
+  const size_t ixMatch( topic.size() - svFilter.size() );
+  Subscription subscription{ std::string( topic ), ixMatch, mqtt::topic::Levels(), false, std::move( fMessage ) };
+  subscription.bLevels = mqtt::topic::Split( svFilter, subscription.levels );
+  {
+    std::lock_guard<std::mutex> lock( m_mutexSubscription );
+    auto pvSubscription = std::make_shared<vSubscription_t>( *m_pvSubscription );
+    vSubscription_t::iterator iter = std::find_if(
+      pvSubscription->begin(), pvSubscription->end(),
+      [&topic]( const Subscription& subscription ){ return topic == subscription.sFilter; } );
+    if ( pvSubscription->end() == iter ) {
+      pvSubscription->emplace_back( std::move( subscription ) );
+    }
+    else {
+      iter->fMessage = std::move( subscription.fMessage );
+    }
+    std::atomic_store( &m_pvSubscription, pvSubscription_t( std::move( pvSubscription ) ) );
+  }
+  if ( IsConnected() ) {
+    const std::string sFilter( topic ); // NUL terminated for the transport
+    int result = m_pTransport->Subscribe( sFilter, c_nQOS );
+    if ( mqtt::result::success != result ) { // kept, and retried on the next connect
+      std::cerr << "mqtt subscribe " << sFilter << " failed " << result << std::endl;
+    }
+  }
+  // otherwise subscribed on connect
+}
+
+void Mqtt::AcceptEnvelopes( const std::string_view& svBase ) {
+  Subscribe( mqtt::envelope::Topic( svBase ), []( const std::string_view&, const std::string_view& ){} );
 }
 
 void Mqtt::UnSubscribe( const std::string_view& topic ) {
-  assert( m_clientMqtt );
-  // TODO: memory leaks on topic?
-  int result = MQTTClient_unsubscribe( m_clientMqtt, topic.begin() );
-  assert( MQTTCLIENT_SUCCESS == result );
-  m_fMessage = nullptr;
-}
-
-void Mqtt::ConnectionLost( void* context, char* cause ) {
-  assert( context );
-  Mqtt* self = reinterpret_cast<Mqtt*>( context );
-  std::cerr << "mqtt connection lost, reconnecting ..." << std::endl;
-  assert( EState::connected == self->m_state );
-  self->m_state = EState::start_reconnect;
-  self->Connect();
+  {
+    std::lock_guard<std::mutex> lock( m_mutexSubscription );
+    auto pvSubscription = std::make_shared<vSubscription_t>( *m_pvSubscription );
+    pvSubscription->erase(
+      std::remove_if(
+        pvSubscription->begin(), pvSubscription->end(),
+        [&topic]( const Subscription& subscription ){ return topic == subscription.sFilter; } ),
+      pvSubscription->end() );
+    std::atomic_store( &m_pvSubscription, pvSubscription_t( std::move( pvSubscription ) ) );
+  }
+  if ( IsConnected() ) {
+    const std::string sFilter( topic ); // NUL terminated for the transport
+    int result = m_pTransport->UnSubscribe( sFilter );
+    if ( mqtt::result::success != result ) {
+      std::cerr << "mqtt unsubscribe " << sFilter << " failed " << result << std::endl;
+    }
+  }
+}
+
+void Mqtt::Resubscribe() {
+  pvSubscription_t pvSubscription( std::atomic_load( &m_pvSubscription ) );
+  for ( const Subscription& subscription: *pvSubscription ) {
+    int result = m_pTransport->Subscribe( subscription.sFilter, c_nQOS );
+    if ( mqtt::result::success != result ) {
+      std::cerr << "mqtt resubscribe " << subscription.sFilter << " failed " << result << std::endl;
+    }
+  }
+}
+
+void Mqtt::ConnectionLost( const char* szCause ) {
+  std::cerr << "mqtt connection lost (" << ( szCause ? szCause : "unknown" ) << "), reconnecting ..." << std::endl;
+  if ( !Transition( EState::connected, EState::start_reconnect ) ) {
+    return; // disconnecting, the destructor owns the transport
+  }
+
+  // clean session: anything in flight is discarded by the client and will never be acked
+  umapDeliveryToken_t umapDeliveryToken;
+  {
+    std::lock_guard<std::mutex> lock( m_mutexDeliveryToken );
+    umapDeliveryToken.swap( m_umapDeliveryToken );
+  }
+  for ( umapDeliveryToken_t::value_type& vt: umapDeliveryToken ) {
+    if ( vt.second ) {
+      mqtt::Counters::Increment( m_counters.nFailed );
+      vt.second( false, mqtt::result::disconnected );
+    }
+  }
+
+  Connect();
   //std::cout << "mqtt started reconnect" << std::endl;
 }
 
-int Mqtt::MessageArrived( void* context, char* topicName, int topicLen, MQTTClient_message* message ) {
-  assert( context );
-  Mqtt* self = reinterpret_cast<Mqtt*>( context );
-  assert( 0 == topicLen ); // for some reason in comes in this way
-  //std::cout << "mqtt message: " << std::string( topicName ) << " " << std::string( (const char*) message->payload, message->payloadlen ) << std::endl;
-  const std::string_view svTopic( topicName );
-  const std::string_view svMessage( (char*)message->payload, message->payloadlen );
-  if ( self->m_fMessage ) self->m_fMessage( svTopic, svMessage );
-  MQTTClient_freeMessage( &message );
-  MQTTClient_free( topicName );
-  return 1;
+void Mqtt::MessageArrived( const std::string_view& svTopic, const std::string_view& svMessage ) {
+  //std::cout << "mqtt message: " << svTopic << " " << svMessage << std::endl;
+  mqtt::capture::Recorder* pRecorder( m_pRecorder.load( std::memory_order_acquire ) );
+  if ( pRecorder ) pRecorder->Record( svTopic, svMessage );
+  Dispatch( svTopic, svMessage );
+}
+
+void Mqtt::Dispatch( const std::string_view& svTopic, const std::string_view& svMessage ) {
+  const std::string_view svBase( mqtt::envelope::Base( svTopic ) );
+  if ( !svBase.empty() ) Unpack( svBase, svMessage );
+  else {
+    pvSubscription_t pvSubscription( std::atomic_load( &m_pvSubscription ) );
+    Deliver( *pvSubscription, svTopic, svMessage );
+  }
+}
+
+void Mqtt::Unpack( const std::string_view& svBase, const std::string_view& svEnvelope ) {
+
+  mqtt::envelope::Reader reader( svEnvelope );
+  if ( !reader.Valid() ) {
+    std::cerr << "mqtt envelope on " << svBase << " not recognised" << std::endl;
+    return;
+  }
+  mqtt::Counters::Increment( m_counters.nEnvelope );
+
+  pvSubscription_t pvSubscription( std::atomic_load( &m_pvSubscription ) ); // one snapshot for all the records
+
+  // record topics are assembled here, spilling to the heap only when long
+  static const size_t c_nTopic = 256;
+  char rTopic[ c_nTopic ];
+  std::string sTopic;
+
+  std::string_view svSuffix, svPayload;
+  while ( reader.Next( svSuffix, svPayload ) ) {
+    const size_t nTopic( svBase.size() + 1 + svSuffix.size() );
+    std::string_view svTopic;
+    if ( c_nTopic >= nTopic ) {
+      std::memcpy( rTopic, svBase.data(), svBase.size() );
+      rTopic[ svBase.size() ] = '/';
+      std::memcpy( rTopic + svBase.size() + 1, svSuffix.data(), svSuffix.size() );
+      svTopic = std::string_view( rTopic, nTopic );
+    }
+    else {
+      sTopic.assign( svBase.data(), svBase.size() );
+      sTopic += '/';
+      sTopic.append( svSuffix.data(), svSuffix.size() );
+      svTopic = sTopic;
+    }
+    Deliver( *pvSubscription, svTopic, svPayload );
+  }
+  if ( !reader.Valid() ) {
+    std::cerr << "mqtt envelope on " << svBase << " truncated" << std::endl;
+  }
+}
+
+void Mqtt::Deliver( const vSubscription_t& vSubscription, const std::string_view& svTopic, const std::string_view& svMessage ) {
+
+  const EValidate eValidate( m_eValidate.load( std::memory_order_relaxed ) );
+  if ( EValidate::none != eValidate ) {
+    if ( ( std::string_view::npos != svTopic.find( '\0' ) )
+      || !mqtt::utf8::Valid( svTopic )
+      || ( ( EValidate::topic_payload == eValidate ) && !mqtt::utf8::Valid( svMessage ) )
+    ) {
+      mqtt::Counters::Increment( m_counters.nInvalid );
+      return;
+    }
+  }
+
+  mqtt::Counters::Increment( m_counters.nInbound );
+  mqtt::TopicProfiler* pProfiler( m_pProfiler.load( std::memory_order_acquire ) );
+  if ( pProfiler ) pProfiler->Record( mqtt::TopicProfiler::EDirection::inbound, svTopic, svMessage.size() );
+
+  mqtt::topic::Levels levels; // split once, compared against each filter
+  const bool bLevels( mqtt::topic::Split( svTopic, levels ) );
+
+  for ( const Subscription& subscription: vSubscription ) {
+    const std::string_view svFilter( std::string_view( subscription.sFilter ).substr( subscription.ixMatch ) );
+    const bool bMatch(
+      ( bLevels && subscription.bLevels )
+      ? mqtt::topic::Match( svFilter, subscription.levels, svTopic, levels )
+      : mqtt::topic::Match( svFilter, svTopic )
+      );
+    if ( bMatch ) {
+      subscription.fMessage( svTopic, svMessage );
+    }
+  }
 }
 
-void Mqtt::DeliveryComplete( void* context, MQTTClient_deliveryToken token ) {
+void Mqtt::DeliveryComplete( mqtt::Transport::token_t token ) {
 	// not called with QoS0
-  assert( context );
-  Mqtt* self = reinterpret_cast<Mqtt*>( context );
   //std::cout << "mqtt delivery complete" << std::endl;
-  std::lock_guard<std::mutex> lock( self->m_mutexDeliveryToken );
-  umapDeliveryToken_t::iterator iterDeliveryToken = self->m_umapDeliveryToken.find( token );
-  if ( self->m_umapDeliveryToken.end() == iterDeliveryToken ) {
-    std::cerr << "delivery token " << token << " not yet registered" << std::endl;
-    self->m_umapDeliveryToken.emplace( token, nullptr );
+  std::lock_guard<std::mutex> lock( m_mutexDeliveryToken );
+  umapDeliveryToken_t::iterator iterDeliveryToken = m_umapDeliveryToken.find( token );
+  mqtt::Counters::Increment( m_counters.nAcked );
+  if ( m_umapDeliveryToken.end() == iterDeliveryToken ) {
+    // ack raced ahead of registration
+    m_umapDeliveryToken.emplace( token, nullptr );
   }
   else {
     iterDeliveryToken->second( true, 0 );
-    self->m_umapDeliveryToken.erase( iterDeliveryToken );
+    m_umapDeliveryToken.erase( iterDeliveryToken );
+  }
+}
+
+void Mqtt::StartHealth( std::chrono::milliseconds interval, const std::string& sTopic ) {
+
+  assert( std::chrono::milliseconds::zero() < interval );
+
+  StopHealth();
+
+  const std::string sHealthTopic( sTopic.empty() ? "$health/" + m_sId : sTopic );
+
+  std::lock_guard<std::mutex> lock( m_mutexHealth );
+  m_bHealth = true;
+  m_threadHealth = std::move( std::thread(
+    [this,interval,sHealthTopic](){
+      ou::thread::Enter( "mqtt.health" );
+      std::unique_lock<std::mutex> lock( m_mutexHealth );
+      while ( !m_cvHealth.wait_for( lock, interval, [this]{ return !m_bHealth; } ) ) {
+        lock.unlock();
+        const std::string sSnapshot( m_counters.Take().Json() );
+        Publish( sHealthTopic, sSnapshot, 0, []( bool, int ){} );
+        lock.lock();
+      }
+    } ) );
+}
+
+void Mqtt::StopHealth() {
+  {
+    std::lock_guard<std::mutex> lock( m_mutexHealth );
+    m_bHealth = false;
   }
+  m_cvHealth.notify_one();
+  if ( m_threadHealth.joinable() ) m_threadHealth.join();
 }
 
 } // namespace ou
@@ -25,18 +25,33 @@
 #pragma once
 
 #include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
 #include <string>
 #include <thread>
+#include <vector>
+#include <cstdint>
 #include <stdexcept>
+#include <future>
 #include <functional>
 #include <string_view>
 #include <unordered_map>
-
-#include <MQTTClient.h>
+#include <condition_variable>
 
 #include "config.hpp"
+#include "topic.hpp"
+#include "deadline_queue.hpp"
+#include "counters.hpp"
+#include "transport.hpp"
 
 namespace ou {
+namespace mqtt {
+  class TopicProfiler;
+  namespace capture {
+    class Recorder;
+  }
+}
 
 class Mqtt {
 public:
@@ -44,50 +59,196 @@ public:
   struct runtime_error: std::runtime_error {
     int rc;
     runtime_error( const std::string& e, int rc_ )
-    : std::runtime_error( e ) {}
+    : std::runtime_error( e ), rc( rc_ ) {}
   };
 
   Mqtt( const mqtt::Config& );
   Mqtt( const mqtt::Config&, const std::string& sId );
   Mqtt( mqtt::Config&& );
+  Mqtt( const mqtt::Config&, mqtt::pTransport_t&& ); // alternate backend, eg mqtt::TransportLoopback
+
+  // blocking: the constructor makes the first connection attempt, as above
+  // background: the constructor returns once the client is created, connecting on the connect thread,
+  //   Publish before the first connection is held, up to nPreConnect messages, and sent in order once connected
+  // deferred: as background, but connecting only once Start is called, so a will can be set first
+  enum class EStart { blocking, background, deferred };
+  static const size_t c_nPreConnect = 1024;
+  Mqtt( const mqtt::Config&, EStart, size_t nPreConnect = c_nPreConnect );
+  Mqtt( const mqtt::Config&, mqtt::pTransport_t&&, EStart, size_t nPreConnect = c_nPreConnect );
+  Mqtt( mqtt::Config&&, mqtt::pTransport_t&&, EStart, size_t nPreConnect = c_nPreConnect ); // the others delegate here
   ~Mqtt();
 
+  // called with ( false, mqtt::result::disconnected ) when not connected, or when the connection drops before the ack
   using fPublishComplete_t = std::function<void(bool,int)>;
   void Publish( const std::string_view& svTopic, const std::string_view& svMessage, fPublishComplete_t&& );
   void Publish( const std::string& sTopic, const std::string& sMessage, fPublishComplete_t&& );
+  // qos 0 completes as soon as the message is handed to the client, qos 1 completes on broker ack
+  void Publish( const std::string_view& svTopic, const std::string_view& svMessage, int nQoS, fPublishComplete_t&& );
+  // completes with ( false, mqtt::result::expired ) when the deadline passes while the message is held,
+  //   once handed to the transport the deadline no longer applies
+  using deadline_t = std::chrono::steady_clock::time_point;
+  void Publish( const std::string_view& svTopic, const std::string_view& svMessage, int nQoS, deadline_t, fPublishComplete_t&& );
 
   // send and forget, errors are simply logged
+  //   each filter has its own handler, an inbound message is handed to every matching filter,
+  //   subscribing again to a filter replaces its handler, filters are re-subscribed after a reconnect
+  //   "$share/<group>/<filter>" joins a consumer group, each message goes to one member, its handler matched on <filter>,
+  //     mqtt 3.1.1 does not say which subscription a message came through, so a handler for a shared filter
+  //     also sees messages arriving through an overlapping plain filter, and each copy reaches every matching handler
   using fMessage_t = std::function<void( const std::string_view& svTopic, const std::string_view& svMessage )>;
   void Subscribe( const std::string_view& svTopic, fMessage_t&& );
   void UnSubscribe( const std::string_view& svTopic );
 
+  // envelopes (see envelope.hpp) are unpacked on arrival, each record dispatched as though received on its own,
+  //   the payloads viewed in place, the envelope itself reaches no handler
+  //   a <base>/# filter receives them already, this subscribes to the envelopes of svBase for narrower filters,
+  //   UnSubscribe( mqtt::envelope::Topic( svBase ) ) to stop
+  void AcceptEnvelopes( const std::string_view& svBase );
+
+  // inbound messages and envelope records failing validation are dropped before any handler, counted in nInvalid
+  //   topic: utf-8 with no NUL, as mqtt 3.1.1 section 4.7.3 requires of the broker already, the default
+  //   topic_payload: the payload as well, for applications exchanging only text, payloads are otherwise binary
+  enum class EValidate { none, topic, topic_payload };
+  void SetValidation( EValidate eValidate ) { m_eValidate.store( eValidate, std::memory_order_relaxed ); }
+
+  // connection state as seen by producers, internal reconnect states all read as disconnected
+  enum class EConnection { disconnected, connected, closed };
+
+  // a single relaxed load, for the hot path
+  bool IsConnected() const { return EState::connected == m_state.load( std::memory_order_relaxed ); }
+  EConnection Connection() const { return Public( m_state.load( std::memory_order_acquire ) ); }
+
+  void Start(); // EStart::deferred only
+
+  // last will for the following connects, see Transport::SetWill, mqtt::result::failure when unsupported
+  int SetWill( const std::string_view& svTopic, const std::string_view& svMessage, int nQoS = 1 ) {
+    return m_pTransport->SetWill( svTopic, svMessage, nQoS );
+  }
+
+  // ready on the first connection, holds runtime_error when destroyed before connecting
+  std::shared_future<void> Ready() const { return m_futureReady; }
+
+  // called on every change, on the thread making the transition (connect thread or transport callback),
+  //   and once on registration with the current state, on the calling thread
+  using fConnection_t = std::function<void( EConnection )>;
+  using idObserver_t = uint32_t;
+  idObserver_t AddObserver( fConnection_t&& );
+  void RemoveObserver( idObserver_t ); // the observer may still be running on another thread when this returns
+
+  const mqtt::Counters& GetCounters() const { return m_counters; }
+
+  // publish a counters snapshot (qos 0) every interval, to "$health/<client id>" when sTopic is empty
+  //   '$' topics are not matched by '#' or '+/...', monitor with an explicit "$health/+"
+  void StartHealth( std::chrono::milliseconds interval, const std::string& sTopic = std::string() );
+  void StopHealth();
+
+  // heavy hitter accounting of outbound and inbound topics, nullptr to stop
+  //   owned by the caller, may be shared between instances, must outlive this instance or be removed first
+  void SetProfiler( mqtt::TopicProfiler* pProfiler ) { m_pProfiler.store( pProfiler, std::memory_order_release ); }
+
+  // record inbound messages to a capture, nullptr to stop, ownership as with SetProfiler
+  void SetRecorder( mqtt::capture::Recorder* pRecorder ) { m_pRecorder.store( pRecorder, std::memory_order_release ); }
+
+  // deliver to the matching subscription handlers as though received from the broker, not recorded, envelopes unpacked
+  void Dispatch( const std::string_view& svTopic, const std::string_view& svMessage );
+
 protected:
 private:
 
   enum class EState{ init, created, connecting, connected, start_reconnect, retry_connect, disconnecting, destruct };
 
-  EState m_state;
+  std::atomic<EState> m_state; // changed only through Transition
+
+  bool Transition( EState from, EState to ); // false when the state was not 'from'
+  static bool Valid( EState from, EState to );
+  static EConnection Public( EState );
 
   mqtt::Config m_config;
+  std::string m_sId; // client id given to the transport, set in Init
 
+  std::mutex m_mutexConnect; // Connect and the destructor, so m_threadConnect is never seen mid assignment
   std::thread m_threadConnect;
 
-  MQTTClient m_clientMqtt;
+  mqtt::pTransport_t m_pTransport;
 
   std::mutex m_mutexDeliveryToken;
 
-  using umapDeliveryToken_t = std::unordered_map<MQTTClient_deliveryToken, fPublishComplete_t>;
+  using umapDeliveryToken_t = std::unordered_map<mqtt::Transport::token_t, fPublishComplete_t>;
   umapDeliveryToken_t m_umapDeliveryToken;
 
-  fMessage_t m_fMessage;
+  struct Subscription {
+    std::string sFilter; // as subscribed with the broker
+    size_t ixMatch;      // where the filter matched against topics starts, past "$share/<group>/"
+    mqtt::topic::Levels levels; // of the matched part
+    bool bLevels;        // false when too deep to split, matched as a string
+    fMessage_t fMessage;
+  };
+  using vSubscription_t = std::vector<Subscription>;
+  using pvSubscription_t = std::shared_ptr<const vSubscription_t>;
+
+  std::mutex m_mutexSubscription; // writers, readers take a snapshot with std::atomic_load
+  pvSubscription_t m_pvSubscription; // copy on write, so handlers may (un)subscribe
+
+  void Resubscribe();
+
+  struct Observer {
+    idObserver_t id;
+    fConnection_t fConnection;
+  };
+  using vObserver_t = std::vector<Observer>;
+  using pvObserver_t = std::shared_ptr<const vObserver_t>;
+
+  std::mutex m_mutexObserver; // writers, readers take a snapshot with std::atomic_load
+  pvObserver_t m_pvObserver;
+  idObserver_t m_idObserver;
+
+  std::promise<void> m_promiseReady;
+  std::shared_future<void> m_futureReady;
+  std::atomic<bool> m_bReady; // the promise has been satisfied
+
+  // publishes held until the first connection, background start only
+  struct PreConnect {
+    std::string sTopic;
+    std::string sMessage;
+    int nQoS;
+    deadline_t deadline;
+    fPublishComplete_t fPublishComplete;
+  };
+  using queuePreConnect_t = mqtt::DeadlineQueue<PreConnect>;
+  using vPreConnect_t = std::vector<PreConnect>;
+
+  const size_t m_nPreConnect;
+  std::atomic<bool> m_bPreConnect; // relaxed check in Publish, confirmed under the mutex
+  std::mutex m_mutexPreConnect;
+  queuePreConnect_t m_queuePreConnect;
+
+  bool HoldPreConnect( const std::string_view& svTopic, const std::string_view& svMessage, int nQoS, deadline_t, fPublishComplete_t& );
+  void FlushPreConnect(); // from Connected
+  void FailPreConnect(); // destruction before connecting
+
+  mqtt::Counters m_counters;
+
+  std::atomic<mqtt::TopicProfiler*> m_pProfiler;
+  std::atomic<mqtt::capture::Recorder*> m_pRecorder;
+  std::atomic<EValidate> m_eValidate;
+
+  std::mutex m_mutexHealth;
+  std::condition_variable m_cvHealth;
+  bool m_bHealth;
+  std::thread m_threadHealth;
+
+  void Init( const std::string& sId, EStart = EStart::blocking );
 
-  void Init( const std::string& sId );
+  void Send( const std::string_view& svTopic, const std::string_view& svMessage, int nQoS, fPublishComplete_t&& );
 
-  static int MessageArrived( void* context, char* topicName, int topicLen, MQTTClient_message* message );
-  static void DeliveryComplete( void* context, MQTTClient_deliveryToken token );
-  static void ConnectionLost( void* context, char* cause );
+  void MessageArrived( const std::string_view& svTopic, const std::string_view& svMessage );
+  void Unpack( const std::string_view& svBase, const std::string_view& svEnvelope );
+  void Deliver( const vSubscription_t&, const std::string_view& svTopic, const std::string_view& svMessage );
+  void DeliveryComplete( mqtt::Transport::token_t );
+  void ConnectionLost( const char* szCause );
 
   void Connect();
+  void Connected( bool bReconnect ); // resubscribe and flush after retry_connect -> connected
 
 };
 
@@ -0,0 +1,228 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+  File:    rpc.cpp
+  Project: Repertory/MQTT
+  Author:  raymond@burkholder.net
+  Created: October 19, 2026 14:48:26
+*/
+
+#include <vector>
+#include <cassert>
+#include <charconv>
+#include <iostream>
+
+#include <thread.hpp>
+
+#include "rpc.hpp"
+
+namespace {
+  const int c_nQoS( 1 );
+}
+
+namespace ou {
+namespace mqtt {
+
+Rpc::Rpc( Mqtt& mqtt, const std::string& sReplyBase )
+: m_pState( std::make_shared<State>( mqtt, sReplyBase ) )
+, m_bRunning( true )
+{
+  assert( !sReplyBase.empty() );
+
+  pState_t pState( m_pState );
+  mqtt.Subscribe(
+    sReplyBase + "/+",
+    [pState]( const std::string_view& svTopic, const std::string_view& svMessage ){
+      pState->Response( svTopic, svMessage );
+    } );
+
+  m_threadTimer = std::move( std::thread(
+    [this](){
+      ou::thread::Enter( "mqtt.rpc" );
+      const std::chrono::milliseconds resolution( m_pState->wheel.Resolution() );
+      std::vector<fReply_t> vExpired;
+      std::unique_lock<std::mutex> lockTimer( m_mutexTimer );
+      while ( m_bRunning ) {
+        bool bIdle;
+        {
+          std::lock_guard<std::mutex> lock( m_pState->mutex );
+          bIdle = m_pState->wheel.Empty();
+        }
+        // m_mutexTimer is held from the check into the wait, so Request arming the first timer can not be missed
+        if ( bIdle ) m_cvTimer.wait( lockTimer );
+        else m_cvTimer.wait_for( lockTimer, resolution );
+        if ( !m_bRunning ) break;
+        {
+          std::lock_guard<std::mutex> lock( m_pState->mutex );
+          m_pState->wheel.Advance(
+            clock_t_::now(),
+            [this,&vExpired]( TimerWheel::id_t id ){
+              State::umapPending_t::iterator iter = m_pState->umapPending.find( id );
+              if ( m_pState->umapPending.end() != iter ) { // otherwise already answered
+                vExpired.emplace_back( std::move( iter->second ) );
+                m_pState->umapPending.erase( iter );
+              }
+            } );
+        }
+        if ( !vExpired.empty() ) {
+          lockTimer.unlock(); // a handler may issue the next Request
+          for ( fReply_t& fReply: vExpired ) fReply( EResult::timeout, std::string_view() );
+          vExpired.clear();
+          lockTimer.lock();
+        }
+      }
+    } ) );
+}
+
+Rpc::~Rpc() {
+
+  {
+    std::lock_guard<std::mutex> lock( m_mutexTimer );
+    m_bRunning = false;
+  }
+  m_cvTimer.notify_one();
+  if ( m_threadTimer.joinable() ) m_threadTimer.join();
+
+  m_pState->mqtt.UnSubscribe( m_pState->sReplyBase + "/+" );
+  for ( const std::string& sFilter: m_vServe ) {
+    m_pState->mqtt.UnSubscribe( sFilter );
+  }
+
+  State::umapPending_t umapPending;
+  {
+    std::lock_guard<std::mutex> lock( m_pState->mutex );
+    umapPending.swap( m_pState->umapPending );
+  }
+  for ( State::umapPending_t::value_type& vt: umapPending ) {
+    vt.second( EResult::failed, std::string_view() );
+  }
+}
+
+Rpc::fReply_t Rpc::State::Take( uint64_t idRequest ) {
+  fReply_t fReply( nullptr );
+  std::lock_guard<std::mutex> lock( mutex );
+  umapPending_t::iterator iter = umapPending.find( idRequest );
+  if ( umapPending.end() != iter ) {
+    fReply = std::move( iter->second );
+    umapPending.erase( iter );
+  }
+  return fReply;
+}
+
+void Rpc::State::Response( const std::string_view& svTopic, const std::string_view& svResponse ) {
+  const std::string_view::size_type ix = svTopic.rfind( '/' );
+  if ( std::string_view::npos == ix ) return;
+  uint64_t idRequest {};
+  const char* begin( svTopic.data() + ix + 1 );
+  const char* end( svTopic.data() + svTopic.size() );
+  const std::from_chars_result result = std::from_chars( begin, end, idRequest );
+  if ( ( std::errc() != result.ec ) || ( end != result.ptr ) ) {
+    std::cerr << "rpc malformed reply topic " << svTopic << std::endl;
+    return;
+  }
+  fReply_t fReply( Take( idRequest ) );
+  if ( fReply ) fReply( EResult::reply, svResponse );
+  // else late, after a timeout
+}
+
+void Rpc::Request( const std::string_view& svTopic, const std::string_view& svRequest, std::chrono::milliseconds timeout, fReply_t&& fReply ) {
+
+  assert( fReply );
+
+  const uint64_t idRequest( ++m_pState->id );
+  const std::string sId( std::to_string( idRequest ) );
+
+  std::string sPayload;
+  sPayload.reserve( m_pState->sReplyBase.size() + 1 + sId.size() + 1 + svRequest.size() );
+  sPayload += m_pState->sReplyBase;
+  sPayload += '/';
+  sPayload += sId;
+  sPayload += '\n';
+  sPayload += svRequest;
+
+  bool bWake;
+  {
+    std::lock_guard<std::mutex> lock( m_pState->mutex );
+    m_pState->umapPending.emplace( idRequest, std::move( fReply ) );
+    bWake = m_pState->wheel.Empty(); // the timer thread sleeps until the first timer is armed
+    m_pState->wheel.Schedule( idRequest, clock_t_::now() + timeout );
+  }
+  if ( bWake ) {
+    {
+      std::lock_guard<std::mutex> lock( m_mutexTimer ); // orders this with the thread's check of Empty
+    }
+    m_cvTimer.notify_one();
+  }
+
+  const std::string sTopic( svTopic ); // NUL terminated for the transport
+  pState_t pState( m_pState );
+  m_pState->mqtt.Publish(
+    sTopic, sPayload, c_nQoS,
+    [pState,idRequest]( bool bOk, int ){
+      if ( !bOk ) {
+        fReply_t fReply( pState->Take( idRequest ) );
+        if ( fReply ) fReply( EResult::failed, std::string_view() );
+      }
+    } );
+}
+
+std::future<std::string> Rpc::Request( const std::string_view& svTopic, const std::string_view& svRequest, std::chrono::milliseconds timeout ) {
+  auto pPromise = std::make_shared<std::promise<std::string> >();
+  std::future<std::string> future( pPromise->get_future() );
+  Request(
+    svTopic, svRequest, timeout,
+    [pPromise]( EResult result, const std::string_view& svReply ){
+      switch ( result ) {
+        case EResult::reply:
+          pPromise->set_value( std::string( svReply ) );
+          break;
+        case EResult::timeout:
+          pPromise->set_exception( std::make_exception_ptr( rpc_error( "rpc timeout", result ) ) );
+          break;
+        case EResult::failed:
+          pPromise->set_exception( std::make_exception_ptr( rpc_error( "rpc failed", result ) ) );
+          break;
+      }
+    } );
+  return future;
+}
+
+size_t Rpc::InFlight() const {
+  std::lock_guard<std::mutex> lock( m_pState->mutex );
+  return m_pState->umapPending.size();
+}
+
+void Rpc::Serve( const std::string& sFilter, fServe_t&& fServe ) {
+  m_vServe.push_back( sFilter );
+  Mqtt& mqtt( m_pState->mqtt );
+  m_pState->mqtt.Subscribe(
+    sFilter,
+    [&mqtt,fServe_=std::move( fServe )]( const std::string_view& svTopic, const std::string_view& svMessage ){
+      const std::string_view::size_type ix = svMessage.find( '\n' );
+      if ( std::string_view::npos == ix ) {
+        std::cerr << "rpc request without reply topic on " << svTopic << std::endl;
+        return;
+      }
+      std::string sReplyTopic( svMessage.substr( 0, ix ) );
+      fServe_(
+        svTopic, svMessage.substr( ix + 1 ),
+        [&mqtt,sReplyTopic_=std::move( sReplyTopic )]( const std::string_view& svResponse ){
+          mqtt.Publish( sReplyTopic_, svResponse, c_nQoS, []( bool, int ){} );
+        } );
+    } );
+}
+
+} // namespace mqtt
+} // namespace ou
@@ -0,0 +1,121 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+ * File:    rpc.hpp
+ * Project: Repertory/MQTT
+ * Author:  raymond@burkholder.net
+ * Created: October 19, 2026 14:48:26
+ */
+
+// pipelined request/response over one shared reply subscription (mqtt 3.1.1 has no correlation data)
+//
+//   request:  published to the device topic, payload is "<reply base>/<id>\n<request>"
+//   response: published by the device to "<reply base>/<id>", payload is the response
+//
+//   the id in the reply topic correlates, any number of requests may be in flight,
+//   deadlines are kept in a timer wheel, its thread ticking only while timers are armed
+//
+//   Serve() implements the device side of the same framing
+
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <stdexcept>
+#include <functional>
+#include <string_view>
+#include <unordered_map>
+#include <condition_variable>
+
+#include "mqtt.hpp"
+#include "timer_wheel.hpp"
+
+namespace ou {
+namespace mqtt {
+
+class Rpc {
+public:
+
+  enum class EResult { reply, timeout, failed };
+
+  struct rpc_error: std::runtime_error {
+    EResult result;
+    rpc_error( const std::string& e, EResult result_ )
+    : std::runtime_error( e ), result( result_ ) {}
+  };
+
+  Rpc( Mqtt&, const std::string& sReplyBase ); // sReplyBase should be unique to this instance, eg "rpc/<sId>"
+  ~Rpc(); // outstanding requests complete with EResult::failed
+
+  // svReply is empty unless EResult::reply, called on the mqtt callback thread or the timer thread
+  using fReply_t = std::function<void( EResult, const std::string_view& svReply )>;
+  void Request( const std::string_view& svTopic, const std::string_view& svRequest, std::chrono::milliseconds timeout, fReply_t&& );
+
+  // rpc_error on timeout or failure
+  std::future<std::string> Request( const std::string_view& svTopic, const std::string_view& svRequest, std::chrono::milliseconds timeout );
+
+  size_t InFlight() const;
+
+  // device side: fRespond may be called later, from any thread, at most once
+  using fRespond_t = std::function<void( const std::string_view& svResponse )>;
+  using fServe_t = std::function<void( const std::string_view& svTopic, const std::string_view& svRequest, fRespond_t&& )>;
+  void Serve( const std::string& sFilter, fServe_t&& );
+
+protected:
+private:
+
+  using clock_t_ = std::chrono::steady_clock;
+
+  // handlers registered with Mqtt may still run briefly after UnSubscribe, they hold this, not the Rpc
+  struct State {
+
+    Mqtt& mqtt;
+    const std::string sReplyBase;
+
+    mutable std::mutex mutex;
+    std::atomic<uint64_t> id;
+
+    using umapPending_t = std::unordered_map<uint64_t, fReply_t>;
+    umapPending_t umapPending;
+
+    TimerWheel wheel;
+
+    State( Mqtt& mqtt_, const std::string& sReplyBase_ )
+    : mqtt( mqtt_ ), sReplyBase( sReplyBase_ ), id {}
+    {}
+
+    fReply_t Take( uint64_t id ); // nullptr when already completed
+    void Response( const std::string_view& svTopic, const std::string_view& svResponse );
+  };
+
+  using pState_t = std::shared_ptr<State>;
+  pState_t m_pState;
+
+  std::vector<std::string> m_vServe;
+
+  bool m_bRunning;
+  std::mutex m_mutexTimer;
+  std::condition_variable m_cvTimer;
+  std::thread m_threadTimer;
+
+};
+
+} // namespace mqtt
+} // namespace ou
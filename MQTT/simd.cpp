@@ -0,0 +1,51 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+  File:    simd.cpp
+  Project: Repertory/MQTT
+  Author:  raymond@burkholder.net
+  Created: October 19, 2026 22:41:09
+*/
+
+#include "simd.hpp"
+
+namespace ou {
+namespace mqtt {
+namespace simd {
+
+EIsa Detect() {
+  static const EIsa eIsa = [](){
+#if ( defined( __x86_64__ ) || defined( __i386__ ) ) && defined( __GNUC__ )
+    __builtin_cpu_init();
+    if ( __builtin_cpu_supports( "avx2" ) ) return EIsa::avx2;
+    if ( __builtin_cpu_supports( "sse4.2" ) ) return EIsa::sse42;
+#endif
+    return EIsa::scalar;
+  }();
+  return eIsa;
+}
+
+const char* Name( EIsa eIsa ) {
+  switch ( eIsa ) {
+    case EIsa::scalar: return "scalar";
+    case EIsa::sse42:  return "sse4.2";
+    case EIsa::avx2:   return "avx2";
+  }
+  return "unknown";
+}
+
+} // namespace simd
+} // namespace mqtt
+} // namespace ou
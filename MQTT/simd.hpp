@@ -0,0 +1,39 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+ * File:    simd.hpp
+ * Project: Repertory/MQTT
+ * Author:  raymond@burkholder.net
+ * Created: October 19, 2026 22:41:09
+ */
+
+// instruction set selection for the vectorised paths in utf8.cpp and topic.cpp
+//   vector code is compiled per function with target attributes, so the library needs no -m flags,
+//   and is chosen once at run time from what the cpu reports, scalar elsewhere
+
+#pragma once
+
+namespace ou {
+namespace mqtt {
+namespace simd {
+
+enum class EIsa { scalar, sse42, avx2 };
+
+EIsa Detect(); // the best available, cached
+const char* Name( EIsa );
+
+} // namespace simd
+} // namespace mqtt
+} // namespace ou
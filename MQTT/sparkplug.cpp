@@ -0,0 +1,739 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+  File:    sparkplug.cpp
+  Project: Repertory/MQTT
+  Author:  raymond@burkholder.net
+  Created: October 19, 2026 19:20:44
+*/
+
+#include <chrono>
+#include <limits>
+#include <cassert>
+#include <cstring>
+
+#include "varint.hpp"
+#include "sparkplug.hpp"
+
+namespace {
+
+  // protobuf wire types
+  enum EWire: uint32_t { varint = 0, fixed64 = 1, length = 2, fixed32 = 5 };
+
+  // org.eclipse.tahu.protobuf.Payload
+  namespace payload {
+    const uint32_t timestamp( 1 );
+    const uint32_t metrics( 2 );
+    const uint32_t seq( 3 );
+  }
+
+  // org.eclipse.tahu.protobuf.Payload.Metric
+  namespace metric {
+    const uint32_t name( 1 );
+    const uint32_t alias( 2 );
+    const uint32_t timestamp( 3 );
+    const uint32_t datatype( 4 );
+    const uint32_t is_null( 7 );
+    const uint32_t int_value( 10 );
+    const uint32_t long_value( 11 );
+    const uint32_t float_value( 12 );
+    const uint32_t double_value( 13 );
+    const uint32_t boolean_value( 14 );
+    const uint32_t string_value( 15 );
+  }
+
+  using ou::mqtt::sparkplug::EDataType;
+  using ou::mqtt::sparkplug::Value;
+  using ou::mqtt::sparkplug::Metric;
+  using ou::mqtt::VarintSize;
+  using ou::mqtt::PutVarint;
+  using ou::mqtt::GetVarint;
+
+  // ==== encoding
+
+  // all fields used are below 16, the tag is a single byte
+  inline void PutTag( std::string& s, uint32_t field, EWire eWire ) {
+    s.push_back( static_cast<char>( ( field << 3 ) | eWire ) );
+  }
+
+  template<typename T>
+  inline void PutFixed( std::string& s, T value ) { // little endian
+    char buf[ sizeof( T ) ];
+    std::memcpy( buf, &value, sizeof( T ) );
+    s.append( buf, sizeof( T ) );
+  }
+
+  // the value as it goes on the wire: field and either integer bits or text
+  struct Wire {
+    uint32_t field;
+    EWire eWire;
+    uint64_t bits;
+    std::string_view sv;
+  };
+
+  Wire ToWire( EDataType eDataType, const Value& value ) {
+    switch ( eDataType ) {
+      case EDataType::Int8:
+      case EDataType::Int16:
+      case EDataType::Int32:
+        return Wire{ metric::int_value, EWire::varint, static_cast<uint32_t>( static_cast<int32_t>( std::get<int64_t>( value ) ) ), {} };
+      case EDataType::UInt8:
+      case EDataType::UInt16:
+      case EDataType::UInt32:
+        return Wire{ metric::int_value, EWire::varint, static_cast<uint32_t>( std::get<uint64_t>( value ) ), {} };
+      case EDataType::Int64:
+        return Wire{ metric::long_value, EWire::varint, static_cast<uint64_t>( std::get<int64_t>( value ) ), {} };
+      case EDataType::UInt64:
+      case EDataType::DateTime:
+        return Wire{ metric::long_value, EWire::varint, std::get<uint64_t>( value ), {} };
+      case EDataType::Float: {
+          uint32_t bits;
+          const float flt( std::get<float>( value ) );
+          std::memcpy( &bits, &flt, sizeof( bits ) );
+          return Wire{ metric::float_value, EWire::fixed32, bits, {} };
+        }
+      case EDataType::Double: {
+          uint64_t bits;
+          const double dbl( std::get<double>( value ) );
+          std::memcpy( &bits, &dbl, sizeof( bits ) );
+          return Wire{ metric::double_value, EWire::fixed64, bits, {} };
+        }
+      case EDataType::Boolean:
+        return Wire{ metric::boolean_value, EWire::varint, std::get<bool>( value ) ? 1u : 0u, {} };
+      case EDataType::String:
+      case EDataType::Text:
+        return Wire{ metric::string_value, EWire::length, 0, std::get<std::string>( value ) };
+      default:
+        assert( false );
+        return Wire{ metric::is_null, EWire::varint, 1, {} };
+    }
+  }
+
+  size_t WireSize( const Wire& wire ) {
+    switch ( wire.eWire ) {
+      case EWire::varint:  return 1 + VarintSize( wire.bits );
+      case EWire::fixed32: return 1 + 4;
+      case EWire::fixed64: return 1 + 8;
+      case EWire::length:  return 1 + VarintSize( wire.sv.size() ) + wire.sv.size();
+    }
+    return 0;
+  }
+
+  void PutWire( std::string& s, const Wire& wire ) {
+    PutTag( s, wire.field, wire.eWire );
+    switch ( wire.eWire ) {
+      case EWire::varint:  PutVarint( s, wire.bits ); break;
+      case EWire::fixed32: PutFixed<uint32_t>( s, wire.bits ); break;
+      case EWire::fixed64: PutFixed<uint64_t>( s, wire.bits ); break;
+      case EWire::length:
+        PutVarint( s, wire.sv.size() );
+        s.append( wire.sv.data(), wire.sv.size() );
+        break;
+    }
+  }
+
+  void PutMetric( std::string& s, const Metric& m ) {
+
+    const bool bNull( std::holds_alternative<std::monostate>( *m.pValue ) );
+    const Wire wire( bNull ? Wire{ metric::is_null, EWire::varint, 1, {} } : ToWire( m.eDataType, *m.pValue ) );
+
+    size_t nSize( WireSize( wire ) );
+    if ( !m.svName.empty() ) nSize += 1 + VarintSize( m.svName.size() ) + m.svName.size();
+    if ( m.bAlias ) nSize += 1 + VarintSize( m.alias );
+    if ( m.bDataType ) nSize += 1 + VarintSize( static_cast<uint32_t>( m.eDataType ) );
+
+    PutTag( s, payload::metrics, EWire::length );
+    PutVarint( s, nSize );
+
+    if ( !m.svName.empty() ) {
+      PutTag( s, metric::name, EWire::length );
+      PutVarint( s, m.svName.size() );
+      s.append( m.svName.data(), m.svName.size() );
+    }
+    if ( m.bAlias ) {
+      PutTag( s, metric::alias, EWire::varint );
+      PutVarint( s, m.alias );
+    }
+    if ( m.bDataType ) {
+      PutTag( s, metric::datatype, EWire::varint );
+      PutVarint( s, static_cast<uint32_t>( m.eDataType ) );
+    }
+    PutWire( s, wire );
+  }
+
+  // ==== decoding
+
+  struct Reader {
+    const char* p;
+    const char* end;
+    bool Varint( uint64_t& value ) { return GetVarint( p, end, value ); }
+    template<typename T>
+    bool Fixed( T& value ) {
+      if ( size_t( end - p ) < sizeof( T ) ) return false;
+      std::memcpy( &value, p, sizeof( T ) );
+      p += sizeof( T );
+      return true;
+    }
+    bool Length( std::string_view& sv ) {
+      uint64_t n;
+      if ( !Varint( n ) || ( uint64_t( end - p ) < n ) ) return false;
+      sv = std::string_view( p, n );
+      p += n;
+      return true;
+    }
+    bool Skip( EWire eWire ) {
+      uint64_t u64;
+      std::string_view sv;
+      switch ( eWire ) {
+        case EWire::varint:  return Varint( u64 );
+        case EWire::fixed64: return Fixed( u64 );
+        case EWire::length:  return Length( sv );
+        case EWire::fixed32: {
+            uint32_t u32;
+            return Fixed( u32 );
+          }
+      }
+      return false; // groups are not used by sparkplug
+    }
+  };
+
+  bool DecodeMetric( const std::string_view& sv, ou::mqtt::sparkplug::MetricView& mv ) {
+    mv = ou::mqtt::sparkplug::MetricView{};
+    bool bDataType( false );
+    Reader reader{ sv.data(), sv.data() + sv.size() };
+    while ( reader.p != reader.end ) {
+      uint64_t key;
+      if ( !reader.Varint( key ) ) return false;
+      const uint32_t field( key >> 3 );
+      const EWire eWire( static_cast<EWire>( key & 7 ) );
+      uint64_t u64 {};
+      bool bOk( true );
+      switch ( ( field << 3 ) | eWire ) {
+        case ( metric::name << 3 ) | EWire::length:
+          bOk = reader.Length( mv.svName );
+          break;
+        case ( metric::alias << 3 ) | EWire::varint:
+          bOk = reader.Varint( mv.alias );
+          mv.bAlias = true;
+          break;
+        case ( metric::timestamp << 3 ) | EWire::varint:
+          bOk = reader.Varint( mv.timestamp );
+          break;
+        case ( metric::datatype << 3 ) | EWire::varint:
+          bOk = reader.Varint( u64 );
+          mv.eDataType = static_cast<EDataType>( u64 );
+          bDataType = true;
+          break;
+        case ( metric::is_null << 3 ) | EWire::varint:
+          bOk = reader.Varint( u64 );
+          if ( 0 != u64 ) mv.value = std::monostate();
+          break;
+        case ( metric::int_value << 3 ) | EWire::varint:
+        case ( metric::long_value << 3 ) | EWire::varint:
+          bOk = reader.Varint( u64 );
+          mv.value = u64;
+          break;
+        case ( metric::float_value << 3 ) | EWire::fixed32: {
+            float flt {};
+            bOk = reader.Fixed( flt );
+            mv.value = flt;
+          }
+          break;
+        case ( metric::double_value << 3 ) | EWire::fixed64: {
+            double dbl {};
+            bOk = reader.Fixed( dbl );
+            mv.value = dbl;
+          }
+          break;
+        case ( metric::boolean_value << 3 ) | EWire::varint:
+          bOk = reader.Varint( u64 );
+          mv.value = ( 0 != u64 );
+          break;
+        case ( metric::string_value << 3 ) | EWire::length: {
+            std::string_view svValue;
+            bOk = reader.Length( svValue );
+            mv.value = svValue;
+          }
+          break;
+        default:
+          bOk = reader.Skip( eWire ); // metadata, properties, datasets, templates, ...
+          break;
+      }
+      if ( !bOk ) return false;
+    }
+    if ( bDataType ) ou::mqtt::sparkplug::Interpret( mv, mv.eDataType );
+    return true;
+  }
+
+  // narrow integer types, as Set checks them
+  bool Fits( EDataType eDataType, int64_t value ) {
+    switch ( eDataType ) {
+      case EDataType::Int8:  return ( INT8_MIN <= value ) && ( INT8_MAX >= value );
+      case EDataType::Int16: return ( INT16_MIN <= value ) && ( INT16_MAX >= value );
+      case EDataType::Int32: return ( INT32_MIN <= value ) && ( INT32_MAX >= value );
+      case EDataType::Int64: return true;
+      default: return false;
+    }
+  }
+
+  bool Fits( EDataType eDataType, uint64_t value ) {
+    switch ( eDataType ) {
+      case EDataType::UInt8:  return UINT8_MAX >= value;
+      case EDataType::UInt16: return UINT16_MAX >= value;
+      case EDataType::UInt32: return UINT32_MAX >= value;
+      case EDataType::UInt64:
+      case EDataType::DateTime:
+        return true;
+      default: return false;
+    }
+  }
+
+  // an initial value is held in the alternative its type expects, checked by assert
+  [[maybe_unused]] bool Suits( EDataType eDataType, const Value& value ) {
+    if ( std::holds_alternative<std::monostate>( value ) ) return true;
+    switch ( eDataType ) {
+      case EDataType::Int8: case EDataType::Int16: case EDataType::Int32: case EDataType::Int64:
+        return std::holds_alternative<int64_t>( value ) && Fits( eDataType, std::get<int64_t>( value ) );
+      case EDataType::UInt8: case EDataType::UInt16: case EDataType::UInt32: case EDataType::UInt64: case EDataType::DateTime:
+        return std::holds_alternative<uint64_t>( value ) && Fits( eDataType, std::get<uint64_t>( value ) );
+      case EDataType::Float:   return std::holds_alternative<float>( value );
+      case EDataType::Double:  return std::holds_alternative<double>( value );
+      case EDataType::Boolean: return std::holds_alternative<bool>( value );
+      case EDataType::String:
+      case EDataType::Text:
+        return std::holds_alternative<std::string>( value );
+      default:
+        return false;
+    }
+  }
+
+} // namespace anonymous
+
+namespace ou {
+namespace mqtt {
+namespace sparkplug {
+
+void Encode( std::string& sPayload, uint64_t timestamp, const Metric* pMetric, size_t nMetric, bool bSeq, uint64_t seq ) {
+  PutTag( sPayload, payload::timestamp, EWire::varint );
+  PutVarint( sPayload, timestamp );
+  for ( size_t ix = 0; ix < nMetric; ++ix ) {
+    PutMetric( sPayload, pMetric[ ix ] );
+  }
+  if ( bSeq ) {
+    PutTag( sPayload, payload::seq, EWire::varint );
+    PutVarint( sPayload, seq );
+  }
+}
+
+bool Decode( const std::string_view& svPayload, PayloadView& pv ) {
+  pv.timestamp = 0;
+  pv.seq = 0;
+  pv.bSeq = false;
+  pv.vMetric.clear();
+  Reader reader{ svPayload.data(), svPayload.data() + svPayload.size() };
+  while ( reader.p != reader.end ) {
+    uint64_t key;
+    if ( !reader.Varint( key ) ) return false;
+    const uint32_t field( key >> 3 );
+    const EWire eWire( static_cast<EWire>( key & 7 ) );
+    bool bOk( true );
+    if ( ( payload::timestamp == field ) && ( EWire::varint == eWire ) ) {
+      bOk = reader.Varint( pv.timestamp );
+    }
+    else if ( ( payload::metrics == field ) && ( EWire::length == eWire ) ) {
+      std::string_view sv;
+      bOk = reader.Length( sv );
+      if ( bOk ) {
+        pv.vMetric.emplace_back();
+        bOk = DecodeMetric( sv, pv.vMetric.back() );
+      }
+    }
+    else if ( ( payload::seq == field ) && ( EWire::varint == eWire ) ) {
+      bOk = reader.Varint( pv.seq );
+      pv.bSeq = true;
+    }
+    else bOk = reader.Skip( eWire ); // uuid, body
+    if ( !bOk ) return false;
+  }
+  return true;
+}
+
+void Interpret( MetricView& mv, EDataType eDataType ) {
+  mv.eDataType = eDataType;
+  if ( !std::holds_alternative<uint64_t>( mv.value ) ) return;
+  const uint64_t raw( std::get<uint64_t>( mv.value ) );
+  switch ( eDataType ) {
+    case EDataType::Int8:  mv.value = int64_t( static_cast<int8_t>( raw ) ); break;
+    case EDataType::Int16: mv.value = int64_t( static_cast<int16_t>( raw ) ); break;
+    case EDataType::Int32: mv.value = int64_t( static_cast<int32_t>( raw ) ); break;
+    case EDataType::Int64: mv.value = static_cast<int64_t>( raw ); break;
+    default: break; // unsigned as decoded
+  }
+}
+
+std::string Topic( const std::string& sGroup, const std::string_view& svType, const std::string& sNode ) {
+  std::string sTopic( c_szNamespace );
+  sTopic += '/';
+  sTopic += sGroup;
+  sTopic += '/';
+  sTopic += svType;
+  sTopic += '/';
+  sTopic += sNode;
+  return sTopic;
+}
+
+uint64_t Now() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::system_clock::now().time_since_epoch() ).count();
+}
+
+// ==== Node
+
+Node::State::State( Mqtt& mqtt_, const std::string& sGroup_, const std::string& sNode_ )
+: mqtt( mqtt_ ), sGroup( sGroup_ ), sNode( sNode_ )
+, sTopicBirth( Topic( sGroup_, "NBIRTH", sNode_ ) )
+, sTopicData( Topic( sGroup_, "NDATA", sNode_ ) )
+, sTopicDeath( Topic( sGroup_, "NDEATH", sNode_ ) )
+, bdSeq {}, bConnected( false ), seq {}
+, valueRebirth( false )
+, stats {}
+{}
+
+void Node::State::Will() {
+  valueBdSeq = bdSeq;
+  const Metric metric{ c_szBdSeq, 0, false, EDataType::UInt64, true, &valueBdSeq };
+  sPayload.clear();
+  Encode( sPayload, Now(), &metric, 1, false, 0 );
+  mqtt.SetWill( sTopicDeath, sPayload, 1 );
+}
+
+void Node::State::Birth() {
+
+  valueBdSeq = bdSeq;
+  vMetric.clear();
+  vMetric.emplace_back( Metric{ c_szBdSeq, 0, false, EDataType::UInt64, true, &valueBdSeq } );
+  vMetric.emplace_back( Metric{ c_szRebirth, vEntry.size(), true, EDataType::Boolean, true, &valueRebirth } ); // aliased past the entries
+  for ( size_t id = 0; id < vEntry.size(); ++id ) {
+    Entry& entry( vEntry[ id ] );
+    vMetric.emplace_back( Metric{ entry.sName, id, true, entry.eDataType, true, &entry.value } );
+    entry.bChanged = false;
+  }
+
+  seq = 0;
+  sPayload.clear();
+  Encode( sPayload, Now(), vMetric.data(), vMetric.size(), true, seq );
+  mqtt.Publish( sTopicBirth, sPayload, 0, []( bool, int ){} );
+
+  bConnected = true;
+  ++stats.nBirth;
+}
+
+void Node::State::Connection( Mqtt::EConnection connection ) {
+  std::lock_guard<std::mutex> lock( mutex );
+  switch ( connection ) {
+    case Mqtt::EConnection::connected:
+      Birth();
+      break;
+    case Mqtt::EConnection::disconnected:
+      if ( bConnected ) { // the broker sends the will, the next session has the next bdSeq
+        bConnected = false;
+        ++bdSeq;
+        Will();
+      }
+      break;
+    case Mqtt::EConnection::closed:
+      bConnected = false;
+      break;
+  }
+}
+
+void Node::State::Command( const std::string_view& svMessage ) {
+  PayloadView pv;
+  if ( !Decode( svMessage, pv ) ) return;
+  for ( const MetricView& mv: pv.vMetric ) {
+    const bool bRebirth( mv.svName.empty() ? ( mv.bAlias && ( vEntry.size() == mv.alias ) ) : ( c_szRebirth == mv.svName ) );
+    if ( bRebirth && std::holds_alternative<bool>( mv.value ) && std::get<bool>( mv.value ) ) {
+      std::lock_guard<std::mutex> lock( mutex );
+      if ( bConnected ) Birth();
+    }
+  }
+}
+
+Node::Node( Mqtt& mqtt, const std::string& sGroup, const std::string& sNode, const vDefinition_t& vDefinition )
+: m_pState( std::make_shared<State>( mqtt, sGroup, sNode ) )
+, m_idObserver {}
+, m_sTopicCommand( Topic( sGroup, "NCMD", sNode ) )
+{
+  m_pState->vEntry.reserve( vDefinition.size() );
+  for ( const Definition& definition: vDefinition ) {
+    assert( Suits( definition.eDataType, definition.value ) );
+    m_pState->vEntry.emplace_back( Entry{ definition.sName, definition.eDataType, definition.value, false } );
+  }
+  m_pState->vMetric.reserve( vDefinition.size() + 2 );
+
+  {
+    std::lock_guard<std::mutex> lock( m_pState->mutex );
+    m_pState->Will();
+  }
+
+  pState_t pState( m_pState );
+  mqtt.Subscribe(
+    m_sTopicCommand,
+    [pState]( const std::string_view&, const std::string_view& svMessage ){
+      pState->Command( svMessage );
+    } );
+  // called at once with the current state, a connected Mqtt gets its birth now
+  m_idObserver = mqtt.AddObserver(
+    [pState]( Mqtt::EConnection connection ){
+      pState->Connection( connection );
+    } );
+}
+
+Node::~Node() {
+  Mqtt& mqtt( m_pState->mqtt );
+  mqtt.RemoveObserver( m_idObserver );
+  mqtt.UnSubscribe( m_sTopicCommand );
+  std::lock_guard<std::mutex> lock( m_pState->mutex );
+  if ( m_pState->bConnected ) {
+    m_pState->bConnected = false;
+    m_pState->valueBdSeq = m_pState->bdSeq;
+    const Metric metric{ c_szBdSeq, 0, false, EDataType::UInt64, true, &m_pState->valueBdSeq };
+    m_pState->sPayload.clear();
+    Encode( m_pState->sPayload, Now(), &metric, 1, false, 0 );
+    mqtt.Publish( m_pState->sTopicDeath, m_pState->sPayload, 1, []( bool, int ){} );
+  }
+  mqtt.SetWill( std::string_view(), std::string_view(), 0 );
+}
+
+bool Node::Assign( id_t id, Value&& value ) {
+  std::lock_guard<std::mutex> lock( m_pState->mutex );
+  Entry& entry( m_pState->vEntry[ id ] );
+  if ( entry.value != value ) { // report by exception
+    entry.value = std::move( value );
+    entry.bChanged = true;
+  }
+  return true;
+}
+
+bool Node::Set( id_t id, int64_t value ) {
+  assert( id < m_pState->vEntry.size() );
+  const EDataType eDataType( m_pState->vEntry[ id ].eDataType ); // fixed at construction
+  if ( Fits( eDataType, value ) ) return Assign( id, Value( value ) );
+  if ( ( 0 <= value ) && Fits( eDataType, static_cast<uint64_t>( value ) ) ) return Assign( id, Value( static_cast<uint64_t>( value ) ) );
+  return false;
+}
+
+bool Node::Set( id_t id, uint64_t value ) {
+  assert( id < m_pState->vEntry.size() );
+  const EDataType eDataType( m_pState->vEntry[ id ].eDataType );
+  if ( Fits( eDataType, value ) ) return Assign( id, Value( value ) );
+  if ( ( uint64_t( INT64_MAX ) >= value ) && Fits( eDataType, static_cast<int64_t>( value ) ) ) return Assign( id, Value( static_cast<int64_t>( value ) ) );
+  return false;
+}
+
+bool Node::Set( id_t id, double value ) {
+  assert( id < m_pState->vEntry.size() );
+  switch ( m_pState->vEntry[ id ].eDataType ) {
+    case EDataType::Float:  return Assign( id, Value( static_cast<float>( value ) ) );
+    case EDataType::Double: return Assign( id, Value( value ) );
+    default: return false;
+  }
+}
+
+bool Node::Set( id_t id, bool value ) {
+  assert( id < m_pState->vEntry.size() );
+  if ( EDataType::Boolean != m_pState->vEntry[ id ].eDataType ) return false;
+  return Assign( id, Value( value ) );
+}
+
+bool Node::Set( id_t id, const std::string_view& sv ) {
+  assert( id < m_pState->vEntry.size() );
+  switch ( m_pState->vEntry[ id ].eDataType ) {
+    case EDataType::String:
+    case EDataType::Text:
+      return Assign( id, Value( std::string( sv ) ) );
+    default:
+      return false;
+  }
+}
+
+bool Node::SetNull( id_t id ) {
+  assert( id < m_pState->vEntry.size() );
+  return Assign( id, Value() );
+}
+
+void Node::Publish() {
+
+  State& state( *m_pState );
+  std::lock_guard<std::mutex> lock( state.mutex );
+  if ( !state.bConnected ) return; // changes go out with the next birth
+
+  state.vMetric.clear();
+  for ( size_t id = 0; id < state.vEntry.size(); ++id ) {
+    Entry& entry( state.vEntry[ id ] );
+    if ( entry.bChanged ) {
+      state.vMetric.emplace_back( Metric{ std::string_view(), id, true, entry.eDataType, false, &entry.value } );
+      entry.bChanged = false;
+    }
+  }
+  if ( state.vMetric.empty() ) return;
+
+  ++state.seq; // wraps at 256
+  state.sPayload.clear();
+  Encode( state.sPayload, Now(), state.vMetric.data(), state.vMetric.size(), true, state.seq );
+  state.mqtt.Publish( state.sTopicData, state.sPayload, 0, []( bool, int ){} );
+
+  ++state.stats.nData;
+  state.stats.nMetric += state.vMetric.size();
+  state.stats.nBytes += state.sPayload.size();
+}
+
+Node::Stats Node::GetStats() const {
+  std::lock_guard<std::mutex> lock( m_pState->mutex );
+  return m_pState->stats;
+}
+
+// ==== Host
+
+Host::State::State( Mqtt& mqtt_, const std::string& sGroup_, fMetric_t&& fMetric_, fNode_t&& fNode_ )
+: mqtt( mqtt_ ), sGroup( sGroup_ )
+, fMetric( std::move( fMetric_ ) ), fNode( std::move( fNode_ ) )
+, stats {}
+{}
+
+void Host::State::Rebirth( const std::string_view& svNode, Session& session ) {
+  session.bOnline = false;
+  if ( session.bRebirth ) return; // once until the birth arrives
+  session.bRebirth = true;
+  const Value value( true );
+  const Metric metric{ c_szRebirth, 0, false, EDataType::Boolean, true, &value };
+  sPayload.clear();
+  Encode( sPayload, Now(), &metric, 1, false, 0 );
+  mqtt.Publish( Topic( sGroup, "NCMD", std::string( svNode ) ), sPayload, 0, []( bool, int ){} );
+  ++stats.nRebirth;
+}
+
+void Host::State::Received( const std::string_view& svTopic, const std::string_view& svMessage ) {
+
+  // spBv1.0/<group>/<type>/<node>, device messages have a further level and are skipped
+  const size_t ixType( sizeof( c_szNamespace ) + sGroup.size() + 1 );
+  if ( svTopic.size() <= ixType ) return;
+  const size_t ixSlash( svTopic.find( '/', ixType ) );
+  if ( std::string_view::npos == ixSlash ) return;
+  const std::string_view svType( svTopic.substr( ixType, ixSlash - ixType ) );
+  const std::string_view svNode( svTopic.substr( ixSlash + 1 ) );
+  if ( svNode.empty() || ( std::string_view::npos != svNode.find( '/' ) ) ) return;
+
+  const bool bBirth( "NBIRTH" == svType );
+  const bool bData( "NDATA" == svType );
+  const bool bDeath( "NDEATH" == svType );
+  if ( !bBirth && !bData && !bDeath ) return;
+
+  std::lock_guard<std::mutex> lock( mutex );
+
+  if ( !Decode( svMessage, payload ) ) return;
+
+  sNode.assign( svNode.data(), svNode.size() ); // keeps its capacity, no allocation per message
+  Session& session( umapSession[ sNode ] );
+
+  if ( bBirth ) {
+    ++stats.nBirth;
+    session.umapAlias.clear();
+    session.bdSeq = 0;
+    for ( const MetricView& mv: payload.vMetric ) {
+      if ( c_szBdSeq == mv.svName ) {
+        if ( std::holds_alternative<uint64_t>( mv.value ) ) session.bdSeq = std::get<uint64_t>( mv.value );
+        else if ( std::holds_alternative<int64_t>( mv.value ) ) session.bdSeq = std::get<int64_t>( mv.value );
+        continue;
+      }
+      if ( mv.bAlias ) session.umapAlias[ mv.alias ] = Alias{ std::string( mv.svName ), mv.eDataType };
+    }
+    session.seq = payload.seq;
+    session.bOnline = true;
+    session.bRebirth = false;
+    if ( fNode ) fNode( svNode, true );
+    for ( const MetricView& mv: payload.vMetric ) {
+      if ( c_szBdSeq != mv.svName ) fMetric( svNode, mv, true );
+    }
+    return;
+  }
+
+  if ( bDeath ) {
+    uint64_t bdSeq( session.bdSeq );
+    for ( const MetricView& mv: payload.vMetric ) {
+      if ( ( c_szBdSeq == mv.svName ) && std::holds_alternative<uint64_t>( mv.value ) ) bdSeq = std::get<uint64_t>( mv.value );
+      if ( ( c_szBdSeq == mv.svName ) && std::holds_alternative<int64_t>( mv.value ) ) bdSeq = std::get<int64_t>( mv.value );
+    }
+    if ( bdSeq != session.bdSeq ) return; // the will of an earlier session
+    ++stats.nDeath;
+    if ( session.bOnline ) {
+      session.bOnline = false;
+      if ( fNode ) fNode( svNode, false );
+    }
+    return;
+  }
+
+  // NDATA
+  if ( !session.bOnline ) {
+    ++stats.nDropped;
+    Rebirth( svNode, session );
+    return;
+  }
+  if ( !payload.bSeq || ( static_cast<uint8_t>( session.seq + 1 ) != payload.seq ) ) {
+    ++stats.nDropped;
+    Rebirth( svNode, session );
+    return;
+  }
+  session.seq = payload.seq;
+  ++stats.nData;
+
+  for ( MetricView& mv: payload.vMetric ) {
+    if ( mv.svName.empty() ) {
+      std::unordered_map<uint64_t, Alias>::const_iterator iter( session.umapAlias.find( mv.alias ) );
+      if ( session.umapAlias.end() == iter ) {
+        Rebirth( svNode, session );
+        return;
+      }
+      mv.svName = iter->second.sName;
+      if ( EDataType::Unknown == mv.eDataType ) Interpret( mv, iter->second.eDataType );
+    }
+    fMetric( svNode, mv, false );
+  }
+}
+
+Host::Host( Mqtt& mqtt, const std::string& sGroup, fMetric_t&& fMetric, fNode_t&& fNode )
+: m_pState( std::make_shared<State>( mqtt, sGroup, std::move( fMetric ), std::move( fNode ) ) )
+, m_sFilter( std::string( c_szNamespace ) + '/' + sGroup + "/#" )
+{
+  assert( m_pState->fMetric );
+  pState_t pState( m_pState );
+  mqtt.Subscribe(
+    m_sFilter,
+    [pState]( const std::string_view& svTopic, const std::string_view& svMessage ){
+      pState->Received( svTopic, svMessage );
+    } );
+}
+
+Host::~Host() {
+  m_pState->mqtt.UnSubscribe( m_sFilter );
+}
+
+Host::Stats Host::GetStats() const {
+  std::lock_guard<std::mutex> lock( m_pState->mutex );
+  return m_pState->stats;
+}
+
+} // namespace sparkplug
+} // namespace mqtt
+} // namespace ou
@@ -0,0 +1,251 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+ * File:    sparkplug.hpp
+ * Project: Repertory/MQTT
+ * Author:  raymond@burkholder.net
+ * Created: October 19, 2026 19:20:44
+ */
+
+// sparkplug b edge node sessions and host decoding, edge node level only (no devices)
+//
+//   topics:   spBv1.0/<group>/NBIRTH|NDATA|NDEATH|NCMD/<node>
+//   payloads: the org.eclipse.tahu.protobuf Payload, written and read directly in protobuf wire format,
+//             only the fields used here: timestamp, seq, and metric name, alias, datatype, is_null, scalar values
+//
+//   Node publishes NBIRTH with names, aliases, types and current values on every connect, then NDATA
+//   carrying only aliases and the values changed since the previous Publish (report by exception),
+//   its NDEATH is registered as the will, so construct the Mqtt with EStart::deferred, the Node, then Mqtt::Start
+//   the birth carries "Node Control/Rebirth" false, aliased after the metrics,
+//   an NCMD setting it true, by name or alias, republishes the birth
+//
+//   Host resolves aliases from births, checks seq, and asks for a rebirth on a gap or an unknown alias
+
+#pragma once
+
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <variant>
+#include <functional>
+#include <string_view>
+#include <unordered_map>
+
+#include "mqtt.hpp"
+
+namespace ou {
+namespace mqtt {
+namespace sparkplug {
+
+const char c_szNamespace[] = "spBv1.0";
+const char c_szBdSeq[] = "bdSeq";
+const char c_szRebirth[] = "Node Control/Rebirth";
+
+enum class EDataType: uint32_t {
+  Unknown = 0
+, Int8 = 1, Int16 = 2, Int32 = 3, Int64 = 4
+, UInt8 = 5, UInt16 = 6, UInt32 = 7, UInt64 = 8
+, Float = 9, Double = 10, Boolean = 11, String = 12, DateTime = 13, Text = 14
+};
+
+// monostate is null, signed types hold int64_t, unsigned types and DateTime hold uint64_t
+using Value = std::variant<std::monostate, int64_t, uint64_t, float, double, bool, std::string>;
+using ValueView = std::variant<std::monostate, int64_t, uint64_t, float, double, bool, std::string_view>;
+
+// ==== wire format
+
+struct Metric { // encoder input
+  std::string_view svName; // empty: alias only
+  uint64_t alias;
+  bool bAlias;
+  EDataType eDataType;
+  bool bDataType;          // births carry the type, data messages need not
+  const Value* pValue;
+};
+
+// decoder output, views into the payload
+//   without a datatype, int_value and long_value decode as uint64_t, Interpret applies the type from the birth
+struct MetricView {
+  std::string_view svName;
+  uint64_t alias;
+  bool bAlias;
+  uint64_t timestamp;
+  EDataType eDataType;
+  ValueView value;
+};
+using vMetricView_t = std::vector<MetricView>;
+
+struct PayloadView {
+  uint64_t timestamp;
+  uint64_t seq;
+  bool bSeq;
+  vMetricView_t vMetric;
+};
+
+// appends to sPayload, which the caller clears and reuses
+void Encode( std::string& sPayload, uint64_t timestamp, const Metric* pMetric, size_t nMetric, bool bSeq, uint64_t seq );
+// false on malformed input, vMetric is reused
+bool Decode( const std::string_view& svPayload, PayloadView& );
+void Interpret( MetricView&, EDataType );
+
+std::string Topic( const std::string& sGroup, const std::string_view& svType, const std::string& sNode );
+
+uint64_t Now(); // ms since the epoch, the sparkplug timestamp
+
+// ==== edge node
+
+class Node {
+public:
+
+  struct Definition {
+    std::string sName;
+    EDataType eDataType;
+    Value value; // initial, monostate for null
+  };
+  using vDefinition_t = std::vector<Definition>;
+  using id_t = uint32_t; // index into the definitions, also the alias
+
+  Node( Mqtt&, const std::string& sGroup, const std::string& sNode, const vDefinition_t& );
+  ~Node(); // publishes NDEATH when connected
+
+  // false when the value does not suit the metric's type, nothing is sent until Publish
+  bool Set( id_t, int64_t );
+  bool Set( id_t, uint64_t );
+  bool Set( id_t, double );
+  bool Set( id_t, bool );
+  bool Set( id_t, const std::string_view& );
+  bool SetNull( id_t );
+
+  void Publish(); // NDATA with the changed metrics, nothing when none changed
+
+  struct Stats {
+    uint64_t nBirth;
+    uint64_t nData;
+    uint64_t nMetric; // data points in NDATA
+    uint64_t nBytes;  // NDATA payload bytes
+  };
+  Stats GetStats() const;
+
+protected:
+private:
+
+  struct Entry {
+    std::string sName;
+    EDataType eDataType;
+    Value value;
+    bool bChanged;
+  };
+
+  // shared with the handlers registered in Mqtt
+  struct State {
+    Mqtt& mqtt;
+    const std::string sGroup;
+    const std::string sNode;
+    const std::string sTopicBirth;
+    const std::string sTopicData;
+    const std::string sTopicDeath;
+    mutable std::mutex mutex;
+    std::vector<Entry> vEntry;
+    uint64_t bdSeq;     // of the current, or next, session
+    bool bConnected;    // a birth has been sent for this session
+    uint8_t seq;        // of the last message sent
+    std::string sPayload; // reused encode buffer, under mutex
+    std::vector<Metric> vMetric; // reused, under mutex
+    Value valueBdSeq;
+    const Value valueRebirth; // false, in every birth
+    Stats stats;
+    State( Mqtt&, const std::string& sGroup, const std::string& sNode );
+    void Will();  // NDEATH for bdSeq
+    void Birth(); // under mutex
+    void Connection( Mqtt::EConnection );
+    void Command( const std::string_view& svMessage );
+  };
+  using pState_t = std::shared_ptr<State>;
+  pState_t m_pState;
+
+  Mqtt::idObserver_t m_idObserver;
+  const std::string m_sTopicCommand;
+
+  bool Assign( id_t, Value&& ); // already suited to the type
+
+};
+
+// ==== host application
+
+class Host {
+public:
+
+  // svNode, the metric with its name resolved from the birth, bBirth true when from an NBIRTH
+  using fMetric_t = std::function<void( const std::string_view& svNode, const MetricView&, bool bBirth )>;
+  // svNode online (birth) or offline (death)
+  using fNode_t = std::function<void( const std::string_view& svNode, bool bOnline )>;
+  // both are called on the mqtt thread with the host's lock held, GetStats may not be called from them
+
+  Host( Mqtt&, const std::string& sGroup, fMetric_t&&, fNode_t&& = nullptr );
+  ~Host();
+
+  struct Stats {
+    uint64_t nBirth;
+    uint64_t nData;
+    uint64_t nDeath;
+    uint64_t nRebirth; // requested
+    uint64_t nDropped; // NDATA ignored while waiting for a birth
+  };
+  Stats GetStats() const;
+
+protected:
+private:
+
+  struct Alias {
+    std::string sName;
+    EDataType eDataType;
+  };
+  struct Session {
+    bool bOnline;     // a birth is held, data is accepted
+    bool bRebirth;    // requested, not yet answered
+    uint64_t bdSeq;
+    uint8_t seq;      // of the last message received
+    std::unordered_map<uint64_t, Alias> umapAlias;
+    Session(): bOnline( false ), bRebirth( false ), bdSeq {}, seq {} {}
+  };
+  using umapSession_t = std::unordered_map<std::string, Session>;
+
+  struct State {
+    Mqtt& mqtt;
+    const std::string sGroup;
+    const fMetric_t fMetric;
+    const fNode_t fNode;
+    mutable std::mutex mutex;
+    umapSession_t umapSession;
+    PayloadView payload; // reused, under mutex
+    std::string sPayload; // rebirth requests, under mutex
+    std::string sNode;    // reused session lookup key, under mutex
+    Stats stats;
+    State( Mqtt&, const std::string& sGroup, fMetric_t&&, fNode_t&& );
+    void Received( const std::string_view& svTopic, const std::string_view& svMessage );
+    void Rebirth( const std::string_view& svNode, Session& );
+  };
+  using pState_t = std::shared_ptr<State>;
+  pState_t m_pState;
+
+  const std::string m_sFilter;
+
+};
+
+} // namespace sparkplug
+} // namespace mqtt
+} // namespace ou
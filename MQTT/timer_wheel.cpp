@@ -0,0 +1,79 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+  File:    timer_wheel.cpp
+  Project: Repertory/MQTT
+  Author:  raymond@burkholder.net
+  Created: October 19, 2026 14:48:26
+*/
+
+#include <cassert>
+#include <algorithm>
+
+#include "timer_wheel.hpp"
+
+namespace ou {
+namespace mqtt {
+
+TimerWheel::TimerWheel( std::chrono::milliseconds resolution, size_t nSlot )
+: m_resolution( resolution )
+, m_origin( clock_t_::now() )
+, m_tick {}
+, m_nEntry {}
+, m_vSlot( nSlot )
+{
+  assert( std::chrono::milliseconds::zero() < resolution );
+  assert( 0 < nSlot );
+}
+
+uint64_t TimerWheel::Tick( clock_t_::time_point tp ) const {
+  if ( tp <= m_origin ) return 0;
+  return ( tp - m_origin ) / m_resolution;
+}
+
+void TimerWheel::Schedule( id_t id, clock_t_::time_point deadline ) {
+  // round up, a deadline is never reported early
+  const uint64_t tick = std::max<uint64_t>( Tick( deadline + m_resolution - clock_t_::duration( 1 ) ), m_tick + 1 );
+  m_vSlot[ tick % m_vSlot.size() ].emplace_back( Entry{ id, tick } );
+  ++m_nEntry;
+}
+
+void TimerWheel::Advance( clock_t_::time_point now, const fExpire_t& fExpire ) {
+
+  const uint64_t tickNow( Tick( now ) );
+  if ( tickNow <= m_tick ) return;
+
+  // after a long gap, each slot needs visiting only once
+  const uint64_t nStep = std::min<uint64_t>( tickNow - m_tick, m_vSlot.size() );
+
+  for ( uint64_t step = 1; step <= nStep; ++step ) {
+    vEntry_t& vEntry( m_vSlot[ ( m_tick + step ) % m_vSlot.size() ] );
+    for ( size_t ix = 0; ix < vEntry.size(); ) {
+      if ( vEntry[ ix ].tick <= tickNow ) {
+        const id_t id( vEntry[ ix ].id );
+        vEntry[ ix ] = vEntry.back();
+        vEntry.pop_back();
+        --m_nEntry;
+        fExpire( id );
+      }
+      else ++ix;
+    }
+  }
+
+  m_tick = tickNow;
+}
+
+} // namespace mqtt
+} // namespace ou
@@ -0,0 +1,75 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+ * File:    timer_wheel.hpp
+ * Project: Repertory/MQTT
+ * Author:  raymond@burkholder.net
+ * Created: October 19, 2026 14:48:26
+ */
+
+// hashed timing wheel: O(1) schedule, cancellation is left to the caller (ignore stale ids on expiry),
+//   deadlines further out than one revolution simply stay in their slot for another lap
+//   not thread safe, the owner locks
+
+#pragma once
+
+#include <chrono>
+#include <vector>
+#include <cstdint>
+#include <functional>
+
+namespace ou {
+namespace mqtt {
+
+class TimerWheel {
+public:
+
+  using clock_t_ = std::chrono::steady_clock;
+  using id_t = uint64_t;
+
+  TimerWheel( std::chrono::milliseconds resolution = std::chrono::milliseconds( 5 ), size_t nSlot = 1024 );
+
+  void Schedule( id_t, clock_t_::time_point deadline );
+
+  // calls fExpire for every id due at or before now
+  using fExpire_t = std::function<void( id_t )>;
+  void Advance( clock_t_::time_point now, const fExpire_t& fExpire );
+
+  std::chrono::milliseconds Resolution() const { return m_resolution; }
+  bool Empty() const { return 0 == m_nEntry; } // nothing scheduled, an owner's thread may sleep
+
+protected:
+private:
+
+  struct Entry {
+    id_t id;
+    uint64_t tick; // absolute
+  };
+  using vEntry_t = std::vector<Entry>;
+  using vSlot_t = std::vector<vEntry_t>;
+
+  const std::chrono::milliseconds m_resolution;
+  const clock_t_::time_point m_origin;
+
+  uint64_t m_tick; // last tick processed
+  size_t m_nEntry;
+  vSlot_t m_vSlot;
+
+  uint64_t Tick( clock_t_::time_point ) const;
+
+};
+
+} // namespace mqtt
+} // namespace ou
@@ -0,0 +1,186 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+  File:    topic.cpp
+  Project: Repertory/MQTT
+  Author:  raymond@burkholder.net
+  Created: October 19, 2026 10:41:52
+*/
+
+#if ( defined( __x86_64__ ) || defined( __i386__ ) ) && defined( __GNUC__ )
+#define OU_MQTT_SIMD_X86
+#include <immintrin.h>
+#endif
+
+#include "topic.hpp"
+
+namespace {
+
+  using ou::mqtt::topic::Levels;
+
+  // the level ending at ix, false when there is no room for it
+  inline bool Add( Levels& levels, size_t ix ) {
+    if ( Levels::c_nMax == levels.nLevel ) return false;
+    levels.rEnd[ levels.nLevel++ ] = uint16_t( ix );
+    return true;
+  }
+
+  // each set bit in the mask is a '/' at ixBase plus the bit's position
+  inline bool AddMask( Levels& levels, size_t ixBase, uint32_t mask ) {
+    while ( 0 != mask ) {
+      if ( !Add( levels, ixBase + __builtin_ctz( mask ) ) ) return false;
+      mask &= mask - 1;
+    }
+    return true;
+  }
+
+  bool SplitScalar( const char* p, size_t ix, size_t n, Levels& levels ) {
+    for ( ; ix < n; ++ix ) {
+      if ( '/' == p[ ix ] ) {
+        if ( !Add( levels, ix ) ) return false;
+      }
+    }
+    return true;
+  }
+
+#ifdef OU_MQTT_SIMD_X86
+
+  __attribute__(( target( "sse4.2" ) ))
+  bool SplitSse42( const char* p, size_t n, Levels& levels ) {
+    const __m128i slash( _mm_set1_epi8( '/' ) );
+    size_t ix {};
+    for ( ; ( ix + 16 ) <= n; ix += 16 ) {
+      const __m128i input( _mm_loadu_si128( reinterpret_cast<const __m128i*>( p + ix ) ) );
+      if ( !AddMask( levels, ix, uint32_t( _mm_movemask_epi8( _mm_cmpeq_epi8( input, slash ) ) ) ) ) return false;
+    }
+    return SplitScalar( p, ix, n, levels );
+  }
+
+  __attribute__(( target( "avx2" ) ))
+  bool SplitAvx2( const char* p, size_t n, Levels& levels ) {
+    const __m256i slash( _mm256_set1_epi8( '/' ) );
+    size_t ix {};
+    for ( ; ( ix + 32 ) <= n; ix += 32 ) {
+      const __m256i input( _mm256_loadu_si256( reinterpret_cast<const __m256i*>( p + ix ) ) );
+      if ( !AddMask( levels, ix, uint32_t( _mm256_movemask_epi8( _mm256_cmpeq_epi8( input, slash ) ) ) ) ) return false;
+    }
+    return SplitScalar( p, ix, n, levels );
+  }
+
+#endif // OU_MQTT_SIMD_X86
+
+} // namespace anonymous
+
+namespace ou {
+namespace mqtt {
+namespace topic {
+
+bool Match( const std::string_view& svFilter, const std::string_view& svTopic ) {
+
+  using size_type = std::string_view::size_type;
+
+  if ( svFilter.empty() || svTopic.empty() ) return false;
+
+  if ( ( '$' == svTopic[ 0 ] ) && ( ( '+' == svFilter[ 0 ] ) || ( '#' == svFilter[ 0 ] ) ) ) return false;
+
+  size_type ixFilter {};
+  size_type ixTopic {};
+
+  while ( true ) {
+
+    size_type ixFilterEnd = svFilter.find( '/', ixFilter );
+    if ( std::string_view::npos == ixFilterEnd ) ixFilterEnd = svFilter.size();
+    const std::string_view svFilterLevel( svFilter.substr( ixFilter, ixFilterEnd - ixFilter ) );
+
+    if ( "#" == svFilterLevel ) return true;
+
+    size_type ixTopicEnd = svTopic.find( '/', ixTopic );
+    if ( std::string_view::npos == ixTopicEnd ) ixTopicEnd = svTopic.size();
+    const std::string_view svTopicLevel( svTopic.substr( ixTopic, ixTopicEnd - ixTopic ) );
+
+    if ( ( "+" != svFilterLevel ) && ( svFilterLevel != svTopicLevel ) ) return false;
+
+    const bool bFilterEnd( svFilter.size() == ixFilterEnd );
+    const bool bTopicEnd( svTopic.size() == ixTopicEnd );
+
+    if ( bTopicEnd ) {
+      // 'a/#' matches 'a'
+      return bFilterEnd || ( "#" == svFilter.substr( ixFilterEnd + 1 ) );
+    }
+    if ( bFilterEnd ) return false;
+
+    ixFilter = ixFilterEnd + 1;
+    ixTopic = ixTopicEnd + 1;
+  }
+}
+
+bool Split( const std::string_view& sv, Levels& levels ) {
+  return Split( sv, levels, simd::Detect() );
+}
+
+bool Split( const std::string_view& sv, Levels& levels, simd::EIsa eIsa ) {
+
+  levels.nLevel = 0;
+  if ( 0xffff < sv.size() ) return false;
+
+  bool bOk;
+#ifdef OU_MQTT_SIMD_X86
+  const simd::EIsa eAvailable( simd::Detect() );
+  if ( ( simd::EIsa::avx2 == eIsa ) && ( simd::EIsa::avx2 == eAvailable ) ) bOk = SplitAvx2( sv.data(), sv.size(), levels );
+  else if ( ( simd::EIsa::sse42 == eIsa ) && ( simd::EIsa::scalar != eAvailable ) ) bOk = SplitSse42( sv.data(), sv.size(), levels );
+  else bOk = SplitScalar( sv.data(), 0, sv.size(), levels );
+#else
+  (void)eIsa;
+  bOk = SplitScalar( sv.data(), 0, sv.size(), levels );
+#endif
+
+  return bOk && Add( levels, sv.size() ); // the last level ends with the string
+}
+
+bool Match( const std::string_view& svFilter, const Levels& levelsFilter, const std::string_view& svTopic, const Levels& levelsTopic ) {
+
+  if ( svFilter.empty() || svTopic.empty() ) return false;
+
+  if ( ( '$' == svTopic[ 0 ] ) && ( ( '+' == svFilter[ 0 ] ) || ( '#' == svFilter[ 0 ] ) ) ) return false;
+
+  size_t ix {};
+  for ( ; ix < levelsFilter.nLevel; ++ix ) {
+    const std::string_view svFilterLevel( levelsFilter.Level( svFilter, ix ) );
+    if ( "#" == svFilterLevel ) return true; // before running out of topic, 'a/#' matches 'a'
+    if ( ix == levelsTopic.nLevel ) return false;
+    if ( ( "+" != svFilterLevel ) && ( svFilterLevel != levelsTopic.Level( svTopic, ix ) ) ) return false;
+  }
+  return ix == levelsTopic.nLevel;
+}
+
+EShared Shared( const std::string_view& svSubscription, std::string_view& svGroup, std::string_view& svFilter ) {
+
+  const std::string_view svShare( c_szShare );
+  if ( svShare != svSubscription.substr( 0, svShare.size() ) ) return EShared::no;
+
+  const std::string_view svRest( svSubscription.substr( svShare.size() ) );
+  const std::string_view::size_type ixSlash( svRest.find( '/' ) );
+  if ( std::string_view::npos == ixSlash ) return EShared::malformed;
+
+  svGroup = svRest.substr( 0, ixSlash );
+  svFilter = svRest.substr( ixSlash + 1 );
+  if ( svGroup.empty() || svFilter.empty() ) return EShared::malformed;
+  if ( std::string_view::npos != svGroup.find_first_of( "+#" ) ) return EShared::malformed;
+  return EShared::yes;
+}
+
+} // namespace topic
+} // namespace mqtt
+} // namespace ou
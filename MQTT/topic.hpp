@@ -0,0 +1,66 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+ * File:    topic.hpp
+ * Project: Repertory/MQTT
+ * Author:  raymond@burkholder.net
+ * Created: October 19, 2026 10:41:52
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "simd.hpp"
+
+namespace ou {
+namespace mqtt {
+namespace topic {
+
+// mqtt 3.1.1 section 4.7: '+' matches one level, a trailing '#' matches the parent and all below,
+//   topics starting with '$' are not matched by a filter starting with a wildcard
+bool Match( const std::string_view& svFilter, const std::string_view& svTopic );
+
+// level boundaries, found once per topic with a vector compare against '/', so that each filter
+//   compares levels by offset rather than searching the topic again
+struct Levels {
+  static const size_t c_nMax = 32;
+  uint16_t rEnd[ c_nMax ]; // one past the last byte of each level
+  size_t nLevel;
+  std::string_view Level( const std::string_view& sv, size_t ix ) const {
+    const size_t ixBegin( 0 == ix ? 0 : rEnd[ ix - 1 ] + 1 );
+    return sv.substr( ixBegin, rEnd[ ix ] - ixBegin );
+  }
+};
+
+// false with more than c_nMax levels or more than 65535 bytes, callers fall back to Match above
+bool Split( const std::string_view&, Levels& ); // with simd::Detect()
+bool Split( const std::string_view&, Levels&, simd::EIsa );
+
+// as Match above, on strings already split
+bool Match( const std::string_view& svFilter, const Levels& levelsFilter, const std::string_view& svTopic, const Levels& levelsTopic );
+
+// shared subscriptions, "$share/<group>/<filter>", mqtt 5 section 4.8.2, mosquitto accepts them from 3.1.1 clients too
+//   the broker hands each matching message to one member of the group, on the message's own topic,
+//   so handlers are matched against <filter>
+const char c_szShare[] = "$share/";
+enum class EShared { no, yes, malformed }; // malformed: empty group, wildcard in the group, or no filter
+EShared Shared( const std::string_view& svSubscription, std::string_view& svGroup, std::string_view& svFilter );
+
+} // namespace topic
+} // namespace mqtt
+} // namespace ou
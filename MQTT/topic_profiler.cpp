@@ -0,0 +1,231 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+  File:    topic_profiler.cpp
+  Project: Repertory/MQTT
+  Author:  raymond@burkholder.net
+  Created: October 19, 2026 14:02:10
+*/
+
+#include <limits>
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+
+#include "hash.hpp"
+#include "topic_profiler.hpp"
+
+namespace {
+
+inline uint64_t Key( uint64_t hash ) { return ( 0 == hash ) ? 1 : hash; } // 0 is an empty member slot
+
+// rows are derived from the two halves of the fnv-1a Hash (Kirsch-Mitzenmacher)
+inline size_t Column( uint64_t hash, size_t ixRow, size_t nWidth ) {
+  const uint64_t h1( hash & 0xffffffff );
+  const uint64_t h2( ( hash >> 32 ) | 1 );
+  return ( h1 + ixRow * h2 ) % nWidth;
+}
+
+} // namespace anonymous
+
+namespace ou {
+namespace mqtt {
+
+TopicProfiler::TopicProfiler( size_t nWidth, size_t nDepth, size_t nTopK )
+: m_nWidth( nWidth ), m_nDepth( nDepth ), m_nTopK( nTopK )
+, m_start( clock_t_::now() )
+{
+  assert( 0 < nWidth );
+  assert( 0 < nDepth );
+  assert( 0 < nTopK );
+  for ( Direction& direction: m_direction ) {
+    direction.pMessage.reset( new std::atomic<uint64_t>[ m_nWidth * m_nDepth ]() );
+    direction.pBytes.reset( new std::atomic<uint64_t>[ m_nWidth * m_nDepth ]() );
+    direction.nMessage = 0;
+    direction.nBytes = 0;
+    size_t nMember( 4 );
+    while ( nMember < ( 4 * m_nTopK ) ) nMember *= 2; // load under a quarter
+    for ( TopK* pTopK: { &direction.topByMessage, &direction.topByBytes } ) {
+      pTopK->vCandidate.resize( m_nTopK );
+      pTopK->nThreshold = 0;
+      pTopK->nUsed = 0;
+      pTopK->pMember.reset( new std::atomic<uint64_t>[ nMember ]() );
+      pTopK->maskMember = nMember - 1;
+    }
+  }
+}
+
+uint64_t TopicProfiler::Add( const pSketch_t& pSketch, uint64_t hash, uint64_t n ) {
+  uint64_t nEstimate( std::numeric_limits<uint64_t>::max() );
+  for ( size_t ixRow = 0; ixRow < m_nDepth; ++ixRow ) {
+    std::atomic<uint64_t>& cell( pSketch[ ixRow * m_nWidth + Column( hash, ixRow, m_nWidth ) ] );
+    nEstimate = std::min<uint64_t>( nEstimate, cell.fetch_add( n, std::memory_order_relaxed ) + n );
+  }
+  return nEstimate;
+}
+
+uint64_t TopicProfiler::Estimate( const pSketch_t& pSketch, uint64_t hash ) const {
+  uint64_t nEstimate( std::numeric_limits<uint64_t>::max() );
+  for ( size_t ixRow = 0; ixRow < m_nDepth; ++ixRow ) {
+    const std::atomic<uint64_t>& cell( pSketch[ ixRow * m_nWidth + Column( hash, ixRow, m_nWidth ) ] );
+    nEstimate = std::min<uint64_t>( nEstimate, cell.load( std::memory_order_relaxed ) );
+  }
+  return nEstimate;
+}
+
+void TopicProfiler::Record( EDirection eDirection, const std::string_view& svTopic, size_t nBytes ) {
+
+  Direction& direction( m_direction[ static_cast<size_t>( eDirection ) ] );
+
+  direction.nMessage.fetch_add( 1, std::memory_order_relaxed );
+  direction.nBytes.fetch_add( nBytes, std::memory_order_relaxed );
+
+  const uint64_t hash( Hash( svTopic ) );
+  const uint64_t nEstimateMessage( Add( direction.pMessage, hash, 1 ) );
+  const uint64_t nEstimateBytes( Add( direction.pBytes, hash, nBytes ) );
+
+  // the common cases, a topic too small to matter or one already held, are decided without the lock,
+  //   a held topic's growth is read from the sketch when needed, so only an entry or a stale minimum locks
+  const bool bMessage(
+       ( nEstimateMessage >= direction.topByMessage.nThreshold.load( std::memory_order_relaxed ) )
+    && !Member( direction.topByMessage, hash ) );
+  const bool bBytes(
+       ( nEstimateBytes >= direction.topByBytes.nThreshold.load( std::memory_order_relaxed ) )
+    && !Member( direction.topByBytes, hash ) );
+
+  if ( bMessage || bBytes ) {
+    std::lock_guard<std::mutex> lock( m_mutex );
+    if ( bMessage ) Offer( direction.topByMessage, direction.pMessage, hash, svTopic, nEstimateMessage );
+    if ( bBytes ) Offer( direction.topByBytes, direction.pBytes, hash, svTopic, nEstimateBytes );
+  }
+}
+
+bool TopicProfiler::Member( const TopK& top, uint64_t hash ) const {
+  const uint64_t key( Key( hash ) );
+  size_t ix( key & top.maskMember );
+  while ( true ) {
+    const uint64_t slot( top.pMember[ ix ].load( std::memory_order_relaxed ) );
+    if ( key == slot ) return true;
+    if ( 0 == slot ) return false;
+    ix = ( ix + 1 ) & top.maskMember;
+  }
+}
+
+void TopicProfiler::Index( TopK& top ) {
+  for ( size_t ix = 0; ix <= top.maskMember; ++ix ) top.pMember[ ix ].store( 0, std::memory_order_relaxed );
+  for ( size_t ixCandidate = 0; ixCandidate < top.nUsed; ++ixCandidate ) {
+    const uint64_t key( Key( top.vCandidate[ ixCandidate ].hash ) );
+    size_t ix( key & top.maskMember );
+    while ( 0 != top.pMember[ ix ].load( std::memory_order_relaxed ) ) ix = ( ix + 1 ) & top.maskMember;
+    top.pMember[ ix ].store( key, std::memory_order_relaxed );
+  }
+}
+
+void TopicProfiler::Offer( TopK& top, const pSketch_t& pSketch, uint64_t hash, const std::string_view& svTopic, uint64_t nEstimate ) {
+
+  const size_t nLength( std::min<size_t>( svTopic.size(), c_nTopicMax ) );
+
+  auto threshold = [this,&top](){
+    if ( m_nTopK == top.nUsed ) {
+      uint64_t nMin( std::numeric_limits<uint64_t>::max() );
+      for ( const Candidate& candidate: top.vCandidate ) nMin = std::min<uint64_t>( nMin, candidate.nEstimate );
+      top.nThreshold.store( nMin, std::memory_order_relaxed );
+    }
+  };
+
+  // held estimates go stale while their topics skip the lock, refresh them before choosing whom to evict
+  Candidate* pMin( nullptr );
+  for ( size_t ix = 0; ix < top.nUsed; ++ix ) {
+    Candidate& candidate( top.vCandidate[ ix ] );
+    if ( ( hash == candidate.hash ) && ( nLength == candidate.nLength ) && ( 0 == std::memcmp( candidate.topic.data(), svTopic.data(), nLength ) ) ) {
+      candidate.nEstimate = std::max<uint64_t>( candidate.nEstimate, nEstimate ); // raced an Index
+      threshold();
+      return;
+    }
+    candidate.nEstimate = std::max<uint64_t>( candidate.nEstimate, Estimate( pSketch, candidate.hash ) );
+    if ( ( nullptr == pMin ) || ( candidate.nEstimate < pMin->nEstimate ) ) pMin = &candidate;
+  }
+
+  Candidate* pSlot( nullptr );
+  if ( top.nUsed < m_nTopK ) {
+    pSlot = &top.vCandidate[ top.nUsed++ ];
+  }
+  else {
+    assert( pMin );
+    if ( nEstimate > pMin->nEstimate ) pSlot = pMin;
+  }
+
+  if ( pSlot ) {
+    pSlot->hash = hash;
+    pSlot->nEstimate = nEstimate;
+    pSlot->nLength = nLength;
+    std::memcpy( pSlot->topic.data(), svTopic.data(), nLength );
+    Index( top );
+  }
+  threshold(); // raised by the refresh even when nothing entered
+}
+
+TopicProfiler::vEntry_t TopicProfiler::Sorted( const Direction& direction, const TopK& top, bool bByBytes ) const {
+  vEntry_t vEntry;
+  vEntry.reserve( top.nUsed );
+  for ( size_t ix = 0; ix < top.nUsed; ++ix ) {
+    const Candidate& candidate( top.vCandidate[ ix ] );
+    vEntry.emplace_back( Entry{
+      std::string( candidate.topic.data(), candidate.nLength )
+    , Estimate( direction.pMessage, candidate.hash )
+    , Estimate( direction.pBytes, candidate.hash )
+    } );
+  }
+  std::sort(
+    vEntry.begin(), vEntry.end(),
+    [bByBytes]( const Entry& lhs, const Entry& rhs ){
+      return bByBytes ? ( lhs.nBytes > rhs.nBytes ) : ( lhs.nMessage > rhs.nMessage );
+    } );
+  return vEntry;
+}
+
+TopicProfiler::Report TopicProfiler::Take( EDirection eDirection ) const {
+  const Direction& direction( m_direction[ static_cast<size_t>( eDirection ) ] );
+  std::lock_guard<std::mutex> lock( m_mutex );
+  return Report{
+    std::chrono::duration<double>( clock_t_::now() - m_start ).count()
+  , direction.nMessage.load( std::memory_order_relaxed )
+  , direction.nBytes.load( std::memory_order_relaxed )
+  , Sorted( direction, direction.topByMessage, false )
+  , Sorted( direction, direction.topByBytes, true )
+  };
+}
+
+// concurrent Record calls may straddle the reset, which only skews the next report slightly
+void TopicProfiler::Reset() {
+  std::lock_guard<std::mutex> lock( m_mutex );
+  for ( Direction& direction: m_direction ) {
+    for ( size_t ix = 0; ix < m_nWidth * m_nDepth; ++ix ) {
+      direction.pMessage[ ix ].store( 0, std::memory_order_relaxed );
+      direction.pBytes[ ix ].store( 0, std::memory_order_relaxed );
+    }
+    direction.nMessage.store( 0, std::memory_order_relaxed );
+    direction.nBytes.store( 0, std::memory_order_relaxed );
+    for ( TopK* pTopK: { &direction.topByMessage, &direction.topByBytes } ) {
+      pTopK->nUsed = 0;
+      pTopK->nThreshold.store( 0, std::memory_order_relaxed );
+      Index( *pTopK );
+    }
+  }
+  m_start = clock_t_::now();
+}
+
+} // namespace mqtt
+} // namespace ou
@@ -0,0 +1,125 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+ * File:    topic_profiler.hpp
+ * Project: Repertory/MQTT
+ * Author:  raymond@burkholder.net
+ * Created: October 19, 2026 14:02:10
+ */
+
+// approximate heavy hitters by message count and by bytes, in fixed memory regardless of topic count:
+//   a count-min sketch estimates each topic's totals, a small table keeps the top K by estimate
+//   estimates never under count, they over count by at most ~ e/width of the total with probability 1 - e^-depth
+
+#pragma once
+
+#include <mutex>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <string_view>
+
+namespace ou {
+namespace mqtt {
+
+class TopicProfiler {
+public:
+
+  enum class EDirection { outbound = 0, inbound = 1 };
+
+  TopicProfiler( size_t nWidth = 2048, size_t nDepth = 4, size_t nTopK = 16 );
+
+  void Record( EDirection, const std::string_view& svTopic, size_t nBytes );
+
+  struct Entry {
+    std::string sTopic; // truncated to c_nTopicMax
+    uint64_t nMessage;  // estimate
+    uint64_t nBytes;    // estimate
+  };
+  using vEntry_t = std::vector<Entry>;
+
+  struct Report {
+    double dblSeconds; // since construction or Reset, for rates
+    uint64_t nMessage; // exact totals
+    uint64_t nBytes;
+    vEntry_t vByMessage; // descending
+    vEntry_t vByBytes;   // descending
+  };
+
+  Report Take( EDirection ) const;
+  void Reset();
+
+  static const size_t c_nTopicMax = 96;
+
+protected:
+private:
+
+  using clock_t_ = std::chrono::steady_clock;
+
+  struct Candidate {
+    uint64_t hash;
+    uint64_t nEstimate;
+    uint16_t nLength;
+    std::array<char, c_nTopicMax> topic;
+  };
+  using vCandidate_t = std::vector<Candidate>; // sized once, never grows
+
+  using pMember_t = std::unique_ptr<std::atomic<uint64_t>[]>;
+
+  struct TopK {
+    vCandidate_t vCandidate;
+    std::atomic<uint64_t> nThreshold; // smallest estimate held once full, checked before taking the lock
+    size_t nUsed;
+    // candidate hashes, open addressed, so a topic already held skips the lock, rebuilt under the lock on a change,
+    //   a reader racing the rebuild at worst takes the lock needlessly or misses one offer
+    pMember_t pMember;
+    size_t maskMember;
+  };
+
+  using pSketch_t = std::unique_ptr<std::atomic<uint64_t>[]>; // depth x width
+
+  struct Direction {
+    pSketch_t pMessage;
+    pSketch_t pBytes;
+    std::atomic<uint64_t> nMessage;
+    std::atomic<uint64_t> nBytes;
+    TopK topByMessage;
+    TopK topByBytes;
+  };
+
+  const size_t m_nWidth;
+  const size_t m_nDepth;
+  const size_t m_nTopK;
+
+  mutable std::mutex m_mutex; // top K tables
+  clock_t_::time_point m_start;
+
+  std::array<Direction, 2> m_direction;
+
+  bool Member( const TopK&, uint64_t hash ) const;
+  void Index( TopK& ); // under the lock
+  void Offer( TopK&, const pSketch_t&, uint64_t hash, const std::string_view& svTopic, uint64_t nEstimate );
+  vEntry_t Sorted( const Direction&, const TopK&, bool bByBytes ) const;
+  uint64_t Add( const pSketch_t&, uint64_t hash, uint64_t n );
+  uint64_t Estimate( const pSketch_t&, uint64_t hash ) const;
+
+};
+
+} // namespace mqtt
+} // namespace ou
@@ -0,0 +1,187 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+  File:    topic_template.cpp
+  Project: Repertory/MQTT
+  Author:  raymond@burkholder.net
+  Created: October 19, 2026 18:42:10
+*/
+
+#include <cassert>
+#include <charconv>
+#include <cstring>
+
+#include "hash.hpp"
+#include "topic_template.hpp"
+
+namespace ou {
+namespace mqtt {
+namespace topic {
+
+// ==== Intern
+
+Intern::Intern()
+: m_maskIndex( 255 )
+{
+  m_vIndex.resize( m_maskIndex + 1, 0 );
+}
+
+Intern::id_t Intern::Find( const std::string_view& svTopic ) const {
+  size_t ixIndex( Hash( svTopic ) & m_maskIndex );
+  while ( 0 != m_vIndex[ ixIndex ] ) {
+    const id_t id( m_vIndex[ ixIndex ] - 1 );
+    if ( svTopic == m_dequeTopic[ id ] ) return id;
+    ixIndex = ( ixIndex + 1 ) & m_maskIndex;
+  }
+  return npos;
+}
+
+Intern::id_t Intern::Id( const std::string_view& svTopic ) {
+
+  size_t ixIndex( Hash( svTopic ) & m_maskIndex );
+  while ( 0 != m_vIndex[ ixIndex ] ) {
+    const id_t id( m_vIndex[ ixIndex ] - 1 );
+    if ( svTopic == m_dequeTopic[ id ] ) return id;
+    ixIndex = ( ixIndex + 1 ) & m_maskIndex;
+  }
+
+  const id_t id( m_dequeTopic.size() );
+  assert( npos != id );
+  m_dequeTopic.emplace_back( svTopic );
+  m_vIndex[ ixIndex ] = id + 1;
+
+  if ( ( 2 * m_dequeTopic.size() ) > m_maskIndex ) { // keep the load under a half
+    m_maskIndex = 2 * m_maskIndex + 1;
+    m_vIndex.assign( m_maskIndex + 1, 0 );
+    for ( id_t idRehash = 0; idRehash < m_dequeTopic.size(); ++idRehash ) {
+      size_t ix( Hash( m_dequeTopic[ idRehash ] ) & m_maskIndex );
+      while ( 0 != m_vIndex[ ix ] ) ix = ( ix + 1 ) & m_maskIndex;
+      m_vIndex[ ix ] = idRehash + 1;
+    }
+  }
+  return id;
+}
+
+// ==== Template
+
+Template::Template( const std::string_view& svPattern )
+: m_sPattern( svPattern ), m_nLeading {}
+{
+  if ( svPattern.empty() ) throw template_error( "topic template: empty pattern" );
+  if ( Buffer::c_nCapacity < svPattern.size() ) throw template_error( "topic template: pattern too long" );
+
+  size_t nLiteral {};
+  size_t ix {};
+  while ( ix < svPattern.size() ) {
+    const char ch( svPattern[ ix ] );
+    if ( '{' == ch ) {
+      if ( ( ( ix + 2 ) >= svPattern.size() ) || ( '}' != svPattern[ ix + 2 ] ) ) {
+        throw template_error( "topic template: unterminated placeholder in " + m_sPattern );
+      }
+      EKind eKind;
+      switch ( svPattern[ ix + 1 ] ) {
+        case 'u': eKind = EKind::unsigned_; break;
+        case 'i': eKind = EKind::signed_; break;
+        case 's': eKind = EKind::text; break;
+        default:
+          throw template_error( "topic template: unknown placeholder in " + m_sPattern );
+      }
+      if ( m_vField.empty() ) m_nLeading = nLiteral;
+      else m_vField.back().nLiteral = nLiteral;
+      m_vField.emplace_back( Field{ eKind, m_sLiteral.size(), 0 } );
+      nLiteral = 0;
+      ix += 3;
+    }
+    else {
+      if ( ( '+' == ch ) || ( '#' == ch ) || ( '\0' == ch ) || ( '}' == ch ) ) {
+        throw template_error( "topic template: invalid character in " + m_sPattern );
+      }
+      m_sLiteral.push_back( ch );
+      ++nLiteral;
+      ++ix;
+    }
+  }
+  if ( m_vField.empty() ) m_nLeading = nLiteral;
+  else m_vField.back().nLiteral = nLiteral;
+}
+
+bool Template::Literal( Buffer& buffer, size_t ixField ) const {
+  size_t ix;
+  size_t n;
+  if ( 0 == ixField ) {
+    ix = 0;
+    n = m_nLeading;
+  }
+  else {
+    const Field& field( m_vField[ ixField - 1 ] );
+    ix = field.ixLiteral;
+    n = field.nLiteral;
+  }
+  if ( ( Buffer::c_nCapacity - buffer.m_nSize ) < n ) return false;
+  std::memcpy( buffer.m_buf + buffer.m_nSize, m_sLiteral.data() + ix, n );
+  buffer.m_nSize += n;
+  return true;
+}
+
+bool Template::PutUnsigned( Buffer& buffer, size_t ixField, uint64_t value ) const {
+  switch ( m_vField[ ixField ].eKind ) {
+    case EKind::unsigned_:
+      break;
+    case EKind::signed_:
+      if ( uint64_t( INT64_MAX ) < value ) return false;
+      break;
+    default:
+      return false;
+  }
+  char* end( buffer.m_buf + Buffer::c_nCapacity );
+  const std::to_chars_result conversion = std::to_chars( buffer.m_buf + buffer.m_nSize, end, value );
+  if ( std::errc() != conversion.ec ) return false;
+  buffer.m_nSize = conversion.ptr - buffer.m_buf;
+  return true;
+}
+
+bool Template::PutSigned( Buffer& buffer, size_t ixField, int64_t value ) const {
+  switch ( m_vField[ ixField ].eKind ) {
+    case EKind::unsigned_:
+      if ( 0 > value ) return false;
+      break;
+    case EKind::signed_:
+      break;
+    default:
+      return false;
+  }
+  char* end( buffer.m_buf + Buffer::c_nCapacity );
+  const std::to_chars_result conversion = std::to_chars( buffer.m_buf + buffer.m_nSize, end, value );
+  if ( std::errc() != conversion.ec ) return false;
+  buffer.m_nSize = conversion.ptr - buffer.m_buf;
+  return true;
+}
+
+bool Template::PutText( Buffer& buffer, size_t ixField, const std::string_view& sv ) const {
+  if ( EKind::text != m_vField[ ixField ].eKind ) return false;
+  if ( sv.empty() ) return false; // would collapse a level
+  if ( ( Buffer::c_nCapacity - buffer.m_nSize ) < sv.size() ) return false;
+  char* p( buffer.m_buf + buffer.m_nSize );
+  for ( const char ch: sv ) {
+    if ( ( '/' == ch ) || ( '+' == ch ) || ( '#' == ch ) || ( '\0' == ch ) ) return false;
+    *p++ = ch;
+  }
+  buffer.m_nSize += sv.size();
+  return true;
+}
+
+} // namespace topic
+} // namespace mqtt
+} // namespace ou
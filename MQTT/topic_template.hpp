@@ -0,0 +1,159 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+ * File:    topic_template.hpp
+ * Project: Repertory/MQTT
+ * Author:  raymond@burkholder.net
+ * Created: October 19, 2026 18:42:10
+ */
+
+// parameterised topics, parsed once, rendered without heap allocation
+//
+//   Template t( "site/{s}/sensor/{u}/temp" );
+//   topic::Buffer buffer;
+//   if ( t.Render( buffer, sSite, nSensor ) ) mqtt.Publish( buffer, svMessage, ... );
+//
+//   placeholders: {u} unsigned integer, {i} signed integer, {s} text
+//   an argument of the wrong kind, a negative {u}, empty text or text containing '/', '+', '#' or NUL,
+//   the wrong number of arguments, or a topic longer than the buffer, renders nothing and returns false
+//
+//   Intern maps rendered topics to stable handles, allocating only the first time a topic is seen
+
+#pragma once
+
+#include <deque>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+namespace ou {
+namespace mqtt {
+namespace topic {
+
+struct template_error: std::runtime_error {
+  template_error( const std::string& e ): std::runtime_error( e ) {}
+};
+
+class Buffer {
+public:
+
+  static constexpr size_t c_nCapacity = 256;
+
+  Buffer(): m_nSize {} { m_buf[ 0 ] = '\0'; }
+
+  // NUL terminated, as Transport::Publish requires
+  std::string_view View() const { return std::string_view( m_buf, m_nSize ); }
+  operator std::string_view() const { return View(); }
+
+protected:
+private:
+  friend class Template;
+  size_t m_nSize;
+  char m_buf[ c_nCapacity + 1 ];
+};
+
+class Intern {
+public:
+
+  using id_t = uint32_t;
+  static constexpr id_t npos = ~id_t( 0 );
+
+  Intern();
+
+  id_t Id( const std::string_view& svTopic ); // adds on first sight
+  id_t Find( const std::string_view& svTopic ) const; // npos when not present
+  const std::string& Topic( id_t id ) const { return m_dequeTopic[ id ]; } // stable for the life of the instance
+
+  size_t Size() const { return m_dequeTopic.size(); }
+
+protected:
+private:
+  std::deque<std::string> m_dequeTopic; // by id, a deque so references survive growth
+  std::vector<id_t> m_vIndex; // id + 1, 0 is empty
+  size_t m_maskIndex;
+};
+
+class Template {
+public:
+
+  explicit Template( const std::string_view& svPattern ); // template_error
+
+  size_t Arity() const { return m_vField.size(); }
+  const std::string& Pattern() const { return m_sPattern; }
+
+  template<typename... Args>
+  bool Render( Buffer& buffer, const Args&... args ) const {
+    buffer.m_nSize = 0;
+    if ( sizeof...( Args ) != m_vField.size() ) return false;
+    size_t ixField {};
+    const bool bOk( ( Literal( buffer, 0 ) && ... && ( Put( buffer, ixField, args ) && Literal( buffer, ++ixField ) ) ) );
+    if ( !bOk ) buffer.m_nSize = 0;
+    buffer.m_buf[ buffer.m_nSize ] = '\0';
+    return bOk;
+  }
+
+  // Intern::npos when Render fails
+  template<typename... Args>
+  Intern::id_t Id( Intern& intern, const Args&... args ) const {
+    Buffer buffer;
+    return Render( buffer, args... ) ? intern.Id( buffer.View() ) : Intern::npos;
+  }
+
+protected:
+private:
+
+  enum class EKind: char { unsigned_ = 'u', signed_ = 'i', text = 's' };
+
+  struct Field {
+    EKind eKind;
+    size_t ixLiteral; // literal following the field: offset, length into m_sLiteral
+    size_t nLiteral;
+  };
+
+  const std::string m_sPattern;
+  std::string m_sLiteral;  // literal text, concatenated
+  size_t m_nLeading;       // literal before the first field
+  std::vector<Field> m_vField;
+
+  bool Literal( Buffer&, size_t ixField ) const; // the literal before field ixField, or the tail
+  bool PutUnsigned( Buffer&, size_t ixField, uint64_t ) const;
+  bool PutSigned( Buffer&, size_t ixField, int64_t ) const;
+  bool PutText( Buffer&, size_t ixField, const std::string_view& ) const;
+
+  template<typename T>
+  bool Put( Buffer& buffer, size_t ixField, const T& value ) const {
+    if constexpr ( std::is_same_v<T, bool> ) {
+      static_assert( !std::is_same_v<T, bool>, "bool is not a topic placeholder type" );
+      return false;
+    }
+    else if constexpr ( std::is_integral_v<T> && std::is_signed_v<T> ) {
+      return PutSigned( buffer, ixField, value );
+    }
+    else if constexpr ( std::is_integral_v<T> ) {
+      return PutUnsigned( buffer, ixField, value );
+    }
+    else {
+      return PutText( buffer, ixField, std::string_view( value ) );
+    }
+  }
+
+};
+
+} // namespace topic
+} // namespace mqtt
+} // namespace ou
@@ -0,0 +1,77 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+ * File:    transport.hpp
+ * Project: Repertory/MQTT
+ * Author:  raymond@burkholder.net
+ * Created: October 19, 2026 10:05:17
+ */
+
+// the wire underneath ou::Mqtt: paho (transport_paho.hpp) or in-process (loopback.hpp)
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <functional>
+#include <string_view>
+
+#include "config.hpp"
+
+namespace ou {
+namespace mqtt {
+
+// return codes, values align with paho's MQTTCLIENT_* codes so they pass straight through
+namespace result {
+  const int success( 0 );
+  const int failure( -1 );
+  const int disconnected( -3 );
+  const int max_inflight( -4 );
+  const int expired( -100 ); // not from paho: the publish deadline passed before the message was sent
+} // namespace result
+
+class Transport {
+public:
+
+  using token_t = int;
+
+  // callbacks arrive on the transport's own thread
+  using fConnectionLost_t = std::function<void( const char* szCause )>;
+  using fMessageArrived_t = std::function<void( const std::string_view& svTopic, const std::string_view& svMessage )>;
+  using fDeliveryComplete_t = std::function<void( token_t )>; // qos 1 only
+
+  virtual ~Transport() {}
+
+  // result::success or an error code
+  virtual int Create( const Config&, const std::string& sId ) = 0;
+  virtual void SetCallbacks( fConnectionLost_t&&, fMessageArrived_t&&, fDeliveryComplete_t&& ) = 0;
+
+  virtual int Connect() = 0; // blocks for up to the connect timeout
+  // last will, given to the broker by each later Connect, an empty topic clears it, may be called from any thread
+  virtual int SetWill( const std::string_view& /* svTopic */, const std::string_view& /* svMessage */, int /* nQoS */ ) { return result::failure; }
+  virtual int Disconnect( int msTimeout ) = 0;
+  virtual bool IsConnected() = 0;
+
+  // svTopic must be NUL terminated in the underlying buffer
+  virtual int Publish( const std::string_view& svTopic, const std::string_view& svMessage, int nQoS, token_t& ) = 0;
+  virtual int Subscribe( const std::string_view& svTopic, int nQoS ) = 0;
+  virtual int UnSubscribe( const std::string_view& svTopic ) = 0;
+
+};
+
+using pTransport_t = std::unique_ptr<Transport>;
+
+} // namespace mqtt
+} // namespace ou
@@ -0,0 +1,847 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+  File:    transport_asio.cpp
+  Project: Repertory/MQTT
+  Author:  raymond@burkholder.net
+  Created: October 20, 2026 00:34:51
+  mqtt 3.1.1: http://docs.oasis-open.org/mqtt/mqtt/v3.1.1/os/mqtt-v3.1.1-os.html
+*/
+
+#include <mutex>
+#include <atomic>
+#include <future>
+#include <vector>
+#include <cerrno>
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+
+#include <sys/uio.h>
+#include <sys/socket.h>
+
+#include <boost/asio/post.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/asio/connect.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#include <thread.hpp>
+
+#include "transport_asio.hpp"
+
+namespace asio = boost::asio;
+
+namespace {
+
+  // control packet types, the high nibble of the first byte, section 2.2.1
+  const uint8_t c_connect     = 0x10;
+  const uint8_t c_connack     = 0x20;
+  const uint8_t c_publish     = 0x30;
+  const uint8_t c_puback      = 0x40;
+  const uint8_t c_pubrec      = 0x50;
+  const uint8_t c_pubrel      = 0x60;
+  const uint8_t c_pubcomp     = 0x70;
+  const uint8_t c_subscribe   = 0x82; // with the reserved flags, section 3.8.1
+  const uint8_t c_suback      = 0x90;
+  const uint8_t c_unsubscribe = 0xa2;
+  const uint8_t c_unsuback    = 0xb0;
+  const uint8_t c_pingreq     = 0xc0;
+  const uint8_t c_pingresp    = 0xd0;
+  const uint8_t c_disconnect  = 0xe0;
+
+  const size_t c_nRemainingMax( 268435455 ); // four bytes of remaining length
+  const size_t c_nRead( 64 * 1024 );
+
+  // remaining length, section 2.2.3, returns the bytes written, at most 4
+  size_t EncodeLength( uint8_t* p, size_t n ) {
+    size_t ix {};
+    do {
+      uint8_t byte( n & 0x7f );
+      n >>= 7;
+      if ( 0 < n ) byte |= 0x80;
+      p[ ix++ ] = byte;
+    } while ( 0 < n );
+    return ix;
+  }
+
+  inline uint16_t U16( const uint8_t* p ) {
+    return uint16_t( ( p[ 0 ] << 8 ) | p[ 1 ] );
+  }
+
+  void AppendU16( std::string& s, size_t n ) {
+    s += char( ( n >> 8 ) & 0xff );
+    s += char( n & 0xff );
+  }
+
+  void AppendString( std::string& s, const std::string_view& sv ) {
+    AppendU16( s, sv.size() );
+    s.append( sv.data(), sv.size() );
+  }
+
+} // namespace anonymous
+
+namespace ou {
+namespace mqtt {
+
+struct TransportAsio::State: public std::enable_shared_from_this<State> {
+
+  using tcp = asio::ip::tcp;
+  using strand_t = asio::strand<asio::any_io_executor>;
+  using pPromiseConnect_t = std::shared_ptr<std::promise<int>>;
+  using pPromiseClose_t = std::shared_ptr<std::promise<void>>;
+
+  const Config config;
+
+  asio::io_context* pio; // behind the executor, nullptr when it is not an io_context
+  strand_t strand;
+  tcp::resolver resolver;
+  tcp::socket socket;
+  asio::steady_timer timerKeepAlive;
+
+  std::string sHost;
+  std::string sPort;
+  std::string sId;
+  std::string sUserName;
+  std::string sPassword;
+
+  std::mutex mutexWill;
+  std::string sWillTopic;
+  std::string sWillMessage;
+  int nWillQoS;
+
+  fConnectionLost_t fConnectionLost;
+  fMessageArrived_t fMessageArrived;
+  fDeliveryComplete_t fDeliveryComplete;
+
+  std::atomic<bool> bConnected; // connack accepted, neither lost nor closed since
+
+  // strand only
+  uint32_t generation; // changed on each attempt and each close, handlers of an earlier socket return
+  bool bPingOutstanding;
+  bool bClosing; // Disconnect waiting for the queue to be written
+  std::vector<uint8_t> vIn;
+  size_t nIn;
+  pPromiseConnect_t pConnect; // the waiting Connect, until connack
+  pPromiseClose_t pClose;     // the waiting Disconnect, until closed
+
+  // shared with the publishing threads
+  std::mutex mutexWrite;
+  bool bOpen; // socket connected, sends allowed
+  int fd;
+  uint32_t generationWrite; // of the open socket
+  bool bWriting; // an async_write is under way, later sends queue behind it
+  std::string sQueue;
+  std::string sWriting;
+  std::vector<bool> vInFlight; // by packet id
+  size_t nInFlight;
+  uint16_t idNext;
+
+  State( asio::any_io_executor executor, const Config& config_ )
+  : config( config_ )
+  , pio( Context( executor ) )
+  , strand( asio::make_strand( executor ) )
+  , resolver( strand )
+  , socket( strand )
+  , timerKeepAlive( strand )
+  , nWillQoS {}
+  , bConnected( false )
+  , generation {}
+  , bPingOutstanding( false )
+  , bClosing( false )
+  , vIn( c_nRead )
+  , nIn {}
+  , bOpen( false )
+  , fd( -1 )
+  , generationWrite {}
+  , bWriting( false )
+  , vInFlight( 0x10000, false )
+  , nInFlight {}
+  , idNext( 1 )
+  {}
+
+  // ==== any thread, mutexWrite held
+
+  bool AllocateId( uint16_t& id ) {
+    if ( config.nInFlight <= nInFlight ) return false;
+    while ( true ) { // terminates, fewer than 65535 are in flight
+      id = idNext++;
+      if ( 0 == idNext ) idNext = 1;
+      if ( !vInFlight[ id ] ) break;
+    }
+    vInFlight[ id ] = true;
+    ++nInFlight;
+    return true;
+  }
+
+  bool Release( uint16_t id ) {
+    if ( !vInFlight[ id ] ) return false;
+    vInFlight[ id ] = false;
+    --nInFlight;
+    return true;
+  }
+
+  int SendLocked( const iovec* riov, size_t niov ) {
+
+    if ( !bOpen ) return result::disconnected;
+
+    size_t nTotal {};
+    for ( size_t ix = 0; ix < niov; ++ix ) nTotal += riov[ ix ].iov_len;
+
+    size_t nSent {};
+    if ( !bWriting && sQueue.empty() ) {
+      // straight from the caller's buffers
+      msghdr msg {};
+      msg.msg_iov = const_cast<iovec*>( riov );
+      msg.msg_iovlen = niov;
+      const ssize_t nResult( ::sendmsg( fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT ) );
+      if ( 0 <= nResult ) nSent = nResult;
+      else if ( ( EAGAIN != errno ) && ( EWOULDBLOCK != errno ) && ( EINTR != errno ) ) {
+        PostLost( "send failed" );
+        return result::disconnected;
+      }
+      if ( nTotal == nSent ) return result::success;
+    }
+
+    // a partly sent packet has to be finished, whatever the queue
+    if ( ( 0 == nSent ) && ( config.nQueueMax < ( sQueue.size() + nTotal ) ) ) return result::max_inflight;
+
+    size_t nSkip( nSent );
+    for ( size_t ix = 0; ix < niov; ++ix ) {
+      const size_t nLength( riov[ ix ].iov_len );
+      if ( nSkip < nLength ) {
+        sQueue.append( reinterpret_cast<const char*>( riov[ ix ].iov_base ) + nSkip, nLength - nSkip );
+        nSkip = 0;
+      }
+      else nSkip -= nLength;
+    }
+
+    if ( !bWriting ) {
+      bWriting = true;
+      pState_t pState( shared_from_this() );
+      asio::post( strand, [pState](){ pState->Flush(); } );
+    }
+    return result::success;
+  }
+
+  int Send( const uint8_t* p, size_t n ) {
+    const iovec iov{ const_cast<uint8_t*>( p ), n };
+    std::lock_guard<std::mutex> lock( mutexWrite );
+    return SendLocked( &iov, 1 );
+  }
+
+  void PostLost( const char* szCause ) {
+    pState_t pState( shared_from_this() );
+    const uint32_t gen( generationWrite );
+    asio::post( strand, [pState,gen,szCause](){ if ( gen == pState->generation ) pState->Lost( szCause ); } );
+  }
+
+  static asio::io_context* Context( const asio::any_io_executor& executor ) {
+    const asio::io_context::executor_type* pExecutor( executor.target<asio::io_context::executor_type>() );
+    return ( nullptr == pExecutor ) ? nullptr : &pExecutor->context();
+  }
+
+  // on the strand, or in any other handler of its io_context, where waiting on the strand
+  //   would stall a single threaded loop for good
+  bool OnLoop() const {
+    return strand.running_in_this_thread() || ( ( nullptr != pio ) && pio->get_executor().running_in_this_thread() );
+  }
+
+  // ==== strand
+
+  void Start( pPromiseConnect_t pPromise ) {
+
+    Shut();
+    pConnect = pPromise;
+    bPingOutstanding = false;
+    nIn = 0;
+
+    pState_t pState( shared_from_this() );
+    const uint32_t gen( generation );
+    resolver.async_resolve(
+      sHost, sPort,
+      [pState,gen]( const boost::system::error_code& ec, tcp::resolver::results_type results ){
+        if ( gen != pState->generation ) return;
+        if ( ec ) {
+          pState->Failed( "resolve", ec );
+          return;
+        }
+        asio::async_connect(
+          pState->socket, results,
+          [pState,gen]( const boost::system::error_code& ec, const tcp::endpoint& ){
+            if ( gen != pState->generation ) return;
+            if ( ec ) pState->Failed( "connect", ec );
+            else pState->Opened();
+          } );
+      } );
+  }
+
+  void Failed( const char* szWhat, const boost::system::error_code& ec ) {
+    std::cerr << "mqtt " << szWhat << ' ' << sHost << ':' << sPort << " failed: " << ec.message() << std::endl;
+    Shut();
+    if ( pConnect ) {
+      pConnect->set_value( result::failure );
+      pConnect.reset();
+    }
+  }
+
+  void Opened() {
+
+    boost::system::error_code ec;
+    socket.set_option( tcp::no_delay( true ), ec );
+    socket.non_blocking( true, ec ); // sends from publishing threads must not block
+
+    const std::string sConnect( ConnectPacket() );
+    {
+      std::lock_guard<std::mutex> lock( mutexWrite );
+      bOpen = true;
+      fd = socket.native_handle();
+      generationWrite = generation;
+      const iovec iov{ const_cast<char*>( sConnect.data() ), sConnect.size() };
+      SendLocked( &iov, 1 );
+    }
+    Read();
+  }
+
+  std::string ConnectPacket() {
+
+    std::string sBody;
+    AppendString( sBody, "MQTT" );
+    sBody += char( 4 ); // protocol level, 3.1.1
+
+    uint8_t flags( 0x02 ); // clean session
+    {
+      std::lock_guard<std::mutex> lock( mutexWill );
+      if ( !sWillTopic.empty() ) flags |= 0x04 | ( ( nWillQoS & 3 ) << 3 );
+    }
+    if ( !sUserName.empty() ) {
+      flags |= 0x80;
+      if ( !sPassword.empty() ) flags |= 0x40;
+    }
+    sBody += char( flags );
+    AppendU16( sBody, config.keepalive.count() );
+
+    AppendString( sBody, sId );
+    if ( 0x04 & flags ) {
+      std::lock_guard<std::mutex> lock( mutexWill );
+      AppendString( sBody, sWillTopic );
+      AppendString( sBody, sWillMessage );
+    }
+    if ( 0x80 & flags ) AppendString( sBody, sUserName );
+    if ( 0x40 & flags ) AppendString( sBody, sPassword );
+
+    uint8_t rLength[ 4 ];
+    const size_t nLength( EncodeLength( rLength, sBody.size() ) );
+    std::string sPacket;
+    sPacket.reserve( 1 + nLength + sBody.size() );
+    sPacket += char( c_connect );
+    sPacket.append( reinterpret_cast<const char*>( rLength ), nLength );
+    sPacket += sBody;
+    return sPacket;
+  }
+
+  void Read() {
+    pState_t pState( shared_from_this() );
+    const uint32_t gen( generation );
+    socket.async_read_some(
+      asio::buffer( vIn.data() + nIn, vIn.size() - nIn ),
+      [pState,gen]( const boost::system::error_code& ec, size_t n ){
+        if ( gen != pState->generation ) return;
+        if ( ec ) {
+          pState->Lost( asio::error::eof == ec ? "closed by broker" : "read failed" );
+          return;
+        }
+        pState->nIn += n;
+        if ( pState->Parse() ) pState->Read();
+      } );
+  }
+
+  // false when the connection was lost or closed on the way
+  bool Parse() {
+
+    const uint32_t gen( generation );
+    size_t ix {};
+    size_t nNeed {};
+
+    while ( 2 <= ( nIn - ix ) ) {
+
+      const uint8_t* p( vIn.data() + ix );
+      const size_t nAvailable( nIn - ix );
+
+      size_t nRemaining {};
+      size_t nLength {};
+      for ( size_t ixByte = 1; ( 5 > ixByte ) && ( nAvailable > ixByte ); ++ixByte ) {
+        nRemaining |= size_t( p[ ixByte ] & 0x7f ) << ( 7 * ( ixByte - 1 ) );
+        if ( 0 == ( p[ ixByte ] & 0x80 ) ) {
+          nLength = ixByte;
+          break;
+        }
+      }
+      if ( 0 == nLength ) {
+        if ( 5 <= nAvailable ) {
+          Lost( "malformed packet" );
+          return false;
+        }
+        break; // length still arriving
+      }
+
+      const size_t nPacket( 1 + nLength + nRemaining );
+      if ( nAvailable < nPacket ) {
+        nNeed = nPacket;
+        break;
+      }
+
+      Handle( p[ 0 ], p + 1 + nLength, nRemaining ); // callbacks view the packet in place
+      if ( gen != generation ) return false;
+      ix += nPacket;
+    }
+
+    if ( 0 < ix ) {
+      std::memmove( vIn.data(), vIn.data() + ix, nIn - ix );
+      nIn -= ix;
+    }
+    if ( vIn.size() < nNeed ) vIn.resize( nNeed );
+    else if ( vIn.size() == nIn ) vIn.resize( 2 * vIn.size() );
+    return true;
+  }
+
+  void Handle( uint8_t type, const uint8_t* p, size_t n ) {
+
+    if ( ( c_publish != ( type & 0xf0 ) ) && ( c_connack != type ) && ( c_pingresp != type ) && ( 2 > n ) ) {
+      Lost( "malformed packet" );
+      return;
+    }
+
+    switch ( type & 0xf0 ) {
+      case c_connack:
+        if ( 2 > n ) {
+          Lost( "malformed connack" );
+        }
+        else if ( pConnect ) {
+          const int rc( p[ 1 ] ); // 1 to 5, refused, section 3.2.2.3
+          if ( 0 == rc ) {
+            bConnected.store( true, std::memory_order_release );
+            KeepAlive();
+          }
+          else {
+            std::cerr << "mqtt connect refused by broker: " << rc << std::endl;
+            Shut();
+          }
+          pConnect->set_value( rc );
+          pConnect.reset();
+        }
+        break;
+      case c_publish:
+        {
+          const int nQoS( ( type >> 1 ) & 3 );
+          if ( 2 > n ) {
+            Lost( "malformed publish" );
+            return;
+          }
+          const size_t nTopic( U16( p ) );
+          size_t ixPayload( 2 + nTopic );
+          uint16_t id {};
+          if ( 0 < nQoS ) {
+            if ( n >= ixPayload + 2 ) id = U16( p + ixPayload );
+            ixPayload += 2;
+          }
+          if ( ( n < ixPayload ) || ( 3 == nQoS ) ) {
+            Lost( "malformed publish" );
+            return;
+          }
+          if ( fMessageArrived ) {
+            fMessageArrived(
+              std::string_view( reinterpret_cast<const char*>( p + 2 ), nTopic ),
+              std::string_view( reinterpret_cast<const char*>( p + ixPayload ), n - ixPayload ) );
+          }
+          if ( 1 == nQoS ) Ack( c_puback, id );
+          else if ( 2 == nQoS ) Ack( c_pubrec, id );
+        }
+        break;
+      case c_puback:
+        {
+          const uint16_t id( U16( p ) );
+          bool bInFlight;
+          {
+            std::lock_guard<std::mutex> lock( mutexWrite );
+            bInFlight = Release( id );
+          }
+          if ( bInFlight && fDeliveryComplete ) fDeliveryComplete( id );
+        }
+        break;
+      case c_pubrel:
+        Ack( c_pubcomp, U16( p ) );
+        break;
+      case c_suback:
+        {
+          {
+            std::lock_guard<std::mutex> lock( mutexWrite );
+            Release( U16( p ) );
+          }
+          for ( size_t ix = 2; ix < n; ++ix ) {
+            if ( 0x80 == p[ ix ] ) std::cerr << "mqtt subscribe refused by broker" << std::endl;
+          }
+        }
+        break;
+      case c_unsuback:
+        {
+          std::lock_guard<std::mutex> lock( mutexWrite );
+          Release( U16( p ) );
+        }
+        break;
+      case c_pingresp:
+        bPingOutstanding = false;
+        break;
+      case c_pubrec: // not sent at qos 2, so not expected
+      default:
+        Lost( "unexpected packet" );
+        break;
+    }
+  }
+
+  void Ack( uint8_t type, uint16_t id ) {
+    const uint8_t rAck[ 4 ] = { type, 2, uint8_t( id >> 8 ), uint8_t( id & 0xff ) };
+    Send( rAck, sizeof( rAck ) );
+  }
+
+  void KeepAlive() {
+    pState_t pState( shared_from_this() );
+    const uint32_t gen( generation );
+    timerKeepAlive.expires_after( config.keepalive );
+    timerKeepAlive.async_wait(
+      [pState,gen]( const boost::system::error_code& ec ){
+        if ( ec || ( gen != pState->generation ) ) return;
+        if ( pState->bPingOutstanding ) {
+          pState->Lost( "keepalive timeout" );
+          return;
+        }
+        pState->bPingOutstanding = true;
+        const uint8_t rPing[ 2 ] = { c_pingreq, 0 };
+        pState->Send( rPing, sizeof( rPing ) );
+        pState->KeepAlive();
+      } );
+  }
+
+  // the queue, one async_write at a time, until empty
+  void Flush() {
+    std::unique_lock<std::mutex> lock( mutexWrite );
+    if ( !bOpen ) return;
+    if ( sQueue.empty() ) {
+      bWriting = false;
+      if ( bClosing ) {
+        lock.unlock();
+        Shut();
+      }
+      return;
+    }
+    sWriting.clear();
+    sWriting.swap( sQueue );
+    lock.unlock();
+
+    pState_t pState( shared_from_this() );
+    const uint32_t gen( generation );
+    asio::async_write(
+      socket, asio::buffer( sWriting ),
+      [pState,gen]( const boost::system::error_code& ec, size_t ){
+        if ( gen != pState->generation ) return;
+        if ( ec ) pState->Lost( "write failed" );
+        else pState->Flush();
+      } );
+  }
+
+  void Close( pPromiseClose_t pPromise ) {
+
+    bConnected.store( false, std::memory_order_release ); // no connection lost callback from here on
+    if ( pConnect ) {
+      pConnect->set_value( result::failure );
+      pConnect.reset();
+    }
+
+    pClose = pPromise;
+    std::unique_lock<std::mutex> lock( mutexWrite );
+    if ( bOpen ) {
+      const uint8_t rDisconnect[ 2 ] = { c_disconnect, 0 };
+      const iovec iov{ const_cast<uint8_t*>( rDisconnect ), sizeof( rDisconnect ) };
+      SendLocked( &iov, 1 );
+      if ( bWriting ) {
+        bClosing = true; // Flush closes once written
+        return;
+      }
+    }
+    lock.unlock();
+    Shut();
+  }
+
+  void Lost( const char* szCause ) {
+    const bool bWasConnected( bConnected.load( std::memory_order_acquire ) );
+    Shut();
+    if ( pConnect ) {
+      std::cerr << "mqtt connect " << sHost << ':' << sPort << ": " << szCause << std::endl;
+      pConnect->set_value( result::failure );
+      pConnect.reset();
+    }
+    if ( bWasConnected && fConnectionLost ) fConnectionLost( szCause );
+  }
+
+  // closes the socket with no callbacks, handlers still queued find the generation changed
+  void Shut() {
+    ++generation;
+    bConnected.store( false, std::memory_order_release );
+    bClosing = false;
+    {
+      std::lock_guard<std::mutex> lock( mutexWrite );
+      bOpen = false;
+      fd = -1;
+      bWriting = false; // a pending async_write completes cancelled, without reading sWriting
+      sQueue.clear();
+      std::fill( vInFlight.begin(), vInFlight.end(), false ); // clean session, lost in flight
+      nInFlight = 0;
+    }
+    boost::system::error_code ec;
+    resolver.cancel();
+    timerKeepAlive.cancel();
+    if ( socket.is_open() ) {
+      socket.shutdown( tcp::socket::shutdown_both, ec );
+      socket.close( ec );
+    }
+    if ( pClose ) {
+      pClose->set_value();
+      pClose.reset();
+    }
+  }
+
+};
+
+TransportAsio::TransportAsio( const Config& config )
+: m_pio( std::make_unique<asio::io_context>( 1 ) )
+, m_pWorkGuard( std::make_unique<work_guard_t>( asio::make_work_guard( *m_pio ) ) )
+, m_pState( std::make_shared<State>( m_pio->get_executor(), config ) )
+{
+  m_thread = std::thread( [this](){ ou::thread::Enter( "mqtt.asio" ); m_pio->run(); } );
+}
+
+TransportAsio::TransportAsio( asio::any_io_executor executor, const Config& config )
+: m_pState( std::make_shared<State>( executor, config ) )
+{}
+
+TransportAsio::~TransportAsio() {
+
+  pState_t pState( m_pState );
+  auto fShut = [pState](){
+    pState->fConnectionLost = nullptr;
+    pState->fMessageArrived = nullptr;
+    pState->fDeliveryComplete = nullptr;
+    if ( pState->pConnect ) {
+      pState->pConnect->set_value( result::failure );
+      pState->pConnect.reset();
+    }
+    pState->Shut();
+  };
+
+  if ( pState->OnLoop() ) fShut(); // nothing else runs on a single threaded loop meanwhile
+  else {
+    // no callback runs once this returns
+    std::promise<void> promise;
+    asio::post( pState->strand, [&fShut,&promise](){ fShut(); promise.set_value(); } );
+    promise.get_future().wait();
+  }
+
+  if ( m_pio ) {
+    m_pWorkGuard.reset(); // run returns once the cancelled handlers have completed
+    m_thread.join();
+  }
+}
+
+int TransportAsio::Create( const mqtt::Config& config, const std::string& sId ) {
+  State& state( *m_pState );
+  state.sHost = config.sHost;
+  state.sPort = config.sPort;
+  state.sId = sId;
+  state.sUserName = config.sUserName;
+  state.sPassword = config.sPassword;
+  return result::success;
+}
+
+void TransportAsio::SetCallbacks( fConnectionLost_t&& fConnectionLost, fMessageArrived_t&& fMessageArrived, fDeliveryComplete_t&& fDeliveryComplete ) {
+  // before Connect, nothing runs on the strand yet
+  State& state( *m_pState );
+  state.fConnectionLost = std::move( fConnectionLost );
+  state.fMessageArrived = std::move( fMessageArrived );
+  state.fDeliveryComplete = std::move( fDeliveryComplete );
+}
+
+int TransportAsio::Connect() {
+
+  pState_t pState( m_pState );
+  if ( pState->OnLoop() ) return result::failure; // would wait on itself
+
+  auto pPromise( std::make_shared<std::promise<int>>() );
+  std::future<int> future( pPromise->get_future() );
+  asio::post( pState->strand, [pState,pPromise](){ pState->Start( pPromise ); } );
+
+  if ( std::future_status::ready != future.wait_for( pState->config.timeout ) ) {
+    asio::post(
+      pState->strand,
+      [pState,pPromise](){
+        if ( pPromise == pState->pConnect ) {
+          std::cerr << "mqtt connect " << pState->sHost << ':' << pState->sPort << " timed out" << std::endl;
+          pState->pConnect.reset();
+          pState->Shut();
+        }
+      } );
+    return result::failure;
+  }
+  return future.get();
+}
+
+int TransportAsio::SetWill( const std::string_view& svTopic, const std::string_view& svMessage, int nQoS ) {
+  State& state( *m_pState );
+  std::lock_guard<std::mutex> lock( state.mutexWill );
+  state.sWillTopic = svTopic;
+  state.sWillMessage = svMessage;
+  state.nWillQoS = nQoS;
+  return result::success;
+}
+
+int TransportAsio::Disconnect( int msTimeout ) {
+
+  pState_t pState( m_pState );
+  if ( pState->OnLoop() ) return result::failure;
+
+  auto pPromise( std::make_shared<std::promise<void>>() );
+  std::future<void> future( pPromise->get_future() );
+  asio::post( pState->strand, [pState,pPromise](){ pState->Close( pPromise ); } );
+
+  if ( std::future_status::ready != future.wait_for( std::chrono::milliseconds( msTimeout ) ) ) {
+    asio::post( pState->strand, [pState](){ pState->Shut(); } ); // abandon what is still queued
+  }
+  return result::success;
+}
+
+bool TransportAsio::IsConnected() {
+  return m_pState->bConnected.load( std::memory_order_acquire );
+}
+
+int TransportAsio::Publish( const std::string_view& svTopic, const std::string_view& svMessage, int nQoS, token_t& token ) {
+
+  token = 0;
+  if ( ( 0 > nQoS ) || ( 1 < nQoS ) ) return result::failure;
+  if ( 0xffff < svTopic.size() ) return result::failure;
+
+  const size_t nVariable( 2 + svTopic.size() + ( 0 < nQoS ? 2 : 0 ) );
+  const size_t nRemaining( nVariable + svMessage.size() );
+  if ( c_nRemainingMax < nRemaining ) return result::failure;
+
+  // fixed header, topic and packet id, on the stack unless the topic is long, the payload stays where it is
+  static const size_t c_nHeader = 320;
+  uint8_t rHeader[ c_nHeader ];
+  std::string sHeader;
+  uint8_t* pHeader( rHeader );
+  if ( c_nHeader < ( 5 + nVariable ) ) {
+    sHeader.resize( 5 + nVariable );
+    pHeader = reinterpret_cast<uint8_t*>( sHeader.data() );
+  }
+
+  size_t nHeader {};
+  pHeader[ nHeader++ ] = c_publish | uint8_t( nQoS << 1 );
+  nHeader += EncodeLength( pHeader + nHeader, nRemaining );
+  pHeader[ nHeader++ ] = uint8_t( svTopic.size() >> 8 );
+  pHeader[ nHeader++ ] = uint8_t( svTopic.size() & 0xff );
+  std::memcpy( pHeader + nHeader, svTopic.data(), svTopic.size() );
+  nHeader += svTopic.size();
+
+  const iovec riov[ 2 ] = {
+    { pHeader, nHeader + ( 0 < nQoS ? 2 : 0 ) }
+  , { const_cast<char*>( svMessage.data() ), svMessage.size() }
+  };
+
+  State& state( *m_pState );
+  std::lock_guard<std::mutex> lock( state.mutexWrite );
+  if ( !state.bOpen || !state.bConnected.load( std::memory_order_relaxed ) ) return result::disconnected;
+
+  uint16_t id {};
+  if ( 0 < nQoS ) {
+    if ( !state.AllocateId( id ) ) return result::max_inflight;
+    pHeader[ nHeader ] = uint8_t( id >> 8 );
+    pHeader[ nHeader + 1 ] = uint8_t( id & 0xff );
+  }
+
+  const int result( state.SendLocked( riov, svMessage.empty() ? 1 : 2 ) );
+  if ( result::success == result ) token = id;
+  else if ( 0 != id ) state.Release( id );
+  return result;
+}
+
+int TransportAsio::Subscribe( const std::string_view& svTopic, int nQoS ) {
+
+  if ( 0xffff < svTopic.size() ) return result::failure;
+
+  State& state( *m_pState );
+  std::lock_guard<std::mutex> lock( state.mutexWrite );
+  if ( !state.bOpen ) return result::disconnected;
+
+  uint16_t id {};
+  if ( !state.AllocateId( id ) ) return result::max_inflight;
+
+  std::string sBody;
+  AppendU16( sBody, id );
+  AppendString( sBody, svTopic );
+  sBody += char( nQoS & 3 );
+
+  uint8_t rLength[ 4 ];
+  const size_t nLength( EncodeLength( rLength, sBody.size() ) );
+  const uint8_t type( c_subscribe );
+  const iovec riov[ 3 ] = {
+    { const_cast<uint8_t*>( &type ), 1 }
+  , { rLength, nLength }
+  , { sBody.data(), sBody.size() }
+  };
+  const int result( state.SendLocked( riov, 3 ) );
+  if ( result::success != result ) state.Release( id );
+  return result;
+}
+
+int TransportAsio::UnSubscribe( const std::string_view& svTopic ) {
+
+  if ( 0xffff < svTopic.size() ) return result::failure;
+
+  State& state( *m_pState );
+  std::lock_guard<std::mutex> lock( state.mutexWrite );
+  if ( !state.bOpen ) return result::disconnected;
+
+  uint16_t id {};
+  if ( !state.AllocateId( id ) ) return result::max_inflight;
+
+  std::string sBody;
+  AppendU16( sBody, id );
+  AppendString( sBody, svTopic );
+
+  uint8_t rLength[ 4 ];
+  const size_t nLength( EncodeLength( rLength, sBody.size() ) );
+  const uint8_t type( c_unsubscribe );
+  const iovec riov[ 3 ] = {
+    { const_cast<uint8_t*>( &type ), 1 }
+  , { rLength, nLength }
+  , { sBody.data(), sBody.size() }
+  };
+  const int result( state.SendLocked( riov, 3 ) );
+  if ( result::success != result ) state.Release( id );
+  return result;
+}
+
+} // namespace mqtt
+} // namespace ou
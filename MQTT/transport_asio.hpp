@@ -0,0 +1,99 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+ * File:    transport_asio.hpp
+ * Project: Repertory/MQTT
+ * Author:  raymond@burkholder.net
+ * Created: October 20, 2026 00:34:51
+ */
+
+// mqtt 3.1.1 written directly on boost::asio, an alternative to paho for ou::Mqtt
+//   clean session, publishes at qos 0 and 1, inbound at any qos (qos 2 is delivered on arrival, so at least once)
+//   the socket, keepalive and callbacks are serialised on a strand of an executor: either one supplied by the
+//   application, to share its event loop (telegram::Bot::Executor(), say), or an io_context on a thread of its own
+//   ("mqtt.asio" in thread.hpp)
+//   Publish builds the fixed header, topic and packet id on the stack and hands them with the caller's payload
+//   to a single sendmsg on the calling thread, when nothing is queued ahead of them, so the payload is not copied;
+//   whatever the socket does not take is copied to a queue written from the strand, which keeps later sends behind it
+//   Connect and Disconnect wait on the strand, so are refused from a callback, or from any handler of the
+//     supplied io_context, ou::Mqtt calls them from its own threads
+//   a supplied executor's io_context must outlive this transport, and keep running until the destructor returns;
+//     the destructor waits on the strand, except from a handler of that io_context, where it shuts down inline,
+//     which is safe only when a single thread runs it (the usual event loop); with several, destroy from elsewhere
+
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+
+#include "transport.hpp"
+
+namespace ou {
+namespace mqtt {
+
+class TransportAsio: public Transport {
+public:
+
+  struct Config {
+    std::chrono::seconds keepalive;
+    std::chrono::seconds timeout; // connect, and the wait for connack
+    size_t nQueueMax;  // bytes waiting for the socket, beyond which Publish returns result::max_inflight
+    size_t nInFlight;  // qos 1 publishes awaiting puback, beyond which Publish returns result::max_inflight
+    Config()
+    : keepalive( 20 ), timeout( 2 ), nQueueMax( 16 * 1024 * 1024 ), nInFlight( 65535 )
+    {}
+  };
+
+  TransportAsio( const Config& = Config() ); // with an io_context and thread of its own
+  TransportAsio( boost::asio::any_io_executor, const Config& = Config() );
+  virtual ~TransportAsio();
+
+  int Create( const mqtt::Config&, const std::string& sId ) override;
+  void SetCallbacks( fConnectionLost_t&&, fMessageArrived_t&&, fDeliveryComplete_t&& ) override;
+
+  int Connect() override;
+  int SetWill( const std::string_view& svTopic, const std::string_view& svMessage, int nQoS ) override;
+  int Disconnect( int msTimeout ) override;
+  bool IsConnected() override;
+
+  // the token is the packet id, 0 with qos 0, qos 2 is refused with result::failure
+  int Publish( const std::string_view& svTopic, const std::string_view& svMessage, int nQoS, token_t& ) override;
+  int Subscribe( const std::string_view& svTopic, int nQoS ) override;
+  int UnSubscribe( const std::string_view& svTopic ) override;
+
+protected:
+private:
+
+  struct State;
+  using pState_t = std::shared_ptr<State>;
+
+  using work_guard_t = boost::asio::executor_work_guard<boost::asio::io_context::executor_type>;
+
+  // own event loop, when no executor is supplied, declared first so destroyed last
+  std::unique_ptr<boost::asio::io_context> m_pio;
+  std::unique_ptr<work_guard_t> m_pWorkGuard;
+  std::thread m_thread;
+
+  pState_t m_pState;
+
+};
+
+} // namespace mqtt
+} // namespace ou
@@ -0,0 +1,178 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+  File:    transport_paho.cpp
+  Project: Repertory/MQTT
+  Author:  raymond@burkholder.net
+  Created: October 19, 2026 10:05:17
+  paho calls split out of mqtt.cpp
+*/
+
+#include <cassert>
+#include <iostream>
+
+#include <thread.hpp>
+
+#include "transport_paho.hpp"
+
+// documentation: https://eclipse.github.io/paho.mqtt.c/MQTTClient/html/_m_q_t_t_client_8h.html
+
+namespace {
+  unsigned int c_nTimeOut( 2 ); // seconds
+}
+
+namespace ou {
+namespace mqtt {
+
+TransportPaho::TransportPaho()
+: m_bCreated( false )
+, m_clientMqtt {}
+, m_nWillQoS {}
+{}
+
+TransportPaho::~TransportPaho() {
+  if ( m_bCreated ) {
+    MQTTClient_destroy( &m_clientMqtt );
+  }
+}
+
+int TransportPaho::Create( const Config& config, const std::string& sId ) {
+
+  assert( !m_bCreated );
+
+  m_sUserName = config.sUserName;
+  m_sPassword = config.sPassword;
+
+  const std::string sMqttUrl("tcp://" + config.sHost + ':' + config.sPort );
+
+  int result = MQTTClient_create(
+    &m_clientMqtt, sMqttUrl.c_str(), sId.c_str(),
+    MQTTCLIENT_PERSISTENCE_NONE, nullptr
+    );
+
+  //std::cout << "ou::mqtt create status " << result << std::endl;
+
+  if ( MQTTCLIENT_SUCCESS == result ) {
+    m_bCreated = true;
+  }
+
+  return result;
+}
+
+void TransportPaho::SetCallbacks( fConnectionLost_t&& fConnectionLost, fMessageArrived_t&& fMessageArrived, fDeliveryComplete_t&& fDeliveryComplete ) {
+  assert( m_bCreated );
+  m_fConnectionLost = std::move( fConnectionLost );
+  m_fMessageArrived = std::move( fMessageArrived );
+  m_fDeliveryComplete = std::move( fDeliveryComplete );
+  int result = MQTTClient_setCallbacks( m_clientMqtt, this, &TransportPaho::ConnectionLost, &TransportPaho::MessageArrived, &TransportPaho::DeliveryComplete );
+  if ( MQTTCLIENT_SUCCESS != result ) { // MQTTCLIENT_FAILURE  on error
+    std::cerr << "mqtt paho set callbacks failed " << result << std::endl;
+  }
+}
+
+int TransportPaho::Connect() {
+
+  MQTTClient_connectOptions options = MQTTClient_connectOptions_initializer;
+  options.keepAliveInterval = 20;
+  options.cleansession = 1;
+  options.reliable = 0;
+  options.connectTimeout = c_nTimeOut;
+  options.username = m_sUserName.c_str();
+  options.password = m_sPassword.c_str();
+
+  // copied, SetWill may run on another thread during the connect
+  std::string sWillTopic;
+  std::string sWillMessage;
+  MQTTClient_willOptions will = MQTTClient_willOptions_initializer;
+  {
+    std::lock_guard<std::mutex> lock( m_mutexWill );
+    sWillTopic = m_sWillTopic;
+    sWillMessage = m_sWillMessage;
+    will.qos = m_nWillQoS;
+  }
+  if ( !sWillTopic.empty() ) {
+    will.topicName = sWillTopic.c_str();
+    will.message = nullptr; // binary payload follows
+    will.payload.len = sWillMessage.size();
+    will.payload.data = sWillMessage.data();
+    options.will = &will;
+  }
+
+  return MQTTClient_connect( m_clientMqtt, &options );
+}
+
+int TransportPaho::SetWill( const std::string_view& svTopic, const std::string_view& svMessage, int nQoS ) {
+  std::lock_guard<std::mutex> lock( m_mutexWill );
+  m_sWillTopic = svTopic;
+  m_sWillMessage = svMessage;
+  m_nWillQoS = nQoS;
+  return MQTTCLIENT_SUCCESS;
+}
+
+int TransportPaho::Disconnect( int msTimeout ) {
+  return MQTTClient_disconnect( m_clientMqtt, msTimeout );
+}
+
+bool TransportPaho::IsConnected() {
+  return 1 == MQTTClient_isConnected( m_clientMqtt );
+}
+
+int TransportPaho::Publish( const std::string_view& svTopic, const std::string_view& svMessage, int nQoS, token_t& token ) {
+  MQTTClient_deliveryToken dt {};
+  int result = MQTTClient_publish( m_clientMqtt, svTopic.data(), svMessage.size(), svMessage.data(), nQoS, 0, &dt );
+  token = dt;
+  return result;
+}
+
+int TransportPaho::Subscribe( const std::string_view& svTopic, int nQoS ) {
+  // TODO: memory leaks on topic?
+  return MQTTClient_subscribe( m_clientMqtt, svTopic.data(), nQoS );
+}
+
+int TransportPaho::UnSubscribe( const std::string_view& svTopic ) {
+  // TODO: memory leaks on topic?
+  return MQTTClient_unsubscribe( m_clientMqtt, svTopic.data() );
+}
+
+void TransportPaho::ConnectionLost( void* context, char* cause ) {
+  ou::thread::EnterOnce( "mqtt.callback" );
+  assert( context );
+  TransportPaho* self = reinterpret_cast<TransportPaho*>( context );
+  if ( self->m_fConnectionLost ) self->m_fConnectionLost( cause );
+}
+
+int TransportPaho::MessageArrived( void* context, char* topicName, int topicLen, MQTTClient_message* message ) {
+  ou::thread::EnterOnce( "mqtt.callback" );
+  assert( context );
+  TransportPaho* self = reinterpret_cast<TransportPaho*>( context );
+  // topicLen is 0 when the topic is NUL terminated, which is the usual case
+  const std::string_view svTopic( 0 == topicLen ? std::string_view( topicName ) : std::string_view( topicName, topicLen ) );
+  const std::string_view svMessage( (char*)message->payload, message->payloadlen );
+  if ( self->m_fMessageArrived ) self->m_fMessageArrived( svTopic, svMessage );
+  MQTTClient_freeMessage( &message );
+  MQTTClient_free( topicName );
+  return 1;
+}
+
+void TransportPaho::DeliveryComplete( void* context, MQTTClient_deliveryToken token ) {
+	// not called with QoS0
+  ou::thread::EnterOnce( "mqtt.callback" );
+  assert( context );
+  TransportPaho* self = reinterpret_cast<TransportPaho*>( context );
+  if ( self->m_fDeliveryComplete ) self->m_fDeliveryComplete( token );
+}
+
+} // namespace mqtt
+} // namespace ou
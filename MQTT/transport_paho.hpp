@@ -0,0 +1,78 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+ * File:    transport_paho.hpp
+ * Project: Repertory/MQTT
+ * Author:  raymond@burkholder.net
+ * Created: October 19, 2026 10:05:17
+ */
+
+#pragma once
+
+#include <mutex>
+
+#include <MQTTClient.h>
+
+#include "transport.hpp"
+
+namespace ou {
+namespace mqtt {
+
+// paho synchronous client
+class TransportPaho: public Transport {
+public:
+
+  TransportPaho();
+  virtual ~TransportPaho();
+
+  int Create( const Config&, const std::string& sId ) override;
+  void SetCallbacks( fConnectionLost_t&&, fMessageArrived_t&&, fDeliveryComplete_t&& ) override;
+
+  int Connect() override;
+  int SetWill( const std::string_view& svTopic, const std::string_view& svMessage, int nQoS ) override;
+  int Disconnect( int msTimeout ) override;
+  bool IsConnected() override;
+
+  int Publish( const std::string_view& svTopic, const std::string_view& svMessage, int nQoS, token_t& ) override;
+  int Subscribe( const std::string_view& svTopic, int nQoS ) override;
+  int UnSubscribe( const std::string_view& svTopic ) override;
+
+protected:
+private:
+
+  bool m_bCreated;
+
+  MQTTClient m_clientMqtt;
+
+  std::string m_sUserName;
+  std::string m_sPassword;
+
+  std::mutex m_mutexWill;
+  std::string m_sWillTopic;
+  std::string m_sWillMessage;
+  int m_nWillQoS;
+
+  fConnectionLost_t m_fConnectionLost;
+  fMessageArrived_t m_fMessageArrived;
+  fDeliveryComplete_t m_fDeliveryComplete;
+
+  static int MessageArrived( void* context, char* topicName, int topicLen, MQTTClient_message* message );
+  static void DeliveryComplete( void* context, MQTTClient_deliveryToken token );
+  static void ConnectionLost( void* context, char* cause );
+
+};
+
+} // namespace mqtt
+} // namespace ou
@@ -0,0 +1,273 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+  File:    utf8.cpp
+  Project: Repertory/MQTT
+  Author:  raymond@burkholder.net
+  Created: October 19, 2026 22:41:09
+*/
+
+#include <cstdint>
+#include <cstring>
+
+#if ( defined( __x86_64__ ) || defined( __i386__ ) ) && defined( __GNUC__ )
+#define OU_MQTT_SIMD_X86
+#include <immintrin.h>
+#endif
+
+#include "utf8.hpp"
+
+namespace {
+
+  using ou::mqtt::simd::EIsa;
+
+  bool ValidScalar( const uint8_t* p, size_t n ) {
+    const uint8_t* const pEnd( p + n );
+    while ( p < pEnd ) {
+      const uint8_t byte( *p );
+      if ( 0x80 > byte ) {
+        ++p;
+        continue;
+      }
+      size_t nFollow;
+      uint8_t minSecond( 0x80 ), maxSecond( 0xbf ); // the second byte carries the overlong, surrogate and range limits
+      if ( 0xc2 > byte ) return false; // continuation, or overlong two byte lead
+      else if ( 0xe0 > byte ) nFollow = 1;
+      else if ( 0xf0 > byte ) {
+        nFollow = 2;
+        if ( 0xe0 == byte ) minSecond = 0xa0;
+        else if ( 0xed == byte ) maxSecond = 0x9f;
+      }
+      else if ( 0xf5 > byte ) {
+        nFollow = 3;
+        if ( 0xf0 == byte ) minSecond = 0x90;
+        else if ( 0xf4 == byte ) maxSecond = 0x8f;
+      }
+      else return false;
+      if ( nFollow >= size_t( pEnd - p ) ) return false; // truncated
+      if ( ( minSecond > p[ 1 ] ) || ( maxSecond < p[ 1 ] ) ) return false;
+      for ( size_t ix = 2; ix <= nFollow; ++ix ) {
+        if ( 0x80 != ( p[ ix ] & 0xc0 ) ) return false;
+      }
+      p += nFollow + 1;
+    }
+    return true;
+  }
+
+#ifdef OU_MQTT_SIMD_X86
+
+  // error bits, set by the lookups on the first byte's high and low nibbles and the second byte's high nibble,
+  //   a bit surviving the and of all three is an error
+  const uint8_t TOO_SHORT   = 1 << 0; // lead not followed by a continuation
+  const uint8_t TOO_LONG    = 1 << 1; // continuation after ascii
+  const uint8_t OVERLONG_3  = 1 << 2;
+  const uint8_t TOO_LARGE   = 1 << 3;
+  const uint8_t SURROGATE   = 1 << 4;
+  const uint8_t OVERLONG_2  = 1 << 5;
+  const uint8_t TOO_LARGE_1000 = 1 << 6;
+  const uint8_t OVERLONG_4  = 1 << 6;
+  const uint8_t TWO_CONTS   = 1 << 7; // two continuations, checked against the lengths the leads require
+  const uint8_t CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS;
+
+  #define OU_UTF8_BYTE_1_HIGH \
+      TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG \
+    , TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS \
+    , TOO_SHORT | OVERLONG_2 \
+    , TOO_SHORT \
+    , TOO_SHORT | OVERLONG_3 | SURROGATE \
+    , TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4
+
+  #define OU_UTF8_BYTE_1_LOW \
+      CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4 \
+    , CARRY | OVERLONG_2 \
+    , CARRY \
+    , CARRY \
+    , CARRY | TOO_LARGE \
+    , CARRY | TOO_LARGE | TOO_LARGE_1000 \
+    , CARRY | TOO_LARGE | TOO_LARGE_1000 \
+    , CARRY | TOO_LARGE | TOO_LARGE_1000 \
+    , CARRY | TOO_LARGE | TOO_LARGE_1000 \
+    , CARRY | TOO_LARGE | TOO_LARGE_1000 \
+    , CARRY | TOO_LARGE | TOO_LARGE_1000 \
+    , CARRY | TOO_LARGE | TOO_LARGE_1000 \
+    , CARRY | TOO_LARGE | TOO_LARGE_1000 \
+    , CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE \
+    , CARRY | TOO_LARGE | TOO_LARGE_1000 \
+    , CARRY | TOO_LARGE | TOO_LARGE_1000
+
+  #define OU_UTF8_BYTE_2_HIGH \
+      TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT \
+    , TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4 \
+    , TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE \
+    , TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE  | TOO_LARGE \
+    , TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE  | TOO_LARGE \
+    , TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT
+
+  // ==== sse4.2, 16 bytes
+
+  __attribute__(( target( "sse4.2" ) ))
+  inline __m128i Check128( __m128i input, __m128i prev ) {
+
+    const __m128i nibble( _mm_set1_epi8( 0x0f ) );
+    const __m128i prev1( _mm_alignr_epi8( input, prev, 16 - 1 ) );
+
+    const __m128i byte_1_high( _mm_shuffle_epi8( _mm_setr_epi8( OU_UTF8_BYTE_1_HIGH ), _mm_and_si128( _mm_srli_epi16( prev1, 4 ), nibble ) ) );
+    const __m128i byte_1_low( _mm_shuffle_epi8( _mm_setr_epi8( OU_UTF8_BYTE_1_LOW ), _mm_and_si128( prev1, nibble ) ) );
+    const __m128i byte_2_high( _mm_shuffle_epi8( _mm_setr_epi8( OU_UTF8_BYTE_2_HIGH ), _mm_and_si128( _mm_srli_epi16( input, 4 ), nibble ) ) );
+    const __m128i special( _mm_and_si128( _mm_and_si128( byte_1_high, byte_1_low ), byte_2_high ) );
+
+    // third and fourth bytes of three and four byte sequences must be continuations, and only those
+    const __m128i prev2( _mm_alignr_epi8( input, prev, 16 - 2 ) );
+    const __m128i prev3( _mm_alignr_epi8( input, prev, 16 - 3 ) );
+    const __m128i must23( _mm_or_si128( _mm_subs_epu8( prev2, _mm_set1_epi8( char( 0xe0 - 0x80 ) ) ), _mm_subs_epu8( prev3, _mm_set1_epi8( char( 0xf0 - 0x80 ) ) ) ) );
+    return _mm_xor_si128( _mm_and_si128( must23, _mm_set1_epi8( char( 0x80 ) ) ), special );
+  }
+
+  __attribute__(( target( "sse4.2" ) ))
+  inline __m128i Incomplete128( __m128i input ) { // a lead in the last three bytes without room for its continuations
+    const __m128i max( _mm_setr_epi8( -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, char( 0xf0 - 1 ), char( 0xe0 - 1 ), char( 0xc0 - 1 ) ) );
+    return _mm_subs_epu8( input, max );
+  }
+
+  __attribute__(( target( "sse4.2" ) ))
+  inline void Block128( __m128i input, __m128i& error, __m128i& prev, __m128i& incomplete ) {
+    if ( 0 == _mm_movemask_epi8( input ) ) error = _mm_or_si128( error, incomplete ); // ascii, only a sequence left open by the previous block can fail
+    else {
+      error = _mm_or_si128( error, Check128( input, prev ) );
+      incomplete = Incomplete128( input );
+    }
+    prev = input;
+  }
+
+  __attribute__(( target( "sse4.2" ) ))
+  bool ValidSse42( const uint8_t* p, size_t n ) {
+
+    __m128i error( _mm_setzero_si128() );
+    __m128i prev( _mm_setzero_si128() );
+    __m128i incomplete( _mm_setzero_si128() );
+
+
+    size_t ix {};
+    for ( ; ( ix + 16 ) <= n; ix += 16 ) {
+      Block128( _mm_loadu_si128( reinterpret_cast<const __m128i*>( p + ix ) ), error, prev, incomplete );
+    }
+    if ( ix < n ) {
+      uint8_t rTail[ 16 ] = {};
+      std::memcpy( rTail, p + ix, n - ix );
+      Block128( _mm_loadu_si128( reinterpret_cast<const __m128i*>( rTail ) ), error, prev, incomplete );
+    }
+    error = _mm_or_si128( error, incomplete );
+    return 0 != _mm_testz_si128( error, error );
+  }
+
+  // ==== avx2, 32 bytes
+
+  __attribute__(( target( "avx2" ) ))
+  inline __m256i Prev256( __m256i input, __m256i prev, int n ) { // input shifted right by n bytes, prev's last bytes shifted in
+    const __m256i across( _mm256_permute2x128_si256( prev, input, 0x21 ) ); // prev high lane, input low lane
+    switch ( n ) {
+      case 1: return _mm256_alignr_epi8( input, across, 16 - 1 );
+      case 2: return _mm256_alignr_epi8( input, across, 16 - 2 );
+      default: return _mm256_alignr_epi8( input, across, 16 - 3 );
+    }
+  }
+
+  __attribute__(( target( "avx2" ) ))
+  inline __m256i Check256( __m256i input, __m256i prev ) {
+
+    const __m256i nibble( _mm256_set1_epi8( 0x0f ) );
+    const __m256i prev1( Prev256( input, prev, 1 ) );
+
+    const __m256i byte_1_high( _mm256_shuffle_epi8( _mm256_setr_epi8( OU_UTF8_BYTE_1_HIGH, OU_UTF8_BYTE_1_HIGH ), _mm256_and_si256( _mm256_srli_epi16( prev1, 4 ), nibble ) ) );
+    const __m256i byte_1_low( _mm256_shuffle_epi8( _mm256_setr_epi8( OU_UTF8_BYTE_1_LOW, OU_UTF8_BYTE_1_LOW ), _mm256_and_si256( prev1, nibble ) ) );
+    const __m256i byte_2_high( _mm256_shuffle_epi8( _mm256_setr_epi8( OU_UTF8_BYTE_2_HIGH, OU_UTF8_BYTE_2_HIGH ), _mm256_and_si256( _mm256_srli_epi16( input, 4 ), nibble ) ) );
+    const __m256i special( _mm256_and_si256( _mm256_and_si256( byte_1_high, byte_1_low ), byte_2_high ) );
+
+    const __m256i prev2( Prev256( input, prev, 2 ) );
+    const __m256i prev3( Prev256( input, prev, 3 ) );
+    const __m256i must23( _mm256_or_si256( _mm256_subs_epu8( prev2, _mm256_set1_epi8( char( 0xe0 - 0x80 ) ) ), _mm256_subs_epu8( prev3, _mm256_set1_epi8( char( 0xf0 - 0x80 ) ) ) ) );
+    return _mm256_xor_si256( _mm256_and_si256( must23, _mm256_set1_epi8( char( 0x80 ) ) ), special );
+  }
+
+  __attribute__(( target( "avx2" ) ))
+  inline __m256i Incomplete256( __m256i input ) {
+    const __m256i max( _mm256_setr_epi8(
+      -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+      -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, char( 0xf0 - 1 ), char( 0xe0 - 1 ), char( 0xc0 - 1 ) ) );
+    return _mm256_subs_epu8( input, max );
+  }
+
+  __attribute__(( target( "avx2" ) ))
+  inline void Block256( __m256i input, __m256i& error, __m256i& prev, __m256i& incomplete ) {
+    if ( 0 == _mm256_movemask_epi8( input ) ) error = _mm256_or_si256( error, incomplete ); // ascii, only a sequence left open by the previous block can fail
+    else {
+      error = _mm256_or_si256( error, Check256( input, prev ) );
+      incomplete = Incomplete256( input );
+    }
+    prev = input;
+  }
+
+  __attribute__(( target( "avx2" ) ))
+  bool ValidAvx2( const uint8_t* p, size_t n ) {
+
+    __m256i error( _mm256_setzero_si256() );
+    __m256i prev( _mm256_setzero_si256() );
+    __m256i incomplete( _mm256_setzero_si256() );
+
+
+    size_t ix {};
+    for ( ; ( ix + 32 ) <= n; ix += 32 ) {
+      Block256( _mm256_loadu_si256( reinterpret_cast<const __m256i*>( p + ix ) ), error, prev, incomplete );
+    }
+    if ( ix < n ) {
+      uint8_t rTail[ 32 ] = {};
+      std::memcpy( rTail, p + ix, n - ix );
+      Block256( _mm256_loadu_si256( reinterpret_cast<const __m256i*>( rTail ) ), error, prev, incomplete );
+    }
+    error = _mm256_or_si256( error, incomplete );
+    return 0 != _mm256_testz_si256( error, error );
+  }
+
+  #undef OU_UTF8_BYTE_1_HIGH
+  #undef OU_UTF8_BYTE_1_LOW
+  #undef OU_UTF8_BYTE_2_HIGH
+
+#endif // OU_MQTT_SIMD_X86
+
+} // namespace anonymous
+
+namespace ou {
+namespace mqtt {
+namespace utf8 {
+
+bool Valid( const char* p, size_t n ) {
+  return Valid( p, n, simd::Detect() );
+}
+
+bool Valid( const char* p, size_t n, simd::EIsa eIsa ) {
+  const uint8_t* pu( reinterpret_cast<const uint8_t*>( p ) );
+#ifdef OU_MQTT_SIMD_X86
+  const simd::EIsa eAvailable( simd::Detect() );
+  if ( ( simd::EIsa::avx2 == eIsa ) && ( simd::EIsa::avx2 == eAvailable ) ) return ValidAvx2( pu, n );
+  if ( ( simd::EIsa::sse42 == eIsa ) && ( simd::EIsa::scalar != eAvailable ) ) return ValidSse42( pu, n );
+#else
+  (void)eIsa;
+#endif
+  return ValidScalar( pu, n );
+}
+
+} // namespace utf8
+} // namespace mqtt
+} // namespace ou
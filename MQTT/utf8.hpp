@@ -0,0 +1,45 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+ * File:    utf8.hpp
+ * Project: Repertory/MQTT
+ * Author:  raymond@burkholder.net
+ * Created: October 19, 2026 22:41:09
+ */
+
+// utf-8 validation, rfc 3629: no overlong forms, no surrogates, nothing above U+10FFFF
+//   the vector versions check 16 or 32 bytes at a time with table lookups on the nibbles of each byte
+//   and the one before it (Keiser and Lemire, "Validating UTF-8 In Less Than One Instruction Per Byte"),
+//   blocks of ascii are passed over with a single test
+
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+#include "simd.hpp"
+
+namespace ou {
+namespace mqtt {
+namespace utf8 {
+
+bool Valid( const char* p, size_t n ); // with simd::Detect()
+bool Valid( const char* p, size_t n, simd::EIsa ); // an isa the cpu lacks falls back to scalar
+
+inline bool Valid( const std::string_view& sv ) { return Valid( sv.data(), sv.size() ); }
+
+} // namespace utf8
+} // namespace mqtt
+} // namespace ou
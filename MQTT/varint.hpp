@@ -0,0 +1,63 @@
+/************************************************************************
+ * Copyright(c) 2026, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+
+/*
+ * File:    varint.hpp
+ * Project: Repertory/MQTT
+ * Author:  raymond@burkholder.net
+ * Created: October 21, 2026 10:41:30
+ */
+
+// base 128 varints, low group first as in protobuf, for the wire formats inside the library, not installed
+
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+namespace ou {
+namespace mqtt {
+
+inline size_t VarintSize( uint64_t value ) {
+  size_t n( 1 );
+  while ( 0x80 <= value ) {
+    value >>= 7;
+    ++n;
+  }
+  return n;
+}
+
+inline void PutVarint( std::string& s, uint64_t value ) {
+  while ( 0x80 <= value ) {
+    s.push_back( static_cast<char>( 0x80 | ( value & 0x7f ) ) );
+    value >>= 7;
+  }
+  s.push_back( static_cast<char>( value ) );
+}
+
+// reads from p, advancing it, false when truncated or longer than 64 bits allow
+inline bool GetVarint( const char*& p, const char* end, uint64_t& value ) {
+  value = 0;
+  for ( unsigned int shift = 0; shift < 64; shift += 7 ) {
+    if ( p == end ) return false;
+    const uint8_t byte( static_cast<uint8_t>( *p++ ) );
+    value |= uint64_t( byte & 0x7f ) << shift;
+    if ( 0 == ( byte & 0x80 ) ) return true;
+  }
+  return false;
+}
+
+} // namespace mqtt
+} // namespace ou
@@ -31,6 +31,8 @@
 #include <boost/asio/strand.hpp>
 #include <boost/log/trivial.hpp>
 
+#include <thread.hpp>
+
 #include "root_certificates.hpp" // this needs to be factored out properly
 
 #include "one_shot.hpp"
@@ -189,7 +191,7 @@ Bot::Bot( const std::string& sToken )
   m_ssl_context.set_verify_mode( ssl::verify_peer );
 
   m_pWorkGuard = std::make_unique<work_guard_t>( asio::make_work_guard( m_io ) );
-  m_thread = std::move( std::thread( [this](){ m_io.run(); } ) );
+  m_thread = std::move( std::thread( [this](){ ou::thread::Enter( "telegram.io" ); m_io.run(); } ) );
 
   PollUpdates();
   SetMyCommands(); // should remove existing ones
@@ -52,6 +52,9 @@ public:
   void SetCommand( const std::string&& sName, const std::string&& sDescription, bool bPost, fCommand_t&& );
   void DelCommand( const std::string&  sName );
 
+  // the event loop, to share with other asio users, eg mqtt::TransportAsio, which must be destroyed first
+  boost::asio::io_context::executor_type Executor() { return m_io.get_executor(); }
+
 protected:
 private:
 